@@ -2,6 +2,8 @@
 
 import json
 import argparse
+import math
+import random
 import sys
 import re
 from pathlib import Path
@@ -28,6 +30,17 @@ def extract_input_size(benchmark_name: str) -> Optional[int]:
     
     return None
 
+def extract_impl_type(benchmark_name: str) -> str:
+    """Extract the string type from the template argument, e.g. gs::german_string or prefix8_sso20."""
+    match = re.search(r'<([^<>]+)>', benchmark_name)
+    if match:
+        return match.group(1)
+    if 'std::string' in benchmark_name:
+        return 'std::string'
+    if 'gs::german_string' in benchmark_name:
+        return 'gs::german_string'
+    return 'other'
+
 def parse_benchmark_data(results: Dict) -> Dict[str, Dict[str, List[Tuple[int, float]]]]:
     """Parse benchmark results and group by test type and implementation."""
     data = {}
@@ -40,12 +53,7 @@ def parse_benchmark_data(results: Dict) -> Dict[str, Dict[str, List[Tuple[int, f
         test_type = name.split('<')[0].split('/')[0]
         
         # Extract implementation type
-        if '<std::string>' in name or 'std::string' in name:
-            impl_type = 'std::string'
-        elif '<gs::german_string>' in name or 'gs::german_string' in name:
-            impl_type = 'gs::german_string'
-        else:
-            impl_type = 'other'
+        impl_type = extract_impl_type(name)
         
         # Extract input size
         input_size = extract_input_size(name)
@@ -67,6 +75,79 @@ def parse_benchmark_data(results: Dict) -> Dict[str, Dict[str, List[Tuple[int, f
     
     return data
 
+# Counters added by perf_counters.h when the machine exposes hardware events
+COUNTER_METRICS = [
+    ('ipc', 'Instructions per cycle'),
+    ('l1d_misses_per_item', 'L1D misses per item'),
+    ('llc_misses_per_item', 'LLC misses per item'),
+    ('branch_misses_per_item', 'Branch misses per item'),
+]
+
+def parse_counter_data(results: Dict) -> Dict[str, Dict[str, Dict[str, List[Tuple[int, float]]]]]:
+    """Group time and hardware counters by test type, metric and implementation."""
+    data = {}
+    
+    for benchmark in results['benchmarks']:
+        if benchmark.get('run_type') == 'aggregate' and benchmark.get('aggregate_name') != 'mean':
+            continue
+        name = benchmark['name']
+        metrics = [metric for metric, _ in COUNTER_METRICS if metric in benchmark]
+        if not metrics:
+            continue
+        
+        input_size = extract_input_size(name)
+        if input_size is None:
+            continue
+        
+        test_type = name.split('<')[0].split('/')[0]
+        impl_type = extract_impl_type(name)
+        
+        per_metric = data.setdefault(test_type, {})
+        per_metric.setdefault('cpu_time', {}).setdefault(impl_type, []).append((input_size, benchmark['cpu_time']))
+        for metric in metrics:
+            per_metric.setdefault(metric, {}).setdefault(impl_type, []).append((input_size, benchmark[metric]))
+    
+    for per_metric in data.values():
+        for implementations in per_metric.values():
+            for points in implementations.values():
+                points.sort(key=lambda x: x[0])
+    
+    return data
+
+def generate_counter_graphs(counter_data: Dict, output_dir: Path) -> None:
+    """Graph IPC and misses per item next to time, one figure per test type."""
+    colors = {'std::string': '#1f77b4', 'gs::german_string': '#ff7f0e', 'other': '#2ca02c'}
+    titles = dict(COUNTER_METRICS)
+    titles['cpu_time'] = 'CPU time (ns)'
+    
+    for test_type, per_metric in sorted(counter_data.items()):
+        metrics = ['cpu_time'] + [metric for metric, _ in COUNTER_METRICS if metric in per_metric]
+        fig, axes = plt.subplots(1, len(metrics), figsize=(5 * len(metrics), 5), squeeze=False)
+        
+        for ax, metric in zip(axes[0], metrics):
+            for impl_type, points in sorted(per_metric[metric].items()):
+                ax.plot([point[0] for point in points], [point[1] for point in points],
+                       marker='o' if impl_type == 'std::string' else 's',
+                       color=colors.get(impl_type, 'black'),
+                       label=impl_type,
+                       linewidth=2,
+                       markersize=6)
+            sizes = [point[0] for points in per_metric[metric].values() for point in points]
+            if sizes and max(sizes) / min(sizes) > 10:
+                ax.set_xscale('log')
+            ax.set_xlabel('Input Size', fontsize=10)
+            ax.set_title(titles[metric], fontsize=11, fontweight='bold')
+            ax.grid(True, alpha=0.3)
+            ax.legend(fontsize=9)
+        
+        plt.suptitle(f'{test_type} Hardware Counters', fontsize=14, fontweight='bold')
+        plt.tight_layout()
+        
+        output_file = output_dir / f"{test_type}_counters.png"
+        plt.savefig(output_file, dpi=150, bbox_inches='tight', facecolor='white')
+        print(f"Generated: {output_file}")
+        plt.close()
+
 def generate_graphs(results_file: str, output_dir: Optional[str] = None) -> None:
     """Generate performance graphs per test type."""
     if not MATPLOTLIB_AVAILABLE:
@@ -189,6 +270,12 @@ def generate_graphs(results_file: str, output_dir: Optional[str] = None) -> None
     # Generate a summary comparison graph
     generate_summary_graph(data, output_dir, time_unit="microseconds")
     
+    counter_data = parse_counter_data(results)
+    if counter_data:
+        generate_counter_graphs(counter_data, output_dir)
+    else:
+        print("No hardware counters in the results, skipping counter graphs")
+    
     print(f"\nAll graphs generated in: {output_dir}")
 
 def generate_summary_graph(data: Dict, output_dir: Path, time_unit: str = "microseconds") -> None:
@@ -280,55 +367,170 @@ def calculate_speedup(baseline: float, optimized: float) -> str:
     else:
         return f"{1/ratio:.2f}x slower"
 
-def compare_benchmarks(baseline_results: Dict, optimized_results: Dict, 
-                      baseline_pattern: str = "std::string", 
-                      optimized_pattern: str = "gs::german_string") -> None:
-    """Compare benchmark results between two implementations."""
-    
-    baseline_benchmarks = {}
-    optimized_benchmarks = {}
-    
-    # Group benchmarks by name (without template parameter)
-    for benchmark in baseline_results['benchmarks']:
-        name = benchmark['name']
-        if baseline_pattern in name:
-            clean_name = name.replace(f"<{baseline_pattern}>", "").replace(baseline_pattern, "")
-            baseline_benchmarks[clean_name] = benchmark
-    
-    for benchmark in optimized_results['benchmarks']:
-        name = benchmark['name']
-        if optimized_pattern in name:
-            clean_name = name.replace(f"<{optimized_pattern}>", "").replace(optimized_pattern, "")
-            optimized_benchmarks[clean_name] = benchmark
-    
-    print(f"Benchmark Comparison: {baseline_pattern} vs {optimized_pattern}")
-    print("=" * 80)
-    print(f"{'Benchmark Name':<40} {'Baseline':<15} {'Optimized':<15} {'Speedup':<15}")
-    print("-" * 80)
-    
-    # Find common benchmarks
-    common_benchmarks = set(baseline_benchmarks.keys()) & set(optimized_benchmarks.keys())
+TIME_UNIT_NANOSECONDS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+def collect_samples(results: Dict, pattern: str) -> Dict[str, List[float]]:
+    """CPU times in nanoseconds of every repetition, keyed by the benchmark name without the pattern."""
+    samples = {}
     
-    total_speedup = []
+    for benchmark in results['benchmarks']:
+        # Aggregates summarize the repetitions, the statistics work on the repetitions themselves
+        if benchmark.get('run_type') == 'aggregate' or benchmark.get('error_occurred'):
+            continue
+        name = benchmark.get('run_name', benchmark['name'])
+        if pattern not in name:
+            continue
+        clean_name = name.replace(f"<{pattern}>", "").replace(pattern, "") if pattern else name
+        scale = TIME_UNIT_NANOSECONDS.get(benchmark.get('time_unit', 'ns'), 1.0)
+        samples.setdefault(clean_name, []).append(benchmark['cpu_time'] * scale)
     
-    for name in sorted(common_benchmarks):
+    return samples
+
+def median(values: List[float]) -> float:
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2 == 1:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2
+
+def bootstrap_speedup_interval(baseline: List[float], optimized: List[float], confidence: float = 0.95,
+                               resamples: int = 2000, seed: int = 42) -> Tuple[float, float]:
+    """Percentile bootstrap interval of the ratio of medians, baseline over optimized."""
+    generator = random.Random(seed)
+    ratios = []
+    for _ in range(resamples):
+        baseline_median = median(generator.choices(baseline, k=len(baseline)))
+        optimized_median = median(generator.choices(optimized, k=len(optimized)))
+        if optimized_median > 0:
+            ratios.append(baseline_median / optimized_median)
+    if not ratios:
+        return (math.nan, math.nan)
+    ratios.sort()
+    tail = (1 - confidence) / 2
+    low = ratios[int(tail * (len(ratios) - 1))]
+    high = ratios[int(math.ceil((1 - tail) * (len(ratios) - 1)))]
+    return (low, high)
+
+def mann_whitney_u(baseline: List[float], optimized: List[float]) -> Tuple[float, float]:
+    """Mann-Whitney U of baseline against optimized and its two-sided p-value.
+    
+    Exact for small samples without ties, the normal approximation with tie and continuity
+    correction otherwise."""
+    m, n = len(baseline), len(optimized)
+    pooled = sorted([(value, 0) for value in baseline] + [(value, 1) for value in optimized])
+    
+    # Average ranks over runs of equal values
+    ranks = [0.0] * len(pooled)
+    tie_sizes = []
+    i = 0
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        tie_sizes.append(j - i + 1)
+        i = j + 1
+    
+    baseline_rank_sum = sum(rank for rank, (_, side) in zip(ranks, pooled) if side == 0)
+    u = baseline_rank_sum - m * (m + 1) / 2
+    
+    if m + n <= 20 and all(size == 1 for size in tie_sizes):
+        # counts[k] = number of orderings with U == k, built up one optimized sample at a time
+        counts = [[1] + [0] * (m * n) for _ in range(m + 1)]
+        for j in range(1, n + 1):
+            next_counts = [[0] * (m * n + 1) for _ in range(m + 1)]
+            for i in range(m + 1):
+                for k in range(m * n + 1):
+                    # The largest value is either the last optimized sample or the last baseline sample
+                    total = counts[i][k]
+                    if i > 0 and k >= j:
+                        total += next_counts[i - 1][k - j]
+                    next_counts[i][k] = total
+            counts = next_counts
+        distribution = counts[m]
+        total = sum(distribution)
+        lower = sum(distribution[:int(u) + 1]) / total
+        upper = sum(distribution[int(u):]) / total
+        return (u, min(1.0, 2 * min(lower, upper)))
+    
+    big_n = m + n
+    mean_u = m * n / 2
+    tie_term = sum(size ** 3 - size for size in tie_sizes) / (big_n * (big_n - 1))
+    variance = m * n / 12 * ((big_n + 1) - tie_term)
+    if variance <= 0:
+        return (u, 1.0)
+    z = max(abs(u - mean_u) - 0.5, 0) / math.sqrt(variance)
+    return (u, math.erfc(z / math.sqrt(2)))
+
+def compare_benchmarks(baseline_results: Dict, optimized_results: Dict, 
+                      baseline_pattern: str = "std::string", 
+                      optimized_pattern: str = "gs::german_string",
+                      alpha: float = 0.05, min_change: float = 0.01) -> int:
+    """Compare benchmark results between two implementations or two runs.
+    
+    Every benchmark pair is summarized by the medians of its repetitions, a bootstrap confidence
+    interval of the speedup and a Mann-Whitney U test. A change is only flagged when it is
+    significant at alpha, its interval excludes no change and it is larger than min_change.
+    Returns the number of significant regressions."""
+    
+    baseline_benchmarks = collect_samples(baseline_results, baseline_pattern)
+    optimized_benchmarks = collect_samples(optimized_results, optimized_pattern)
+    common_benchmarks = sorted(set(baseline_benchmarks.keys()) & set(optimized_benchmarks.keys()))
+    
+    name_width = max([40] + [len(name) + 2 for name in common_benchmarks])
+    header = (f"{'Benchmark Name':<{name_width}} {'Baseline':<12} {'Optimized':<12} {'Speedup':<9} "
+              f"{'95% CI':<15} {'p':<8} {'n':<7} {'Verdict':<10}")
+    print(f"Benchmark Comparison: {baseline_pattern or 'baseline'} vs {optimized_pattern or 'optimized'}")
+    print("=" * len(header))
+    print(header)
+    print("-" * len(header))
+    
+    speedups = []
+    faster = []
+    slower = []
+    
+    for name in common_benchmarks:
         baseline = baseline_benchmarks[name]
         optimized = optimized_benchmarks[name]
+        baseline_time = median(baseline)
+        optimized_time = median(optimized)
+        if baseline_time <= 0 or optimized_time <= 0:
+            continue
+        speedup = baseline_time / optimized_time
+        speedups.append(speedup)
         
-        baseline_time = baseline['cpu_time']
-        optimized_time = optimized['cpu_time']
-        
-        speedup = calculate_speedup(baseline_time, optimized_time)
-        
-        print(f"{name:<40} {format_time(baseline_time):<15} {format_time(optimized_time):<15} {speedup:<15}")
+        interval = "N/A"
+        p_value = "N/A"
+        verdict = "n/a"
+        if len(baseline) >= 2 and len(optimized) >= 2:
+            low, high = bootstrap_speedup_interval(baseline, optimized)
+            _, p = mann_whitney_u(baseline, optimized)
+            interval = f"[{low:.2f}, {high:.2f}]"
+            p_value = f"{p:.3f}"
+            verdict = "~"
+            if p < alpha and abs(speedup - 1) > min_change:
+                if speedup > 1 and low > 1:
+                    verdict = "FASTER"
+                    faster.append(name)
+                elif speedup < 1 and high < 1:
+                    verdict = "SLOWER"
+                    slower.append(name)
         
-        if baseline_time > 0:
-            total_speedup.append(baseline_time / optimized_time)
-    
-    if total_speedup:
-        avg_speedup = sum(total_speedup) / len(total_speedup)
-        print("-" * 80)
-        print(f"Average speedup: {avg_speedup:.2f}x")
+        counts = f"{len(baseline)}/{len(optimized)}"
+        print(f"{name:<{name_width}} {format_time(baseline_time):<12} {format_time(optimized_time):<12} "
+              f"{speedup:<9.2f} {interval:<15} {p_value:<8} {counts:<7} {verdict:<10}")
+    
+    if speedups:
+        geometric_mean = math.exp(sum(math.log(speedup) for speedup in speedups) / len(speedups))
+        print("-" * len(header))
+        print(f"Geometric mean speedup: {geometric_mean:.2f}x over {len(speedups)} benchmarks")
+        print(f"Significant at p < {alpha} and more than {min_change:.0%}: "
+              f"{len(faster)} faster, {len(slower)} slower")
+        if any(min(len(baseline_benchmarks[name]), len(optimized_benchmarks[name])) < 2 for name in common_benchmarks):
+            print("Benchmarks without repetitions are not tested, run them with --benchmark_repetitions")
+    
+    return len(slower)
 
 def generate_report(results_file: str, output_file: Optional[str] = None) -> None:
     """Generate a detailed benchmark report."""
@@ -345,7 +547,7 @@ def generate_report(results_file: str, output_file: Optional[str] = None) -> Non
     report_lines.append(f"- **CPU Cores**: {context['num_cpus']}")
     report_lines.append(f"- **CPU MHz**: {context['mhz_per_cpu']}")
     report_lines.append(f"- **Date**: {context['date']}")
-    report_lines.append(f"- **Benchmark Library**: {context['library_version']} ({context['library_build_type']})")
+    report_lines.append(f"- **Benchmark Library**: {context.get('library_version', 'unknown')} ({context['library_build_type']})")
     report_lines.append("")
     
     # Cache info
@@ -371,8 +573,9 @@ def generate_report(results_file: str, output_file: Optional[str] = None) -> Non
     for group_name, benchmarks in sorted(benchmark_groups.items()):
         report_lines.append(f"### {group_name}")
         report_lines.append("")
-        report_lines.append("| Configuration | CPU Time | Iterations | Items/sec |")
-        report_lines.append("|---------------|----------|------------|-----------|")
+        counter_columns = [metric for metric, _ in COUNTER_METRICS if any(metric in benchmark for benchmark in benchmarks)]
+        report_lines.append("| Configuration | CPU Time | Iterations | Items/sec |" + "".join(f" {metric} |" for metric in counter_columns))
+        report_lines.append("|---------------|----------|------------|-----------|" + "---|" * len(counter_columns))
         
         for benchmark in sorted(benchmarks, key=lambda x: x['name']):
             name = benchmark['name'].replace(group_name, "").lstrip('/')
@@ -386,7 +589,8 @@ def generate_report(results_file: str, output_file: Optional[str] = None) -> Non
             else:
                 items_per_sec_str = "N/A"
             
-            report_lines.append(f"| {name} | {cpu_time} | {iterations:,} | {items_per_sec_str} |")
+            counters_str = "".join(f" {benchmark[metric]:.3f} |" if metric in benchmark else " N/A |" for metric in counter_columns)
+            report_lines.append(f"| {name} | {cpu_time} | {iterations:,} | {items_per_sec_str} |{counters_str}")
         
         report_lines.append("")
     
@@ -411,6 +615,12 @@ def main():
                        help="Pattern to identify baseline benchmarks")
     parser.add_argument("--optimized-pattern", default="gs::german_string",
                        help="Pattern to identify optimized benchmarks")
+    parser.add_argument("--alpha", type=float, default=0.05,
+                       help="Significance level of the Mann-Whitney U test (compare)")
+    parser.add_argument("--min-change", type=float, default=0.01,
+                       help="Smallest relative change worth flagging, e.g. 0.01 for 1%% (compare)")
+    parser.add_argument("--fail-on-regression", action="store_true",
+                       help="Exit with status 1 when compare finds a significant regression")
     
     args = parser.parse_args()
     
@@ -421,8 +631,11 @@ def main():
         
         baseline_results = load_benchmark_results(args.baseline)
         optimized_results = load_benchmark_results(args.optimized)
-        compare_benchmarks(baseline_results, optimized_results, 
-                         args.baseline_pattern, args.optimized_pattern)
+        regressions = compare_benchmarks(baseline_results, optimized_results,
+                                         args.baseline_pattern, args.optimized_pattern,
+                                         args.alpha, args.min_change)
+        if args.fail_on_regression and regressions > 0:
+            sys.exit(1)
     
     elif args.command == "report":
         if not args.results:
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "german_string.h"
+
+// Deterministic string datasets shaped like real keys. Whether the 4-byte prefix of a german string
+// decides a comparison depends on how keys start, so every benchmark family runs over each of them.
+// Generators only use the raw mt19937_64 output, the datasets are the same on every platform.
+namespace corpus
+{
+    enum class Kind
+    {
+        mixed,         // generate_random_strings of the benchmark, random text with a few known strings
+        urls,          // Few popular hosts, every string starts with "http"
+        paths,         // Filesystem paths under a handful of roots
+        uuids,         // Random version 4 UUIDs, unique prefixes
+        emails,        // Names at a few popular domains
+        words,         // Single English words, Zipf distributed, mostly small strings
+        numeric_ids,   // Decimal ids of 6 to 12 digits, all small strings
+        shared_prefix, // Long common prefix, the german string prefix never decides
+        file,          // Lines of the file named by GERMAN_STRINGS_CORPUS
+    };
+
+    // Names the file corpus reads from, empty when the variable is unset
+    inline std::string user_file()
+    {
+        const char *path = std::getenv("GERMAN_STRINGS_CORPUS");
+        return path != nullptr ? path : "";
+    }
+
+    inline const char *name(Kind kind)
+    {
+        switch (kind)
+        {
+        case Kind::mixed:
+            return "mixed";
+        case Kind::urls:
+            return "urls";
+        case Kind::paths:
+            return "paths";
+        case Kind::uuids:
+            return "uuids";
+        case Kind::emails:
+            return "emails";
+        case Kind::words:
+            return "words";
+        case Kind::numeric_ids:
+            return "numeric_ids";
+        case Kind::shared_prefix:
+            return "shared_prefix";
+        case Kind::file:
+            return "file";
+        }
+        return "unknown";
+    }
+
+    // Every corpus besides mixed, the file corpus only when GERMAN_STRINGS_CORPUS is set
+    inline std::vector<Kind> kinds()
+    {
+        std::vector<Kind> result = {Kind::urls, Kind::paths, Kind::uuids, Kind::emails,
+                                    Kind::words, Kind::numeric_ids, Kind::shared_prefix};
+        if (!user_file().empty())
+        {
+            result.push_back(Kind::file);
+        }
+        return result;
+    }
+
+    namespace detail
+    {
+        inline constexpr std::array<std::string_view, 128> WORDS = {
+            "the", "of", "and", "to", "in", "is", "you", "that", "it", "he",
+            "was", "for", "on", "are", "as", "with", "his", "they", "at", "be",
+            "this", "have", "from", "or", "one", "had", "by", "word", "but", "not",
+            "what", "all", "were", "we", "when", "your", "can", "said", "there", "use",
+            "an", "each", "which", "she", "do", "how", "their", "if", "will", "up",
+            "other", "about", "out", "many", "then", "them", "these", "so", "some", "her",
+            "would", "make", "like", "him", "into", "time", "has", "look", "two", "more",
+            "write", "go", "see", "number", "no", "way", "could", "people", "my", "than",
+            "first", "water", "been", "call", "who", "oil", "its", "now", "find", "long",
+            "down", "day", "did", "get", "come", "made", "may", "part", "over", "new",
+            "sound", "take", "only", "little", "work", "know", "place", "year", "live", "me",
+            "back", "give", "most", "very", "after", "thing", "our", "just", "name", "good",
+            "sentence", "man", "think", "say", "great", "where", "help", "through"};
+
+        inline constexpr std::array<std::string_view, 16> HOSTS = {
+            "www.google.com", "www.youtube.com", "en.wikipedia.org", "github.com",
+            "www.amazon.com", "www.reddit.com", "stackoverflow.com", "news.ycombinator.com",
+            "docs.python.org", "www.nytimes.com", "cdn.example.net", "api.example.com",
+            "mail.example.org", "shop.example.de", "blog.example.io", "static.example.com"};
+
+        inline constexpr std::array<std::string_view, 8> ROOTS = {
+            "/home/alice/", "/home/bob/", "/usr/lib/", "/usr/include/",
+            "/var/log/", "/opt/app/", "/srv/data/", "/tmp/"};
+
+        inline constexpr std::array<std::string_view, 8> EXTENSIONS = {
+            ".txt", ".cpp", ".h", ".json", ".log", ".so", ".py", ".md"};
+
+        inline constexpr std::array<std::string_view, 8> MAIL_DOMAINS = {
+            "gmail.com", "yahoo.com", "outlook.com", "hotmail.com",
+            "example.com", "corp.example.org", "mail.example.de", "icloud.com"};
+
+        inline constexpr std::string_view SHARED_PREFIX = "com.example.platform.metrics.service.";
+
+        // Uniform index in [0, n)
+        inline size_t uniform(std::mt19937_64 &rng, size_t n)
+        {
+            return rng() % n;
+        }
+
+        // Zipf (s = 1) distributed index in [0, n), popular entries first
+        class Zipf
+        {
+        private:
+            std::vector<double> cdf_;
+
+        public:
+            explicit Zipf(size_t n)
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    sum += 1.0 / static_cast<double>(i + 1);
+                    cdf_.push_back(sum);
+                }
+                for (auto &value : cdf_)
+                {
+                    value /= sum;
+                }
+            }
+
+            size_t operator()(std::mt19937_64 &rng) const
+            {
+                const double u = static_cast<double>(rng() >> 11) * 0x1.0p-53;
+                const auto it = std::upper_bound(cdf_.begin(), cdf_.end(), u);
+                return std::min(static_cast<size_t>(it - cdf_.begin()), cdf_.size() - 1);
+            }
+        };
+
+        inline void append_number(std::string &out, uint64_t value)
+        {
+            out += std::to_string(value);
+        }
+
+        inline std::string make_url(std::mt19937_64 &rng, const Zipf &hosts, const Zipf &words)
+        {
+            std::string url = uniform(rng, 10) == 0 ? "http://" : "https://";
+            url += HOSTS[hosts(rng)];
+            const size_t segments = 1 + uniform(rng, 4);
+            for (size_t i = 0; i < segments; ++i)
+            {
+                url += '/';
+                url += WORDS[words(rng)];
+                if (uniform(rng, 3) == 0)
+                {
+                    url += '-';
+                    append_number(url, uniform(rng, 100000));
+                }
+            }
+            if (uniform(rng, 3) == 0)
+            {
+                url += "?id=";
+                append_number(url, uniform(rng, 1000000));
+                url += "&ref=";
+                url += WORDS[words(rng)];
+            }
+            return url;
+        }
+
+        inline std::string make_path(std::mt19937_64 &rng, const Zipf &roots, const Zipf &words)
+        {
+            std::string path(ROOTS[roots(rng)]);
+            const size_t depth = uniform(rng, 5);
+            for (size_t i = 0; i < depth; ++i)
+            {
+                path += WORDS[words(rng)];
+                path += '/';
+            }
+            path += WORDS[words(rng)];
+            if (uniform(rng, 2) == 0)
+            {
+                path += '_';
+                append_number(path, uniform(rng, 1000));
+            }
+            path += EXTENSIONS[uniform(rng, EXTENSIONS.size())];
+            return path;
+        }
+
+        inline std::string make_uuid(std::mt19937_64 &rng)
+        {
+            constexpr std::string_view HEX = "0123456789abcdef";
+            uint64_t high = rng();
+            uint64_t low = rng();
+            high = (high & ~uint64_t{0xf000}) | 0x4000;                   // Version 4
+            low = (low & ~(uint64_t{0x3} << 62)) | (uint64_t{0x2} << 62); // RFC 4122 variant
+            std::string uuid;
+            uuid.reserve(36);
+            for (int i = 0; i < 32; ++i)
+            {
+                const uint64_t word = i < 16 ? high : low;
+                const int shift = 60 - 4 * (i % 16);
+                uuid += HEX[(word >> shift) & 0xf];
+                if (i == 7 || i == 11 || i == 15 || i == 19)
+                {
+                    uuid += '-';
+                }
+            }
+            return uuid;
+        }
+
+        inline std::string make_email(std::mt19937_64 &rng, const Zipf &domains, const Zipf &words)
+        {
+            std::string email(WORDS[words(rng)]);
+            if (uniform(rng, 2) == 0)
+            {
+                email += '.';
+                email += WORDS[words(rng)];
+            }
+            else
+            {
+                append_number(email, uniform(rng, 10000));
+            }
+            email += '@';
+            email += MAIL_DOMAINS[domains(rng)];
+            return email;
+        }
+
+        inline std::string make_shared_prefix(std::mt19937_64 &rng, const Zipf &words)
+        {
+            std::string key(SHARED_PREFIX);
+            key += WORDS[words(rng)];
+            key += '.';
+            append_number(key, uniform(rng, 1000000));
+            return key;
+        }
+    }
+
+    // Lines of path, repeated until there are count of them
+    inline std::vector<std::string> load_lines(const std::string &path, size_t count)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            throw std::runtime_error("Cannot open corpus file " + path);
+        }
+        std::vector<std::string> lines;
+        for (std::string line; lines.size() < count && std::getline(file, line);)
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            lines.push_back(std::move(line));
+        }
+        if (lines.empty())
+        {
+            throw std::runtime_error("Corpus file " + path + " has no lines");
+        }
+        for (size_t i = 0; lines.size() < count; ++i)
+        {
+            lines.push_back(lines[i]);
+        }
+        return lines;
+    }
+
+    // count strings of the corpus, the same ones for the same seed
+    inline std::vector<std::string> generate(Kind kind, size_t count, uint32_t seed = 42)
+    {
+        if (kind == Kind::file)
+        {
+            return load_lines(user_file(), count);
+        }
+        if (kind == Kind::mixed)
+        {
+            throw std::invalid_argument("The mixed corpus is generated by the benchmark itself");
+        }
+
+        std::mt19937_64 rng(seed);
+        const detail::Zipf words(detail::WORDS.size());
+        const detail::Zipf hosts(detail::HOSTS.size());
+        const detail::Zipf roots(detail::ROOTS.size());
+        const detail::Zipf domains(detail::MAIL_DOMAINS.size());
+        std::vector<std::string> strings;
+        strings.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            switch (kind)
+            {
+            case Kind::urls:
+                strings.push_back(detail::make_url(rng, hosts, words));
+                break;
+            case Kind::paths:
+                strings.push_back(detail::make_path(rng, roots, words));
+                break;
+            case Kind::uuids:
+                strings.push_back(detail::make_uuid(rng));
+                break;
+            case Kind::emails:
+                strings.push_back(detail::make_email(rng, domains, words));
+                break;
+            case Kind::words:
+                strings.emplace_back(detail::WORDS[words(rng)]);
+                break;
+            case Kind::numeric_ids:
+                strings.push_back(std::to_string(100000 + rng() % 999999900000ull));
+                break;
+            case Kind::shared_prefix:
+                strings.push_back(detail::make_shared_prefix(rng, words));
+                break;
+            case Kind::mixed:
+            case Kind::file:
+                break;
+            }
+        }
+        return strings;
+    }
+
+    // Owning copies of the strings in the benchmarked type
+    template <typename StringType>
+    std::vector<StringType> to_strings(const std::vector<std::string> &source)
+    {
+        std::vector<StringType> strings;
+        strings.reserve(source.size());
+        for (const auto &str : source)
+        {
+            if constexpr (std::is_same_v<StringType, std::string>)
+            {
+                strings.push_back(str);
+            }
+            else
+            {
+                strings.emplace_back(str.c_str(), static_cast<uint32_t>(str.size()), gs::temporary_t{});
+            }
+        }
+        return strings;
+    }
+
+    // Shape of a dataset as it matters to german strings
+    struct Summary
+    {
+        double mean_length = 0.0;
+        double small_fraction = 0.0;      // Strings of up to 12 bytes, stored inline
+        double prefix_tie_fraction = 0.0; // Neighbours in sorted order whose first 4 bytes are equal
+    };
+
+    inline Summary summarize(std::vector<std::string> strings)
+    {
+        Summary summary;
+        if (strings.empty())
+        {
+            return summary;
+        }
+        size_t bytes = 0;
+        size_t small = 0;
+        for (const auto &str : strings)
+        {
+            bytes += str.size();
+            if (str.size() <= 12)
+            {
+                ++small;
+            }
+        }
+        std::sort(strings.begin(), strings.end());
+        size_t ties = 0;
+        for (size_t i = 1; i < strings.size(); ++i)
+        {
+            if (std::string_view(strings[i - 1]).substr(0, 4) == std::string_view(strings[i]).substr(0, 4))
+            {
+                ++ties;
+            }
+        }
+        const auto count = static_cast<double>(strings.size());
+        summary.mean_length = static_cast<double>(bytes) / count;
+        summary.small_fraction = static_cast<double>(small) / count;
+        summary.prefix_tie_fraction = strings.size() > 1 ? static_cast<double>(ties) / (count - 1.0) : 0.0;
+        return summary;
+    }
+
+    // Benchmark label, e.g. "urls len=52.3 small=0% prefix_ties=100%"
+    inline std::string label(Kind kind, const std::vector<std::string> &strings)
+    {
+        const auto summary = summarize(strings);
+        char buffer[128];
+        std::snprintf(buffer, sizeof(buffer), "%s len=%.1f small=%.0f%% prefix_ties=%.0f%%", name(kind), summary.mean_length,
+                      summary.small_fraction * 100.0, summary.prefix_tie_fraction * 100.0);
+        return buffer;
+    }
+}
@@ -15,98 +15,16 @@
 #include <benchmark/benchmark.h>
 
 #include "german_string.h"
+#include "random_strings.h"
 
-constexpr auto SMALL_KNOWN_STRING = "Hello World";
-constexpr auto MEDIUM_KNOWN_STRING = "The quick brown fox jumps over the lazy dog and then continues running through the forest.";
-constexpr auto LARGE_KNOWN_STRING = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum.";
-
-// Common string patterns for realistic benchmarks
-const std::vector<std::string> COMMON_PREFIXES = {
-    "https://", "http://", "file://", "data:",
-    "user_", "admin_", "guest_", "system_",
-    "GET ", "POST ", "PUT ", "DELETE ",
-    "ERROR:", "WARNING:", "INFO:", "DEBUG:",
-    "/home/", "/usr/", "/var/", "/tmp/"
-};
-
-const std::vector<std::string> COMMON_SUFFIXES = {
-    ".txt", ".cpp", ".h", ".json", ".xml",
-    "_backup", "_temp", "_old", "_new",
-    "?query=1", "&param=value", "#section",
-    ".log", ".dat", ".bin"
-};
-
-template <typename StringType>
-std::vector<StringType> generate_random_strings(size_t count, uint32_t min_length, uint32_t max_length, uint32_t seed)
-{
-    std::vector<StringType> strings;
-    strings.reserve(count);
-    std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()_+[]{}|;:,.<>?/-_";
-    std::mt19937 generator(seed);
-    std::uniform_int_distribution<> length_distribution(min_length, max_length);
-    std::uniform_int_distribution<> char_distribution(0, static_cast<int>(alphabet.size() - 1));
-
-    constexpr float small_known_string_probability = 0.08f;
-    constexpr float medium_known_string_probability = 0.05f;
-    constexpr float large_known_string_probability = 0.03f;
-    constexpr float common_pattern_probability = 0.15f;
-    std::uniform_real_distribution<> known_string_distribution(0.0f, 1.0f);
-    std::uniform_int_distribution<> prefix_distribution(0, static_cast<int>(COMMON_PREFIXES.size() - 1));
-    std::uniform_int_distribution<> suffix_distribution(0, static_cast<int>(COMMON_SUFFIXES.size() - 1));
-
-    for (size_t i = 0; i < count; ++i)
-    {
-        float rand_val = known_string_distribution(generator);
-        
-        if (rand_val < small_known_string_probability)
-        {
-            strings.emplace_back(SMALL_KNOWN_STRING);
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability)
-        {
-            strings.emplace_back(MEDIUM_KNOWN_STRING);
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability + large_known_string_probability)
-        {
-            strings.emplace_back(LARGE_KNOWN_STRING);
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability + large_known_string_probability + common_pattern_probability)
-        {
-            // Generate strings with common patterns
-            std::string pattern_string = COMMON_PREFIXES[prefix_distribution(generator)];
-            size_t remaining_length = std::max(0, static_cast<int>(length_distribution(generator)) - static_cast<int>(pattern_string.length()));
-            for (size_t j = 0; j < remaining_length; ++j)
-            {
-                pattern_string += alphabet[char_distribution(generator)];
-            }
-            if (rand_val > 0.5f) // 50% chance to add suffix
-            {
-                pattern_string += COMMON_SUFFIXES[suffix_distribution(generator)];
-            }
-            strings.emplace_back(pattern_string.c_str());
-            continue;
-        }
-
-        // Generate completely random string
-        std::string new_built_string;
-        size_t length = length_distribution(generator);
-        for (size_t j = 0; j < length; ++j)
-        {
-            new_built_string += alphabet[char_distribution(generator)];
-        }
-        strings.emplace_back(new_built_string.c_str());
-    }
-    return strings;
-}
+// Container, construction and search benchmarks, built as german_strings_talk_enhanced_benchmarks.
+// Inputs are generated before the timed loop, only the operation under test is measured.
 
 // 1. Construction Benchmarks
 template <typename StringType>
 void StringConstruction(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t string_length = static_cast<uint32_t>(state.range(1));
     uint32_t seed = static_cast<uint32_t>(state.range(2));
     
@@ -118,14 +36,21 @@ void StringConstruction(benchmark::State &state)
         strings.reserve(count);
         for (const auto &str : random_strings)
         {
-            strings.emplace_back(str.c_str());
+            if constexpr (std::is_same_v<StringType, std::string>)
+            {
+                strings.emplace_back(str);
+            }
+            else
+            {
+                strings.emplace_back(str.c_str(), static_cast<uint32_t>(str.length()), gs::temporary_t{});
+            }
         }
         benchmark::DoNotOptimize(strings);
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * count);
-    state.SetBytesProcessed(state.iterations() * count * string_length);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(count * string_length));
 }
 
 BENCHMARK_TEMPLATE(StringConstruction, std::string)
@@ -146,7 +71,7 @@ BENCHMARK_TEMPLATE(StringConstruction, gs::german_string)
 template <typename StringType>
 void StringCopyConstruction(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t string_length = static_cast<uint32_t>(state.range(1));
     uint32_t seed = static_cast<uint32_t>(state.range(2));
     
@@ -164,8 +89,8 @@ void StringCopyConstruction(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * count);
-    state.SetBytesProcessed(state.iterations() * count * string_length);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(count * string_length));
 }
 
 BENCHMARK_TEMPLATE(StringCopyConstruction, std::string)
@@ -182,7 +107,7 @@ BENCHMARK_TEMPLATE(StringCopyConstruction, gs::german_string)
 template <typename StringType>
 void StringHashMapInsertion(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t min_length = static_cast<uint32_t>(state.range(1));
     uint32_t max_length = static_cast<uint32_t>(state.range(2));
     uint32_t seed = static_cast<uint32_t>(state.range(3));
@@ -201,7 +126,7 @@ void StringHashMapInsertion(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
 }
 
 BENCHMARK_TEMPLATE(StringHashMapInsertion, std::string)
@@ -218,7 +143,7 @@ BENCHMARK_TEMPLATE(StringHashMapInsertion, gs::german_string)
 template <typename StringType>
 void StringHashMapLookup(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t min_length = static_cast<uint32_t>(state.range(1));
     uint32_t max_length = static_cast<uint32_t>(state.range(2));
     uint32_t seed = static_cast<uint32_t>(state.range(3));
@@ -232,14 +157,19 @@ void StringHashMapLookup(benchmark::State &state)
     }
     
     std::mt19937 lookup_gen(seed + 1000);
-    std::uniform_int_distribution<> lookup_dist(0, static_cast<int>(strings.size() - 1));
+    std::uniform_int_distribution<size_t> lookup_dist(0, strings.size() - 1);
+    std::vector<size_t> lookups(1000);
+    for (auto &index : lookups)
+    {
+        index = lookup_dist(lookup_gen);
+    }
     
     for (auto _ : state)
     {
         int total = 0;
-        for (int i = 0; i < 1000; ++i)
+        for (const size_t index : lookups)
         {
-            auto it = hash_map.find(strings[lookup_dist(lookup_gen)]);
+            auto it = hash_map.find(strings[index]);
             if (it != hash_map.end())
             {
                 total += it->second;
@@ -249,7 +179,7 @@ void StringHashMapLookup(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * 1000);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(lookups.size()));
 }
 
 BENCHMARK_TEMPLATE(StringHashMapLookup, std::string)
@@ -266,7 +196,7 @@ BENCHMARK_TEMPLATE(StringHashMapLookup, gs::german_string)
 template <typename StringType>
 void StringSetInsertion(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t min_length = static_cast<uint32_t>(state.range(1));
     uint32_t max_length = static_cast<uint32_t>(state.range(2));
     uint32_t seed = static_cast<uint32_t>(state.range(3));
@@ -284,7 +214,7 @@ void StringSetInsertion(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
 }
 
 BENCHMARK_TEMPLATE(StringSetInsertion, std::string)
@@ -295,62 +225,35 @@ BENCHMARK_TEMPLATE(StringSetInsertion, gs::german_string)
     ->Args({1000, 8, 128, 42})
     ->Args({10000, 8, 128, 42});
 
-// 6. String Length Scenarios
-template <typename StringType>
-void StringComparisonByLength(benchmark::State &state)
-{
-    uint32_t length = static_cast<uint32_t>(state.range(0));
-    uint32_t seed = static_cast<uint32_t>(state.range(1));
-    
-    auto strings = generate_random_strings<StringType>(2000, length, length, seed);
-    
-    for (auto _ : state)
-    {
-        size_t equal_count = 0;
-        for (size_t i = 0; i < strings.size(); i += 2)
-        {
-            if (i + 1 < strings.size() && strings[i] == strings[i + 1])
-            {
-                ++equal_count;
-            }
-        }
-        benchmark::DoNotOptimize(equal_count);
-        benchmark::ClobberMemory();
-    }
-    
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
-}
-
-BENCHMARK_TEMPLATE(StringComparisonByLength, std::string)
-    ->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
-
-BENCHMARK_TEMPLATE(StringComparisonByLength, gs::german_string)
-    ->Arg(4)->Arg(8)->Arg(16)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(512)->Arg(1024);
-
-// 7. Memory Usage Simulation
+// 6. Memory Usage Simulation
 template <typename StringType>
 void StringVectorResize(benchmark::State &state)
 {
-    size_t final_size = state.range(0);
+    size_t final_size = static_cast<size_t>(state.range(0));
     uint32_t string_length = static_cast<uint32_t>(state.range(1));
     uint32_t seed = static_cast<uint32_t>(state.range(2));
     
     auto template_strings = generate_random_strings<StringType>(100, string_length, string_length, seed);
     std::mt19937 gen(seed);
-    std::uniform_int_distribution<> dist(0, static_cast<int>(template_strings.size() - 1));
+    std::uniform_int_distribution<size_t> dist(0, template_strings.size() - 1);
+    std::vector<size_t> picks(final_size);
+    for (auto &index : picks)
+    {
+        index = dist(gen);
+    }
     
     for (auto _ : state)
     {
         std::vector<StringType> strings;
-        for (size_t i = 0; i < final_size; ++i)
+        for (const size_t index : picks)
         {
-            strings.push_back(template_strings[dist(gen)]);
+            strings.push_back(template_strings[index]);
         }
         benchmark::DoNotOptimize(strings);
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * final_size);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(final_size));
 }
 
 BENCHMARK_TEMPLATE(StringVectorResize, std::string)
@@ -365,36 +268,32 @@ BENCHMARK_TEMPLATE(StringVectorResize, gs::german_string)
     ->Args({10000, 128, 42})
     ->Args({100000, 128, 42});
 
-// 8. Substring and Search Operations
+// 7. Substring and Search Operations
 template <typename StringType>
 void StringSearch(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t string_length = static_cast<uint32_t>(state.range(1));
     uint32_t seed = static_cast<uint32_t>(state.range(2));
     
-    auto strings = generate_random_strings<StringType>(count, string_length, string_length, seed);
+    auto source_strings = generate_random_strings<std::string>(count, string_length, string_length, seed);
+    std::vector<StringType> strings;
     std::vector<StringType> search_terms;
+    strings.reserve(count);
     search_terms.reserve(100);
+    for (const auto &source : source_strings)
+    {
+        strings.emplace_back(source);
+    }
     
-    // Create search terms from substrings of existing strings
+    // Create search terms from 4-byte substrings of existing strings, the same terms for both types
     std::mt19937 gen(seed + 5000);
-    std::uniform_int_distribution<> string_dist(0, static_cast<int>(strings.size() - 1));
-    std::uniform_int_distribution<> pos_dist(0, std::max(0, static_cast<int>(string_length) - 4));
-    
+    std::uniform_int_distribution<size_t> string_dist(0, source_strings.size() - 1);
     for (int i = 0; i < 100; ++i)
     {
-        const auto &source = strings[string_dist(gen)];
-        if constexpr (std::is_same_v<StringType, std::string>)
-        {
-            int start_pos = pos_dist(gen);
-            search_terms.emplace_back(source.substr(start_pos, 4));
-        }
-        else
-        {
-            // For german_string, we'd need to implement substr or use a different approach
-            search_terms.emplace_back("test"); // placeholder
-        }
+        const auto &source = source_strings[string_dist(gen)];
+        std::uniform_int_distribution<size_t> pos_dist(0, source.size() > 4 ? source.size() - 4 : 0);
+        search_terms.emplace_back(source.substr(pos_dist(gen), 4));
     }
     
     for (auto _ : state)
@@ -413,8 +312,7 @@ void StringSearch(benchmark::State &state)
                 }
                 else
                 {
-                    // For german_string, implement basic equality check as placeholder
-                    if (str == search_term)
+                    if (str.as_string_view().find(search_term.as_string_view()) != std::string_view::npos)
                     {
                         ++found_count;
                     }
@@ -425,7 +323,7 @@ void StringSearch(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * search_terms.size() * strings.size());
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(search_terms.size() * strings.size()));
 }
 
 BENCHMARK_TEMPLATE(StringSearch, std::string)
@@ -436,10 +334,10 @@ BENCHMARK_TEMPLATE(StringSearch, gs::german_string)
     ->Args({1000, 64, 42})
     ->Args({5000, 64, 42});
 
-// 9. Different String Classes for german_string
+// 8. Different String Classes for german_string
 void GermanStringClassComparison(benchmark::State &state)
 {
-    size_t count = state.range(0);
+    size_t count = static_cast<size_t>(state.range(0));
     uint32_t string_length = static_cast<uint32_t>(state.range(1));
     uint32_t seed = static_cast<uint32_t>(state.range(2));
     int string_class_type = static_cast<int>(state.range(3)); // 0=temporary, 1=persistent, 2=transient
@@ -470,7 +368,7 @@ void GermanStringClassComparison(benchmark::State &state)
         benchmark::ClobberMemory();
     }
     
-    state.SetItemsProcessed(state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
     state.SetLabel(string_class_type == 0 ? "temporary" : 
                    string_class_type == 1 ? "persistent" : "transient");
 }
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "german_string.h"
+#include "german_string_join.h"
+
+// Equi-joins on string keys, built as german_strings_talk_join_benchmarks. The left side holds
+// unique keys, the right side four times as many probes of which a given percentage find a match.
+// Arguments are (key_length, selectivity_percent); the same kernels run over std::string keys.
+
+constexpr size_t JOIN_LEFT_COUNT = 100000;
+constexpr size_t JOIN_RIGHT_COUNT = 4 * JOIN_LEFT_COUNT;
+
+// Key of the given length that is unique to id: random letters followed by id in base 62, so the
+// prefix is random like the leading bytes of most real keys
+std::string make_join_key(std::mt19937 &generator, uint64_t id, size_t length)
+{
+    static constexpr char ALPHABET[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    constexpr size_t ID_DIGITS = 6;
+    std::uniform_int_distribution<size_t> char_distribution(0, sizeof(ALPHABET) - 2);
+    std::string key(std::max(length, ID_DIGITS), '0');
+    for (size_t i = 0; i + ID_DIGITS < key.size(); ++i)
+    {
+        key[i] = ALPHABET[char_distribution(generator)];
+    }
+    for (size_t i = 0; i < ID_DIGITS; ++i)
+    {
+        key[key.size() - 1 - i] = ALPHABET[id % (sizeof(ALPHABET) - 1)];
+        id /= sizeof(ALPHABET) - 1;
+    }
+    return key;
+}
+
+struct JoinInput
+{
+    std::vector<std::string> left;
+    std::vector<std::string> right;
+};
+
+// Seeded, so both string types of one argument pair join the same keys
+JoinInput join_input(size_t key_length, int64_t selectivity_percent)
+{
+    std::mt19937 generator(42);
+    JoinInput input;
+    input.left.reserve(JOIN_LEFT_COUNT);
+    for (size_t i = 0; i < JOIN_LEFT_COUNT; ++i)
+    {
+        input.left.push_back(make_join_key(generator, i, key_length));
+    }
+    std::uniform_int_distribution<size_t> left_distribution(0, JOIN_LEFT_COUNT - 1);
+    std::uniform_int_distribution<int64_t> percent_distribution(0, 99);
+    input.right.reserve(JOIN_RIGHT_COUNT);
+    for (size_t i = 0; i < JOIN_RIGHT_COUNT; ++i)
+    {
+        if (percent_distribution(generator) < selectivity_percent)
+        {
+            input.right.push_back(input.left[left_distribution(generator)]);
+        }
+        else
+        {
+            // Ids past the left side never match
+            input.right.push_back(make_join_key(generator, JOIN_LEFT_COUNT + i, key_length));
+        }
+    }
+    return input;
+}
+
+template <typename StringType>
+std::vector<StringType> to_join_keys(const std::vector<std::string> &source)
+{
+    std::vector<StringType> keys;
+    keys.reserve(source.size());
+    for (const auto &str : source)
+    {
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            keys.push_back(str);
+        }
+        else
+        {
+            keys.emplace_back(str.data(), static_cast<uint32_t>(str.size()), gs::temporary_t{});
+        }
+    }
+    return keys;
+}
+
+template <typename StringType, typename Join>
+void run_join(benchmark::State &state, Join join)
+{
+    const auto input = join_input(static_cast<size_t>(state.range(0)), state.range(1));
+    const auto left = to_join_keys<StringType>(input.left);
+    const auto right = to_join_keys<StringType>(input.right);
+
+    size_t match_count = 0;
+    for (auto _ : state)
+    {
+        const auto matches = join(std::span<const StringType>(left), std::span<const StringType>(right));
+        match_count = matches.size();
+        benchmark::DoNotOptimize(matches.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(left.size() + right.size()));
+    state.counters["matches"] = static_cast<double>(match_count);
+    state.SetLabel("length=" + std::to_string(state.range(0)) + " selectivity=" + std::to_string(state.range(1)) + "%");
+}
+
+template <typename StringType>
+void HashJoin(benchmark::State &state)
+{
+    run_join<StringType>(state, [](std::span<const StringType> left, std::span<const StringType> right)
+                         { return gs::hash_join<StringType>(left, right); });
+}
+
+// One partition, the table over all left keys outgrows the caches
+template <typename StringType>
+void HashJoinUnpartitioned(benchmark::State &state)
+{
+    run_join<StringType>(state, [](std::span<const StringType> left, std::span<const StringType> right)
+                         { return gs::hash_join<StringType>(left, right, 0); });
+}
+
+template <typename StringType>
+void SortMergeJoin(benchmark::State &state)
+{
+    run_join<StringType>(state, [](std::span<const StringType> left, std::span<const StringType> right)
+                         { return gs::sort_merge_join<StringType>(left, right); });
+}
+
+void join_args(benchmark::internal::Benchmark *benchmark)
+{
+    for (const int64_t key_length : {8, 16, 32, 64})
+    {
+        for (const int64_t selectivity_percent : {1, 10, 50, 100})
+        {
+            benchmark->Args({key_length, selectivity_percent});
+        }
+    }
+    benchmark->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(HashJoin, std::string)->Apply(join_args);
+BENCHMARK_TEMPLATE(HashJoin, gs::german_string)->Apply(join_args);
+BENCHMARK_TEMPLATE(HashJoinUnpartitioned, std::string)->Apply(join_args);
+BENCHMARK_TEMPLATE(HashJoinUnpartitioned, gs::german_string)->Apply(join_args);
+BENCHMARK_TEMPLATE(SortMergeJoin, std::string)->Apply(join_args);
+BENCHMARK_TEMPLATE(SortMergeJoin, gs::german_string)->Apply(join_args);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "german_string.h"
+#include "corpus.h"
+#include "random_strings.h"
+#include "string_layouts.h"
+
+// Alternative string layouts head to head, built as german_strings_talk_layout_benchmarks. Every
+// family runs the same template over std::string, gs::german_string, std::string_view and the
+// layouts of string_layouts.h on every corpus, and reports what the layout keeps in the object:
+// inline_fraction is the share of strings stored inline, in_object_fraction the share of the
+// benchmarked comparisons decided by the size, the prefix or inline bytes without a pointer chase.
+
+constexpr size_t LAYOUT_STRING_COUNT = 100000;
+
+// The source bytes and the strings under test. std::string_view borrows from the source, so both
+// live together and are never copied.
+template <typename StringType>
+struct LayoutStrings
+{
+    std::vector<std::string> source;
+    std::vector<StringType> strings;
+
+    LayoutStrings(benchmark::State &state, corpus::Kind kind)
+        : source(kind == corpus::Kind::mixed ? generate_random_strings<std::string>(LAYOUT_STRING_COUNT, 8, 128, 42)
+                                             : corpus::generate(kind, LAYOUT_STRING_COUNT))
+    {
+        strings.reserve(source.size());
+        for (const auto &str : source)
+        {
+            if constexpr (std::is_same_v<StringType, std::string> || std::is_same_v<StringType, std::string_view>)
+            {
+                strings.emplace_back(str);
+            }
+            else if constexpr (std::is_same_v<StringType, gs::german_string>)
+            {
+                strings.emplace_back(str.data(), static_cast<uint32_t>(str.size()), gs::temporary_t{});
+            }
+            else
+            {
+                strings.emplace_back(str.data(), str.size());
+            }
+        }
+        state.SetLabel(kind == corpus::Kind::mixed ? std::string("mixed") : corpus::label(kind, source));
+        state.counters["sizeof_string"] = static_cast<double>(sizeof(StringType));
+        state.counters["inline_fraction"] = inline_fraction();
+    }
+
+    LayoutStrings(const LayoutStrings &) = delete;
+    LayoutStrings &operator=(const LayoutStrings &) = delete;
+
+    double inline_fraction() const
+    {
+        const auto traits = layouts::traits<StringType>();
+        const auto small = std::count_if(source.begin(), source.end(),
+                                         [&](const std::string &str) { return str.size() <= traits.inline_capacity; });
+        return static_cast<double>(small) / static_cast<double>(std::max<size_t>(source.size(), 1));
+    }
+};
+
+// Whether a comparison of a and b is settled by the bytes kept in the object
+template <typename StringType>
+bool equality_in_object(std::string_view a, std::string_view b)
+{
+    const auto traits = layouts::traits<StringType>();
+    if (a.size() != b.size() || (a.size() <= traits.inline_capacity && b.size() <= traits.inline_capacity))
+    {
+        return true;
+    }
+    return a.substr(0, traits.prefix_size) != b.substr(0, traits.prefix_size);
+}
+
+template <typename StringType>
+bool ordering_in_object(std::string_view a, std::string_view b)
+{
+    const auto traits = layouts::traits<StringType>();
+    if (a.size() <= traits.inline_capacity && b.size() <= traits.inline_capacity)
+    {
+        return true;
+    }
+    const size_t checked = std::min({a.size(), b.size(), traits.prefix_size});
+    return a.substr(0, checked) != b.substr(0, checked) || checked == std::min(a.size(), b.size());
+}
+
+template <typename StringType, typename Predicate>
+double pairs_in_object(const std::vector<std::string> &source, Predicate in_object)
+{
+    size_t decided = 0;
+    for (size_t i = 0; i + 1 < source.size(); i += 2)
+    {
+        decided += in_object(source[i], source[i + 1]) ? 1u : 0u;
+    }
+    return static_cast<double>(decided) / static_cast<double>(std::max<size_t>(source.size() / 2, 1));
+}
+
+template <typename StringType>
+void LayoutEquality(benchmark::State &state, corpus::Kind kind)
+{
+    const LayoutStrings<StringType> input(state, kind);
+    const auto &strings = input.strings;
+
+    for (auto _ : state)
+    {
+        size_t equal_count = 0;
+        for (size_t i = 0; i + 1 < strings.size(); i += 2)
+        {
+            equal_count += strings[i] == strings[i + 1] ? 1u : 0u;
+        }
+        benchmark::DoNotOptimize(equal_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
+    state.counters["in_object_fraction"] = pairs_in_object<StringType>(input.source, equality_in_object<StringType>);
+}
+
+template <typename StringType>
+void LayoutLexicographic(benchmark::State &state, corpus::Kind kind)
+{
+    const LayoutStrings<StringType> input(state, kind);
+    const auto &strings = input.strings;
+
+    for (auto _ : state)
+    {
+        size_t less_count = 0;
+        for (size_t i = 0; i + 1 < strings.size(); i += 2)
+        {
+            less_count += strings[i] < strings[i + 1] ? 1u : 0u;
+        }
+        benchmark::DoNotOptimize(less_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
+    state.counters["in_object_fraction"] = pairs_in_object<StringType>(input.source, ordering_in_object<StringType>);
+}
+
+template <typename StringType>
+void LayoutStartsWith(benchmark::State &state, corpus::Kind kind)
+{
+    const LayoutStrings<StringType> input(state, kind);
+    const auto &strings = input.strings;
+    const std::string prefix_bytes = "https://";
+    const auto prefix = [&]
+    {
+        if constexpr (std::is_same_v<StringType, gs::german_string>)
+        {
+            return StringType(prefix_bytes.data(), static_cast<uint32_t>(prefix_bytes.size()), gs::temporary_t{});
+        }
+        else if constexpr (std::is_same_v<StringType, std::string> || std::is_same_v<StringType, std::string_view>)
+        {
+            return StringType(prefix_bytes);
+        }
+        else
+        {
+            return StringType(prefix_bytes.data(), prefix_bytes.size());
+        }
+    }();
+
+    for (auto _ : state)
+    {
+        size_t starts_with_count = 0;
+        for (const auto &str : strings)
+        {
+            starts_with_count += str.starts_with(prefix) ? 1u : 0u;
+        }
+        benchmark::DoNotOptimize(starts_with_count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size()));
+}
+
+template <typename StringType>
+void LayoutSorting(benchmark::State &state, corpus::Kind kind)
+{
+    LayoutStrings<StringType> input(state, kind);
+    auto &strings = input.strings;
+    std::mt19937 shuffle_generator(42);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::shuffle(strings.begin(), strings.end(), shuffle_generator);
+        state.ResumeTiming();
+
+        std::sort(strings.begin(), strings.end());
+        benchmark::DoNotOptimize(strings.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size()));
+
+    // The last comparisons of a sort are between neighbours in sorted order
+    auto sorted = input.source;
+    std::sort(sorted.begin(), sorted.end());
+    size_t decided = 0;
+    for (size_t i = 1; i < sorted.size(); ++i)
+    {
+        decided += ordering_in_object<StringType>(sorted[i - 1], sorted[i]) ? 1u : 0u;
+    }
+    state.counters["in_object_fraction"] = static_cast<double>(decided) / static_cast<double>(std::max<size_t>(sorted.size() - 1, 1));
+}
+
+template <typename StringType>
+void LayoutHashing(benchmark::State &state, corpus::Kind kind)
+{
+    const LayoutStrings<StringType> input(state, kind);
+    const auto &strings = input.strings;
+
+    for (auto _ : state)
+    {
+        uint64_t resulting_hash = 0;
+        for (const auto &str : strings)
+        {
+            resulting_hash ^= std::hash<StringType>{}(str);
+        }
+        benchmark::DoNotOptimize(resulting_hash);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size()));
+}
+
+using LayoutBenchmark = void (*)(benchmark::State &, corpus::Kind);
+
+// Every layout of a family, e.g. LayoutSorting<prefix8_sso20>/urls/100000. A macro since function
+// templates cannot be passed on uninstantiated.
+#define LAYOUT_FAMILY(Family)                                              \
+    std::vector<std::pair<std::string, LayoutBenchmark>>{                  \
+        {"std::string", Family<std::string>},                              \
+        {"gs::german_string", Family<gs::german_string>},                  \
+        {"std::string_view", Family<std::string_view>},                    \
+        {"pointer_length16", Family<layouts::PointerLengthString>},        \
+        {"prefix8_sso20", Family<layouts::Prefix8String>},                 \
+        {"prefix4_sso28", Family<layouts::Sso32String>}}
+
+void register_layout_family(const std::string &family, const std::vector<std::pair<std::string, LayoutBenchmark>> &layouts)
+{
+    std::vector<corpus::Kind> kinds = {corpus::Kind::mixed};
+    for (const auto kind : corpus::kinds())
+    {
+        kinds.push_back(kind);
+    }
+    for (const auto kind : kinds)
+    {
+        for (const auto &[layout, run] : layouts)
+        {
+            benchmark::RegisterBenchmark((family + "<" + layout + ">/" + corpus::name(kind)).c_str(), run, kind)
+                ->Arg(static_cast<int64_t>(LAYOUT_STRING_COUNT));
+        }
+    }
+}
+
+[[maybe_unused]] const bool layout_families_registered = []
+{
+    register_layout_family("LayoutEquality", LAYOUT_FAMILY(LayoutEquality));
+    register_layout_family("LayoutLexicographic", LAYOUT_FAMILY(LayoutLexicographic));
+    register_layout_family("LayoutStartsWith", LAYOUT_FAMILY(LayoutStartsWith));
+    register_layout_family("LayoutSorting", LAYOUT_FAMILY(LayoutSorting));
+    register_layout_family("LayoutHashing", LAYOUT_FAMILY(LayoutHashing));
+    return true;
+}();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "german_string.h"
+#include "perf_counters.h"
+
+// Where the heap payloads of the strings live, built as german_strings_talk_locality_benchmarks.
+// The strings are always visited in sorted order and only the placement of their bytes changes:
+//
+// - sorted: one arena in sorted order, a visit streams through memory
+// - random: the same arena in random order, every visit is a random access into a compact block
+// - scattered: separate mallocs spread over a heap fragmented on purpose, the footprint is several
+//   times the payload bytes
+//
+// Keys are 32 bytes, so both string types keep every payload on the heap. With shared_prefix set all
+// keys start with "key:" and every german string comparison has to dereference as well.
+
+constexpr size_t LOCALITY_KEY_LENGTH = 32;
+constexpr size_t LOCALITY_SLOT_SIZE = 48; // std::string allocates the terminator too
+constexpr size_t BALLAST_PER_STRING = 8;
+
+enum class Placement
+{
+    sorted,
+    random,
+    scattered,
+};
+
+const char *placement_name(Placement placement)
+{
+    switch (placement)
+    {
+    case Placement::sorted:
+        return "sorted";
+    case Placement::random:
+        return "random";
+    case Placement::scattered:
+        return "scattered";
+    }
+    return "unknown";
+}
+
+// Payload slots in the order the strings are constructed, i.e. sorted key order
+class PayloadHeap
+{
+private:
+    std::vector<char> arena_;
+    std::vector<void *> ballast_;
+    std::vector<char *> slots_;
+    size_t next_ = 0;
+
+public:
+    PayloadHeap(Placement placement, size_t count, uint32_t seed)
+    {
+        std::mt19937 generator(seed);
+        if (placement == Placement::scattered)
+        {
+            // Fill the heap with blocks of mixed sizes and free most of them at random, the payloads
+            // then land in holes all over it while the surviving blocks keep them apart
+            std::uniform_int_distribution<size_t> ballast_size(16, 256);
+            ballast_.resize(count * BALLAST_PER_STRING);
+            for (auto &block : ballast_)
+            {
+                block = std::malloc(ballast_size(generator));
+            }
+            std::shuffle(ballast_.begin(), ballast_.end(), generator);
+            for (size_t i = count; i < ballast_.size(); ++i)
+            {
+                std::free(ballast_[i]);
+            }
+            ballast_.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                slots_.push_back(static_cast<char *>(std::malloc(LOCALITY_SLOT_SIZE)));
+            }
+        }
+        else
+        {
+            arena_.resize(count * LOCALITY_SLOT_SIZE);
+            for (size_t i = 0; i < count; ++i)
+            {
+                slots_.push_back(arena_.data() + i * LOCALITY_SLOT_SIZE);
+            }
+        }
+        if (placement != Placement::sorted)
+        {
+            std::shuffle(slots_.begin(), slots_.end(), generator);
+        }
+    }
+
+    ~PayloadHeap()
+    {
+        if (arena_.empty())
+        {
+            for (char *slot : slots_)
+            {
+                std::free(slot);
+            }
+            for (void *block : ballast_)
+            {
+                std::free(block);
+            }
+        }
+    }
+
+    PayloadHeap(const PayloadHeap &) = delete;
+    PayloadHeap &operator=(const PayloadHeap &) = delete;
+
+    char *take(size_t size)
+    {
+        if (next_ >= slots_.size() || size > LOCALITY_SLOT_SIZE)
+        {
+            throw std::runtime_error("Payload heap has no slot for the allocation");
+        }
+        return slots_[next_++];
+    }
+
+    // Distinct 4 KiB pages holding payloads, per string: 48 / 4096 for an arena, close to 1 when
+    // every payload sits on a page of its own
+    double pages_per_string() const
+    {
+        std::vector<uintptr_t> pages;
+        pages.reserve(slots_.size());
+        for (const char *slot : slots_)
+        {
+            pages.push_back(reinterpret_cast<uintptr_t>(slot) / 4096);
+        }
+        std::sort(pages.begin(), pages.end());
+        const auto distinct = std::unique(pages.begin(), pages.end()) - pages.begin();
+        return static_cast<double>(distinct) / static_cast<double>(std::max<size_t>(slots_.size(), 1));
+    }
+};
+
+// Heap the PlacedAllocator takes from while strings are constructed. A global keeps the allocator
+// stateless, so german strings stay 16 bytes.
+PayloadHeap *current_payload_heap = nullptr;
+
+template <typename T>
+struct PlacedAllocator
+{
+    using value_type = T;
+
+    PlacedAllocator() noexcept = default;
+
+    template <typename U>
+    PlacedAllocator(const PlacedAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        return reinterpret_cast<T *>(current_payload_heap->take(n * sizeof(T)));
+    }
+
+    void deallocate(T *, size_t) noexcept
+    {
+        // Slots belong to the PayloadHeap
+    }
+
+    template <typename U>
+    bool operator==(const PlacedAllocator<U> &) const noexcept
+    {
+        return true;
+    }
+};
+
+using PlacedString = std::basic_string<char, std::char_traits<char>, PlacedAllocator<char>>;
+using PlacedGermanString = gs::basic_german_string<PlacedAllocator<char>>;
+static_assert(sizeof(PlacedGermanString) == sizeof(gs::german_string), "The allocator must not grow the german string");
+
+// Keys in sorted order, the strings constructed from them in that order and the heap under them
+template <typename StringType>
+struct PlacedStrings
+{
+    PayloadHeap heap;
+    std::vector<StringType> strings;
+
+    PlacedStrings(Placement placement, size_t count, bool shared_prefix)
+        : heap(placement, count, 42)
+    {
+        std::mt19937 generator(7);
+        const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        std::uniform_int_distribution<size_t> char_distribution(0, alphabet.size() - 1);
+        std::vector<std::string> keys(count, shared_prefix ? std::string("key:") : std::string());
+        for (auto &key : keys)
+        {
+            while (key.size() < LOCALITY_KEY_LENGTH)
+            {
+                key += alphabet[char_distribution(generator)];
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+
+        current_payload_heap = &heap;
+        strings.reserve(count);
+        for (const auto &key : keys)
+        {
+            if constexpr (std::is_same_v<StringType, PlacedString>)
+            {
+                strings.emplace_back(key.data(), key.size());
+            }
+            else
+            {
+                strings.emplace_back(key.data(), static_cast<uint32_t>(key.size()), gs::temporary_t{});
+            }
+        }
+        current_payload_heap = nullptr;
+    }
+
+    PlacedStrings(const PlacedStrings &) = delete;
+    PlacedStrings &operator=(const PlacedStrings &) = delete;
+};
+
+template <typename StringType>
+void report_placement(benchmark::State &state, const PlacedStrings<StringType> &input, Placement placement)
+{
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(input.strings.size()));
+    state.counters["pages_per_string"] = input.heap.pages_per_string();
+    state.SetLabel(std::string(placement_name(placement)) + (state.range(1) != 0 ? " shared_prefix" : ""));
+}
+
+template <typename StringType>
+void LocalityEquality(benchmark::State &state, Placement placement)
+{
+    const PlacedStrings<StringType> input(placement, static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    const auto &strings = input.strings;
+
+    perf::Scope perf(state, static_cast<double>(strings.size()));
+    for (auto _ : state)
+    {
+        size_t equal_count = 0;
+        for (size_t i = 1; i < strings.size(); ++i)
+        {
+            equal_count += strings[i - 1] == strings[i] ? 1u : 0u;
+        }
+        benchmark::DoNotOptimize(equal_count);
+    }
+    report_placement(state, input, placement);
+}
+
+template <typename StringType>
+void LocalityLexicographic(benchmark::State &state, Placement placement)
+{
+    const PlacedStrings<StringType> input(placement, static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    const auto &strings = input.strings;
+
+    perf::Scope perf(state, static_cast<double>(strings.size()));
+    for (auto _ : state)
+    {
+        // Against the neighbour two ahead, so the result is not known from the sorted order
+        size_t less_count = 0;
+        for (size_t i = 2; i < strings.size(); ++i)
+        {
+            less_count += strings[i] < strings[i - 2] ? 1u : 0u;
+        }
+        benchmark::DoNotOptimize(less_count);
+    }
+    report_placement(state, input, placement);
+}
+
+template <typename StringType>
+void LocalityHashing(benchmark::State &state, Placement placement)
+{
+    const PlacedStrings<StringType> input(placement, static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    const auto &strings = input.strings;
+
+    perf::Scope perf(state, static_cast<double>(strings.size()));
+    for (auto _ : state)
+    {
+        uint64_t resulting_hash = 0;
+        for (const auto &str : strings)
+        {
+            resulting_hash ^= std::hash<std::string_view>()(std::string_view(str.data(), str.size()));
+        }
+        benchmark::DoNotOptimize(resulting_hash);
+    }
+    report_placement(state, input, placement);
+}
+
+// The sort starts from a shuffle and ends in sorted order, the order the payloads were placed in
+template <typename StringType>
+void LocalitySorting(benchmark::State &state, Placement placement)
+{
+    PlacedStrings<StringType> input(placement, static_cast<size_t>(state.range(0)), state.range(1) != 0);
+    auto &strings = input.strings;
+    std::mt19937 shuffle_generator(42);
+
+    perf::Scope perf(state, static_cast<double>(strings.size()));
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        perf.pause();
+        std::shuffle(strings.begin(), strings.end(), shuffle_generator);
+        perf.resume();
+        state.ResumeTiming();
+
+        std::sort(strings.begin(), strings.end());
+        benchmark::DoNotOptimize(strings.data());
+        benchmark::ClobberMemory();
+    }
+    report_placement(state, input, placement);
+}
+
+using LocalityBenchmark = void (*)(benchmark::State &, Placement);
+
+// Both string types for every placement, e.g. LocalitySorting<gs::german_string>/scattered/100000/1
+void register_locality_family(const std::string &family, LocalityBenchmark std_benchmark, LocalityBenchmark gs_benchmark)
+{
+    const std::pair<std::string, LocalityBenchmark> types[] = {{family + "<std::string>", std_benchmark},
+                                                               {family + "<gs::german_string>", gs_benchmark}};
+    for (const auto placement : {Placement::sorted, Placement::random, Placement::scattered})
+    {
+        for (const auto &[name, run] : types)
+        {
+            benchmark::RegisterBenchmark((name + "/" + placement_name(placement)).c_str(), run, placement)
+                ->ArgsProduct({{10000, 100000, 1000000}, {0, 1}});
+        }
+    }
+}
+
+[[maybe_unused]] const bool locality_families_registered = []
+{
+    register_locality_family("LocalityEquality", LocalityEquality<PlacedString>, LocalityEquality<PlacedGermanString>);
+    register_locality_family("LocalityLexicographic", LocalityLexicographic<PlacedString>, LocalityLexicographic<PlacedGermanString>);
+    register_locality_family("LocalitySorting", LocalitySorting<PlacedString>, LocalitySorting<PlacedGermanString>);
+    register_locality_family("LocalityHashing", LocalityHashing<PlacedString>, LocalityHashing<PlacedGermanString>);
+    return true;
+}();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include "german_string.h"
+#include "corpus.h"
+
+// Memory footprint of containers of strings, built as german_strings_talk_memory_benchmarks. The
+// global operator new is replaced to count every heap allocation, so these benchmarks live in their
+// own executable and the timings of the other suites stay untouched.
+
+namespace
+{
+    struct AllocationCounters
+    {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    // Every operator new of the process
+    AllocationCounters global_allocations;
+
+    // Only allocations made through CountingAllocator, i.e. the out-of-line string buffers
+    AllocationCounters string_allocations;
+
+    struct AllocationSnapshot
+    {
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+
+        static AllocationSnapshot of(const AllocationCounters &counters)
+        {
+            return {counters.allocations.load(std::memory_order_relaxed), counters.bytes.load(std::memory_order_relaxed)};
+        }
+
+        AllocationSnapshot since(const AllocationSnapshot &earlier) const
+        {
+            return {allocations - earlier.allocations, bytes - earlier.bytes};
+        }
+    };
+
+    void count_allocation(AllocationCounters &counters, size_t bytes)
+    {
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    // Out of line, so the compiler does not see new-expressions paired with free
+#if defined(__GNUC__)
+    [[gnu::noinline]]
+#endif
+    void release(void *ptr) noexcept
+    {
+        std::free(ptr);
+    }
+}
+
+void *operator new(size_t size)
+{
+    count_allocation(global_allocations, size);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    release(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    release(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    release(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    release(ptr);
+}
+
+// Passed as the TAllocator of both string types to tell string buffers apart from container nodes
+template <typename T>
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U> &) noexcept
+    {
+    }
+
+    T *allocate(size_t n)
+    {
+        count_allocation(string_allocations, n * sizeof(T));
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *ptr, size_t n) noexcept
+    {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U> &) const noexcept
+    {
+        return true;
+    }
+};
+
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+using CountedGermanString = gs::basic_german_string<CountingAllocator<char>>;
+
+// The same hash for both types, std::hash only knows the default allocators
+struct StringHash
+{
+    template <typename StringType>
+    size_t operator()(const StringType &str) const noexcept
+    {
+        return std::hash<std::string_view>()(std::string_view(str.data(), str.size()));
+    }
+};
+
+// Owning copy of a corpus string, german strings own their buffer like std::string does
+template <typename StringType>
+StringType make_string(const std::string &source)
+{
+    if constexpr (std::is_same_v<StringType, CountedString>)
+    {
+        return StringType(source.data(), source.size());
+    }
+    else
+    {
+        return StringType(source.data(), static_cast<typename StringType::size_type>(source.size()), gs::temporary_t{});
+    }
+}
+
+template <typename StringType>
+struct VectorContainer
+{
+    static constexpr const char *NAME = "MemoryVector";
+
+    static std::vector<StringType> build(const std::vector<std::string> &source)
+    {
+        std::vector<StringType> strings;
+        strings.reserve(source.size());
+        for (const auto &str : source)
+        {
+            strings.push_back(make_string<StringType>(str));
+        }
+        return strings;
+    }
+};
+
+template <typename StringType>
+struct UnorderedMapContainer
+{
+    static constexpr const char *NAME = "MemoryUnorderedMap";
+
+    static std::unordered_map<StringType, uint32_t, StringHash> build(const std::vector<std::string> &source)
+    {
+        std::unordered_map<StringType, uint32_t, StringHash> map;
+        map.reserve(source.size());
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            map.emplace(make_string<StringType>(source[i]), static_cast<uint32_t>(i));
+        }
+        return map;
+    }
+};
+
+template <typename StringType>
+struct MapContainer
+{
+    static constexpr const char *NAME = "MemoryMap";
+
+    static std::map<StringType, uint32_t> build(const std::vector<std::string> &source)
+    {
+        std::map<StringType, uint32_t> map;
+        for (size_t i = 0; i < source.size(); ++i)
+        {
+            map.emplace(make_string<StringType>(source[i]), static_cast<uint32_t>(i));
+        }
+        return map;
+    }
+};
+
+// Resident set size from /proc, 0 where it is not available
+#if defined(__linux__)
+uint64_t proc_status_bytes(std::string_view field)
+{
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);)
+    {
+        if (line.starts_with(field) && line.size() > field.size() && line[field.size()] == ':')
+        {
+            return std::strtoull(line.c_str() + field.size() + 1, nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+// Returns freed heap memory to the system and resets the peak to the current RSS
+uint64_t reset_peak_rss()
+{
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    std::ofstream("/proc/self/clear_refs") << "5";
+    return proc_status_bytes("VmRSS");
+}
+
+uint64_t peak_rss()
+{
+    return proc_status_bytes("VmHWM");
+}
+#else
+uint64_t reset_peak_rss()
+{
+    return 0;
+}
+
+uint64_t peak_rss()
+{
+    return 0;
+}
+#endif
+
+// Builds the container over a corpus and reports, per entry, every heap byte and allocation, the
+// part of them spent on string buffers, and the peak RSS growth while the container was alive
+template <template <typename> class Container, typename StringType>
+void ContainerMemory(benchmark::State &state, corpus::Kind kind)
+{
+    const auto source = corpus::generate(kind, static_cast<size_t>(state.range(0)));
+
+    // One untimed build for the footprint, allocations are deterministic so a single one suffices
+    const uint64_t rss_before = reset_peak_rss();
+    const auto global_before = AllocationSnapshot::of(global_allocations);
+    const auto strings_before = AllocationSnapshot::of(string_allocations);
+    AllocationSnapshot global;
+    AllocationSnapshot strings;
+    uint64_t rss_growth = 0;
+    double entries = 0.0; // Maps drop duplicate keys
+    {
+        const auto container = Container<StringType>::build(source);
+        entries = static_cast<double>(std::max<size_t>(container.size(), 1));
+        global = AllocationSnapshot::of(global_allocations).since(global_before);
+        strings = AllocationSnapshot::of(string_allocations).since(strings_before);
+        const uint64_t rss_peak = peak_rss();
+        rss_growth = rss_peak > rss_before ? rss_peak - rss_before : 0;
+        benchmark::DoNotOptimize(container);
+    }
+
+    for (auto _ : state)
+    {
+        auto container = Container<StringType>::build(source);
+        benchmark::DoNotOptimize(container);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(source.size()));
+    state.counters["entries"] = entries;
+    state.counters["bytes_per_entry"] = static_cast<double>(global.bytes) / entries;
+    state.counters["allocs_per_entry"] = static_cast<double>(global.allocations) / entries;
+    state.counters["string_bytes_per_entry"] = static_cast<double>(strings.bytes) / entries;
+    state.counters["string_allocs_per_entry"] = static_cast<double>(strings.allocations) / entries;
+    state.counters["peak_rss_per_entry"] = static_cast<double>(rss_growth) / entries;
+    state.counters["sizeof_string"] = static_cast<double>(sizeof(StringType));
+    state.SetLabel(corpus::label(kind, source));
+}
+
+using MemoryBenchmark = void (*)(benchmark::State &, corpus::Kind);
+
+constexpr int64_t MEMORY_STRING_COUNT = 200000;
+
+// Registers one container for both string types over every corpus, e.g. MemoryMap<gs::german_string>/urls/200000
+template <template <typename> class Container>
+void register_container()
+{
+    const std::string family = Container<CountedString>::NAME;
+    const std::pair<std::string, MemoryBenchmark> types[] = {
+        {family + "<std::string>", ContainerMemory<Container, CountedString>},
+        {family + "<gs::german_string>", ContainerMemory<Container, CountedGermanString>}};
+    for (const auto kind : corpus::kinds())
+    {
+        for (const auto &[name, run] : types)
+        {
+            benchmark::RegisterBenchmark((name + "/" + corpus::name(kind)).c_str(), run, kind)
+                ->Arg(MEMORY_STRING_COUNT)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+}
+
+[[maybe_unused]] const bool containers_registered = []
+{
+    register_container<VectorContainer>();
+    register_container<UnorderedMapContainer>();
+    register_container<MapContainer>();
+    return true;
+}();
+
+BENCHMARK_MAIN();
@@ -5,12 +5,14 @@
 #include <random>
 #include <unordered_set>
 #include <set>
+#include <algorithm>
+#include <functional>
 
 #include <benchmark/benchmark.h>
 
 #include "german_string.h"
 
-// Micro-benchmarks focusing on specific german_string features
+// Micro-benchmarks focusing on specific german_string features, built as german_strings_talk_micro_benchmarks
 
 // 1. Small String Optimization Boundary Testing
 void GermanStringSmallStringBoundary(benchmark::State &state)
@@ -138,7 +140,7 @@ void StringHashPerformance(benchmark::State &state)
         }
         else
         {
-            strings.emplace_back(temp_str.c_str(), static_cast<uint32_t>(temp_str.length()), gs::persistent_t{});
+            strings.emplace_back(temp_str.c_str(), static_cast<uint32_t>(temp_str.length()), gs::temporary_t{});
         }
     }
     
@@ -184,9 +186,9 @@ void GermanStringCachePerformance(benchmark::State &state)
     std::string template_str(string_length, 'A');
     for (uint32_t i = 0; i < count; ++i)
     {
-        // Vary the last character to make strings different
-        template_str.back() = 'A' + (i % 26);
-        strings.emplace_back(template_str.c_str(), string_length, gs::persistent_t{});
+        // Vary the last character to make strings different, each string owns a copy of the buffer
+        template_str.back() = static_cast<char>('A' + i % 26);
+        strings.emplace_back(template_str.c_str(), string_length, gs::temporary_t{});
     }
     
     std::vector<uint32_t> access_pattern;
@@ -306,4 +308,119 @@ BENCHMARK(GermanStringClassPerformance)
     ->Args({1000, 128, 1}) // persistent, longer strings
     ->Args({1000, 128, 2}); // transient, longer strings
 
+// 7. Passing strings to comparators: const german_string &, german_string by value, german_string_view
+// The comparators are not inlined, like ones behind a function pointer or in another translation
+// unit. A german_string by value runs the copy constructor, which copies the heap bytes of a
+// temporary string; the view is trivially copyable and travels in two registers. The inlined
+// std::less<> pair shows what sorting 16 byte views instead of german_string moves costs.
+std::vector<std::string> view_sort_sources(benchmark::State &state)
+{
+    const uint32_t count = static_cast<uint32_t>(state.range(0));
+    const uint32_t string_length = static_cast<uint32_t>(state.range(1));
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> char_dist('a', 'z');
+    std::vector<std::string> sources(count);
+    for (auto &source : sources)
+    {
+        for (uint32_t j = 0; j < string_length; ++j)
+        {
+            source += static_cast<char>(char_dist(gen));
+        }
+    }
+    return sources;
+}
+
+[[gnu::noinline]] bool less_by_reference(const gs::german_string &a, const gs::german_string &b)
+{
+    return a < b;
+}
+
+[[gnu::noinline]] bool less_by_copy(gs::german_string a, gs::german_string b)
+{
+    return a < b;
+}
+
+[[gnu::noinline]] bool less_by_view(gs::german_string_view a, gs::german_string_view b)
+{
+    return a < b;
+}
+
+struct ReferenceLess
+{
+    bool operator()(const gs::german_string &a, const gs::german_string &b) const
+    {
+        return less_by_reference(a, b);
+    }
+};
+
+struct CopyLess
+{
+    bool operator()(const gs::german_string &a, const gs::german_string &b) const
+    {
+        return less_by_copy(a, b);
+    }
+};
+
+struct ViewLess
+{
+    bool operator()(gs::german_string_view a, gs::german_string_view b) const
+    {
+        return less_by_view(a, b);
+    }
+};
+
+template <typename Element, typename Less>
+void GermanStringViewSorting(benchmark::State &state)
+{
+    const auto sources = view_sort_sources(state);
+    std::vector<gs::german_string> owned;
+    owned.reserve(sources.size());
+    for (const auto &source : sources)
+    {
+        owned.emplace_back(source.c_str(), static_cast<uint32_t>(source.length()), gs::temporary_t{});
+    }
+    // Views borrow the buffers of the owned strings, german strings are sorted in place
+    std::vector<gs::german_string_view> views(owned.begin(), owned.end());
+    auto &strings = [&]() -> std::vector<Element> &
+    {
+        if constexpr (std::is_same_v<Element, gs::german_string_view>)
+        {
+            return views;
+        }
+        else
+        {
+            return owned;
+        }
+    }();
+    std::mt19937 shuffle_generator(42);
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::shuffle(strings.begin(), strings.end(), shuffle_generator);
+        state.ResumeTiming();
+
+        std::sort(strings.begin(), strings.end(), Less{});
+        benchmark::DoNotOptimize(strings.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size()));
+    state.SetLabel(state.range(1) <= gs::german_string::SMALL_STRING_SIZE ? "inline" : "heap");
+}
+
+void view_sorting_args(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->Args({100000, 8})   // Inline strings, compared without leaving the object
+        ->Args({100000, 32})       // Heap strings with random prefixes
+        ->Args({1000000, 8})       // Inline strings, more of them
+        ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE(GermanStringViewSorting, gs::german_string, ReferenceLess)->Apply(view_sorting_args);
+BENCHMARK_TEMPLATE(GermanStringViewSorting, gs::german_string, CopyLess)->Apply(view_sorting_args);
+BENCHMARK_TEMPLATE(GermanStringViewSorting, gs::german_string_view, ViewLess)->Apply(view_sorting_args);
+BENCHMARK_TEMPLATE(GermanStringViewSorting, gs::german_string, std::less<>)->Apply(view_sorting_args);
+BENCHMARK_TEMPLATE(GermanStringViewSorting, gs::german_string_view, std::less<>)->Apply(view_sorting_args);
+
 BENCHMARK_MAIN();
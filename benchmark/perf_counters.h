@@ -0,0 +1,221 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <benchmark/benchmark.h>
+
+// Hardware counters for a benchmark loop through perf_event_open. Google Benchmark only collects
+// them when it was built with libpfm, which the packaged builds are not. Events the kernel or the
+// VM does not offer are skipped; without any, a benchmark reports time only.
+namespace perf
+{
+    enum class Event
+    {
+        cycles,
+        instructions,
+        l1d_misses,
+        llc_misses,
+        branch_misses,
+        count
+    };
+
+    inline constexpr std::array<const char *, static_cast<size_t>(Event::count)> EVENT_NAMES = {
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+    // User space counts of the calling thread, one file descriptor per event so a missing event
+    // does not take the others down. Multiplexed events are scaled to the time they were enabled.
+    class Counters
+    {
+    private:
+        std::array<int, static_cast<size_t>(Event::count)> fds_;
+
+#if defined(__linux__)
+        static int open_event(uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        void control(unsigned long request)
+        {
+            for (const int fd : fds_)
+            {
+                if (fd >= 0)
+                {
+                    ioctl(fd, request, 0);
+                }
+            }
+        }
+#endif
+
+    public:
+        Counters()
+        {
+            fds_.fill(-1);
+#if defined(__linux__)
+            constexpr uint64_t L1D_READ_MISS = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            fds_[static_cast<size_t>(Event::cycles)] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            fds_[static_cast<size_t>(Event::instructions)] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fds_[static_cast<size_t>(Event::l1d_misses)] = open_event(PERF_TYPE_HW_CACHE, L1D_READ_MISS);
+            fds_[static_cast<size_t>(Event::llc_misses)] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            fds_[static_cast<size_t>(Event::branch_misses)] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        ~Counters()
+        {
+#if defined(__linux__)
+            for (const int fd : fds_)
+            {
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        Counters(const Counters &) = delete;
+        Counters &operator=(const Counters &) = delete;
+
+        bool available(Event event) const
+        {
+            return fds_[static_cast<size_t>(event)] >= 0;
+        }
+
+        bool any_available() const
+        {
+            for (const int fd : fds_)
+            {
+                if (fd >= 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void reset_and_start()
+        {
+#if defined(__linux__)
+            control(PERF_EVENT_IOC_RESET);
+            control(PERF_EVENT_IOC_ENABLE);
+#endif
+        }
+
+        void start()
+        {
+#if defined(__linux__)
+            control(PERF_EVENT_IOC_ENABLE);
+#endif
+        }
+
+        void stop()
+        {
+#if defined(__linux__)
+            control(PERF_EVENT_IOC_DISABLE);
+#endif
+        }
+
+        // Count since reset_and_start, 0 for an unavailable event
+        double read(Event event) const
+        {
+#if defined(__linux__)
+            const int fd = fds_[static_cast<size_t>(event)];
+            uint64_t values[3] = {0, 0, 0}; // value, time enabled, time running
+            if (fd < 0 || ::read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[2] == 0)
+            {
+                return 0.0;
+            }
+            return static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+#else
+            (void)event;
+            return 0.0;
+#endif
+        }
+    };
+
+    // Counts the timed loop of one benchmark: construct right before the loop, call pause/resume
+    // together with PauseTiming/ResumeTiming, and the destructor adds per item counters, e.g.
+    // cycles_per_item, plus ipc. Items are whatever one iteration handles, one comparison for the
+    // comparison families.
+    class Scope
+    {
+    private:
+        benchmark::State &state_;
+        double items_per_iteration_;
+        Counters counters_;
+
+    public:
+        Scope(benchmark::State &state, double items_per_iteration)
+            : state_(state), items_per_iteration_(items_per_iteration > 0.0 ? items_per_iteration : 1.0)
+        {
+            static const bool warned = [this]
+            {
+                if (!counters_.any_available())
+                {
+                    std::fprintf(stderr, "Hardware performance counters are not available (no PMU or perf_event_paranoid too high), reporting time only\n");
+                }
+                return true;
+            }();
+            (void)warned;
+            counters_.reset_and_start();
+        }
+
+        ~Scope()
+        {
+            counters_.stop();
+            if (state_.iterations() == 0)
+            {
+                return;
+            }
+            for (size_t i = 0; i < EVENT_NAMES.size(); ++i)
+            {
+                const auto event = static_cast<Event>(i);
+                if (counters_.available(event))
+                {
+                    state_.counters[std::string(EVENT_NAMES[i]) + "_per_item"] =
+                        benchmark::Counter(counters_.read(event) / items_per_iteration_, benchmark::Counter::kAvgIterations);
+                }
+            }
+            const double cycles = counters_.read(Event::cycles);
+            if (counters_.available(Event::instructions) && cycles > 0.0)
+            {
+                state_.counters["ipc"] = counters_.read(Event::instructions) / cycles;
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        void pause()
+        {
+            counters_.stop();
+        }
+
+        void resume()
+        {
+            counters_.start();
+        }
+    };
+}
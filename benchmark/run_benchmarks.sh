@@ -28,6 +28,11 @@ print_usage() {
     echo "  compare            Compare std::string vs german_string performance"
     echo "  micro              Run micro-benchmarks focusing on specific features"
     echo "  enhanced           Run enhanced benchmarks with realistic scenarios"
+    echo "  memory             Run memory footprint and allocation count benchmarks"
+    echo "  threaded           Run multi-threaded scalability benchmarks"
+    echo "  layouts            Run alternative string layout benchmarks"
+    echo "  joins              Run hash and sort-merge join benchmarks"
+    echo "  locality           Run payload placement (cache locality) benchmarks"
     echo "  profile            Run benchmarks with profiling data"
     echo "  report             Generate detailed performance report"
     echo "  clean              Clean build directory"
@@ -38,7 +43,10 @@ print_usage() {
     echo "  --stdlib STDLIB    Standard library: libcxx (default), libstdcxx"
     echo "  --output DIR       Output directory for results (default: ./results)"
     echo "  --filter REGEX     Filter benchmarks by regex pattern"
-    echo "  --repetitions N    Number of repetitions for each benchmark (default: 3)"
+    echo "  --repetitions N    Number of repetitions for each benchmark (default: 5)"
+    echo "  --warmup SECONDS   Warmup time before each benchmark is measured (default: 0.5)"
+    echo "  --pin-cpu CPU      CPU to pin single-threaded benchmarks to with taskset (default: last CPU)"
+    echo "  --no-pin           Do not pin benchmarks to a CPU"
     echo "  --time-unit UNIT   Time unit: ns, us, ms, s (default: auto)"
     echo "  --format FORMAT    Output format: console, json, csv (default: json)"
     echo "  --parallel         Run benchmarks in parallel"
@@ -49,6 +57,9 @@ print_usage() {
     echo "  $0 run --filter \"StringSort\" --repetitions 5"
     echo "  $0 compare --output ./comparison_results"
     echo "  $0 micro --filter \"SmallString\""
+    echo ""
+    echo "Repetitions run interleaved, five or more are needed for analyze_results.py compare to find"
+    echo "significant changes."
 }
 
 # Default values
@@ -57,7 +68,9 @@ COMPILER="clang"
 STDLIB="libcxx"
 OUTPUT_DIR="$SCRIPT_DIR/results"
 FILTER=""
-REPETITIONS=3
+REPETITIONS=5
+WARMUP=0.5
+PIN_CPU="$(( $(nproc) - 1 ))"
 TIME_UNIT="auto"
 FORMAT="json"
 PARALLEL=false
@@ -89,6 +102,18 @@ while [[ $# -gt 0 ]]; do
             REPETITIONS="$2"
             shift 2
             ;;
+        --warmup)
+            WARMUP="$2"
+            shift 2
+            ;;
+        --pin-cpu)
+            PIN_CPU="$2"
+            shift 2
+            ;;
+        --no-pin)
+            PIN_CPU=""
+            shift
+            ;;
         --time-unit)
             TIME_UNIT="$2"
             shift 2
@@ -105,7 +130,7 @@ while [[ $# -gt 0 ]]; do
             print_usage
             exit 0
             ;;
-        build|run|compare|micro|enhanced|profile|report|clean)
+        build|run|compare|micro|enhanced|memory|threaded|layouts|joins|locality|profile|report|clean)
             COMMAND="$1"
             shift
             ;;
@@ -130,7 +155,14 @@ else
 fi
 
 ACTUAL_BUILD_DIR="$BUILD_DIR/$BUILD_PRESET"
-BENCHMARK_EXECUTABLE="$ACTUAL_BUILD_DIR/german_strings_talk_benchmarks"
+BENCHMARK_EXECUTABLE="german_strings_talk_benchmarks"
+MICRO_EXECUTABLE="german_strings_talk_micro_benchmarks"
+ENHANCED_EXECUTABLE="german_strings_talk_enhanced_benchmarks"
+MEMORY_EXECUTABLE="german_strings_talk_memory_benchmarks"
+THREADED_EXECUTABLE="german_strings_talk_threaded_benchmarks"
+LAYOUT_EXECUTABLE="german_strings_talk_layout_benchmarks"
+JOIN_EXECUTABLE="german_strings_talk_join_benchmarks"
+LOCALITY_EXECUTABLE="german_strings_talk_locality_benchmarks"
 
 # Create output directory
 mkdir -p "$OUTPUT_DIR"
@@ -150,10 +182,12 @@ build_benchmarks() {
     # Build
     cmake --build "$ACTUAL_BUILD_DIR" --parallel $(nproc)
     
-    if [[ ! -f "$BENCHMARK_EXECUTABLE" ]]; then
-        print_colored $RED "Error: Benchmark executable not found at $BENCHMARK_EXECUTABLE"
-        exit 1
-    fi
+    for executable in "$BENCHMARK_EXECUTABLE" "$MICRO_EXECUTABLE" "$ENHANCED_EXECUTABLE" "$MEMORY_EXECUTABLE" "$THREADED_EXECUTABLE" "$LAYOUT_EXECUTABLE" "$JOIN_EXECUTABLE" "$LOCALITY_EXECUTABLE"; do
+        if [[ ! -f "$ACTUAL_BUILD_DIR/$executable" ]]; then
+            print_colored $RED "Error: Benchmark executable not found at $ACTUAL_BUILD_DIR/$executable"
+            exit 1
+        fi
+    done
     
     print_colored $GREEN "Build completed successfully!"
 }
@@ -162,6 +196,7 @@ run_benchmark() {
     local benchmark_name="$1"
     local output_file="$2"
     local extra_args="$3"
+    local executable="${4:-$BENCHMARK_EXECUTABLE}"
     
     local benchmark_args=""
     
@@ -170,7 +205,12 @@ run_benchmark() {
     fi
     
     if [[ "$REPETITIONS" -gt 1 ]]; then
-        benchmark_args="$benchmark_args --benchmark_repetitions=$REPETITIONS"
+        # Interleaved repetitions spread slow drifts of the host over all benchmarks
+        benchmark_args="$benchmark_args --benchmark_repetitions=$REPETITIONS --benchmark_enable_random_interleaving=true"
+    fi
+    
+    if [[ "$WARMUP" != "0" ]]; then
+        benchmark_args="$benchmark_args --benchmark_min_warmup_time=$WARMUP"
     fi
     
     if [[ "$TIME_UNIT" != "auto" ]]; then
@@ -184,12 +224,26 @@ run_benchmark() {
         benchmark_args="$benchmark_args $extra_args"
     fi
     
+    # One CPU keeps the caches warm and the scheduler from migrating the benchmark, the threaded
+    # benchmarks need all of them
+    local launcher=""
+    if [[ -n "$PIN_CPU" && "$executable" != "$THREADED_EXECUTABLE" ]]; then
+        if command -v taskset > /dev/null; then
+            launcher="taskset -c $PIN_CPU"
+        else
+            print_colored $YELLOW "  taskset not found, running without CPU pinning"
+        fi
+    fi
+    
     print_colored $BLUE "Running $benchmark_name benchmarks..."
     print_colored $YELLOW "  Output: $output_file"
     print_colored $YELLOW "  Args: $benchmark_args"
+    if [[ -n "$launcher" ]]; then
+        print_colored $YELLOW "  Pinned to CPU $PIN_CPU"
+    fi
     
     cd "$ACTUAL_BUILD_DIR"
-    eval "./german_strings_talk_benchmarks $benchmark_args"
+    eval "$launcher ./$executable $benchmark_args"
     
     print_colored $GREEN "$benchmark_name benchmarks completed!"
 }
@@ -199,12 +253,21 @@ run_all_benchmarks() {
     local base_filename="benchmark_results_${BUILD_PRESET}_${timestamp}"
     
     run_benchmark "All" "$OUTPUT_DIR/${base_filename}.json"
+    run_benchmark "Micro" "$OUTPUT_DIR/${base_filename}_micro.json" "" "$MICRO_EXECUTABLE"
+    run_benchmark "Enhanced" "$OUTPUT_DIR/${base_filename}_enhanced.json" "" "$ENHANCED_EXECUTABLE"
+    run_benchmark "Memory" "$OUTPUT_DIR/${base_filename}_memory.json" "" "$MEMORY_EXECUTABLE"
+    run_benchmark "Threaded" "$OUTPUT_DIR/${base_filename}_threaded.json" "" "$THREADED_EXECUTABLE"
+    run_benchmark "Layouts" "$OUTPUT_DIR/${base_filename}_layouts.json" "" "$LAYOUT_EXECUTABLE"
+    run_benchmark "Joins" "$OUTPUT_DIR/${base_filename}_joins.json" "" "$JOIN_EXECUTABLE"
+    run_benchmark "Locality" "$OUTPUT_DIR/${base_filename}_locality.json" "" "$LOCALITY_EXECUTABLE"
     
     # If JSON format, also generate a readable report
     if [[ "$FORMAT" == "json" ]]; then
-        print_colored $BLUE "Generating readable report..."
-        "$SCRIPT_DIR/analyze_results.py" report --results "$OUTPUT_DIR/${base_filename}.json" \
-            --output "$OUTPUT_DIR/${base_filename}_report.md"
+        print_colored $BLUE "Generating readable reports..."
+        for suffix in "" "_micro" "_enhanced" "_memory" "_threaded" "_layouts" "_joins" "_locality"; do
+            "$SCRIPT_DIR/analyze_results.py" report --results "$OUTPUT_DIR/${base_filename}${suffix}.json" \
+                --output "$OUTPUT_DIR/${base_filename}${suffix}_report.md"
+        done
     fi
 }
 
@@ -217,12 +280,16 @@ run_comparison() {
     print_colored $BLUE "Running comparison benchmarks..."
     run_benchmark "Comparison" "$OUTPUT_DIR/comparison_${BUILD_PRESET}_${timestamp}.json" \
         "--benchmark_filter=\"$comparison_filter\""
+    run_benchmark "Container comparison" "$OUTPUT_DIR/comparison_enhanced_${BUILD_PRESET}_${timestamp}.json" \
+        "--benchmark_filter=\"$comparison_filter\"" "$ENHANCED_EXECUTABLE"
     
     # Generate comparison report
     if [[ "$FORMAT" == "json" ]]; then
         print_colored $BLUE "Generating comparison analysis..."
-        "$SCRIPT_DIR/analyze_results.py" report --results "$OUTPUT_DIR/comparison_${BUILD_PRESET}_${timestamp}.json" \
-            --output "$OUTPUT_DIR/comparison_${BUILD_PRESET}_${timestamp}_report.md"
+        for prefix in "comparison" "comparison_enhanced"; do
+            "$SCRIPT_DIR/analyze_results.py" report --results "$OUTPUT_DIR/${prefix}_${BUILD_PRESET}_${timestamp}.json" \
+                --output "$OUTPUT_DIR/${prefix}_${BUILD_PRESET}_${timestamp}_report.md"
+        done
         
         # Note: For direct comparison, we'd need separate runs or a more sophisticated analysis
         print_colored $YELLOW "For detailed std::string vs german_string comparison, run separate benchmarks and use the compare command."
@@ -232,21 +299,50 @@ run_comparison() {
 run_micro_benchmarks() {
     local timestamp=$(date +%Y%m%d_%H%M%S)
     
-    # Filter for micro-benchmarks specific to german_string features
-    local micro_filter="(GermanString|Prefix|Equality|Cache|Class)"
-    
-    run_benchmark "Micro" "$OUTPUT_DIR/micro_${BUILD_PRESET}_${timestamp}.json" \
-        "--benchmark_filter=\"$micro_filter\""
+    # Micro-benchmarks of german_string features live in their own executable, --filter narrows them
+    run_benchmark "Micro" "$OUTPUT_DIR/micro_${BUILD_PRESET}_${timestamp}.json" "" "$MICRO_EXECUTABLE"
 }
 
 run_enhanced_benchmarks() {
     local timestamp=$(date +%Y%m%d_%H%M%S)
     
-    # Filter for enhanced realistic scenario benchmarks
-    local enhanced_filter="(Construction|Copy|HashMap|Set|Vector|Search)"
+    # Construction, container and search scenarios live in their own executable, --filter narrows them
+    run_benchmark "Enhanced" "$OUTPUT_DIR/enhanced_${BUILD_PRESET}_${timestamp}.json" "" "$ENHANCED_EXECUTABLE"
+}
+
+run_memory_benchmarks() {
+    local timestamp=$(date +%Y%m%d_%H%M%S)
+    
+    # Bytes, allocations and peak RSS per entry are reported as counters next to the timings
+    run_benchmark "Memory" "$OUTPUT_DIR/memory_${BUILD_PRESET}_${timestamp}.json" "" "$MEMORY_EXECUTABLE"
+}
+
+run_threaded_benchmarks() {
+    local timestamp=$(date +%Y%m%d_%H%M%S)
+    
+    # Thread counts go up to the core count, times are wall clock
+    run_benchmark "Threaded" "$OUTPUT_DIR/threaded_${BUILD_PRESET}_${timestamp}.json" "" "$THREADED_EXECUTABLE"
+}
+
+run_layout_benchmarks() {
+    local timestamp=$(date +%Y%m%d_%H%M%S)
+    
+    # Inline and in-object fractions of every layout are reported as counters next to the timings
+    run_benchmark "Layouts" "$OUTPUT_DIR/layouts_${BUILD_PRESET}_${timestamp}.json" "" "$LAYOUT_EXECUTABLE"
+}
+
+run_join_benchmarks() {
+    local timestamp=$(date +%Y%m%d_%H%M%S)
+    
+    # Arguments are key length and selectivity in percent, match counts are reported as counters
+    run_benchmark "Joins" "$OUTPUT_DIR/joins_${BUILD_PRESET}_${timestamp}.json" "" "$JOIN_EXECUTABLE"
+}
+
+run_locality_benchmarks() {
+    local timestamp=$(date +%Y%m%d_%H%M%S)
     
-    run_benchmark "Enhanced" "$OUTPUT_DIR/enhanced_${BUILD_PRESET}_${timestamp}.json" \
-        "--benchmark_filter=\"$enhanced_filter\""
+    # Placements are sorted, random and scattered, hardware counters are added when available
+    run_benchmark "Locality" "$OUTPUT_DIR/locality_${BUILD_PRESET}_${timestamp}.json" "" "$LOCALITY_EXECUTABLE"
 }
 
 run_profiling() {
@@ -270,6 +366,10 @@ generate_report() {
     echo ""
     echo "To compare two result files, use:"
     echo "  $SCRIPT_DIR/analyze_results.py compare --baseline <baseline.json> --optimized <optimized.json>"
+    echo ""
+    echo "To check a change for regressions against an earlier run of the same benchmarks, use:"
+    echo "  $SCRIPT_DIR/analyze_results.py compare --baseline <before.json> --optimized <after.json> \\"
+    echo "      --baseline-pattern \"\" --optimized-pattern \"\" --fail-on-regression"
 }
 
 clean_build() {
@@ -299,6 +399,26 @@ case "$COMMAND" in
         build_benchmarks
         run_enhanced_benchmarks
         ;;
+    memory)
+        build_benchmarks
+        run_memory_benchmarks
+        ;;
+    threaded)
+        build_benchmarks
+        run_threaded_benchmarks
+        ;;
+    layouts)
+        build_benchmarks
+        run_layout_benchmarks
+        ;;
+    joins)
+        build_benchmarks
+        run_join_benchmarks
+        ;;
+    locality)
+        build_benchmarks
+        run_locality_benchmarks
+        ;;
     profile)
         build_benchmarks
         run_profiling
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "german_string.h"
+
+// Alternative string layouts, benchmarked head to head with std::string and gs::german_string to
+// see which design choices of the german string matter. All of them own a copy of their bytes
+// and offer the operations the layout benchmarks use (size, data, ==, <=>, starts_with, std::hash).
+// Copies are deep and moves steal the buffer. std::string_view is the fifth layout, borrowed bytes
+// without a prefix or inline storage.
+namespace layouts
+{
+    // 16 bytes, a heap pointer and a length. No prefix and no inline storage, every comparison
+    // dereferences the pointer.
+    class PointerLengthString
+    {
+    private:
+        char *data_ = nullptr;
+        size_t size_ = 0;
+
+    public:
+        PointerLengthString() = default;
+
+        PointerLengthString(const char *str, size_t size)
+            : data_(size != 0 ? new char[size] : nullptr), size_(size)
+        {
+            if (size != 0)
+            {
+                std::memcpy(data_, str, size);
+            }
+        }
+
+        PointerLengthString(const PointerLengthString &other)
+            : PointerLengthString(other.data_, other.size_)
+        {
+        }
+
+        PointerLengthString(PointerLengthString &&other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0))
+        {
+        }
+
+        PointerLengthString &operator=(PointerLengthString other) noexcept
+        {
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        ~PointerLengthString()
+        {
+            delete[] data_;
+        }
+
+        const char *data() const
+        {
+            return data_;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        std::string_view as_string_view() const
+        {
+            return std::string_view(data_, size_);
+        }
+
+        bool operator==(const PointerLengthString &other) const
+        {
+            return size_ == other.size_ && (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+        }
+
+        std::strong_ordering operator<=>(const PointerLengthString &other) const
+        {
+            return as_string_view() <=> other.as_string_view();
+        }
+
+        bool starts_with(const PointerLengthString &other) const
+        {
+            return as_string_view().starts_with(other.as_string_view());
+        }
+    };
+
+    // TotalBytes wide german string style layout with a PrefixBytes wide prefix: a 4 byte size, then
+    // either up to TotalBytes - 4 inline bytes, or the prefix followed by a pointer in the last 8
+    // bytes. Unused bytes are zero, so an inline string compares equal with one memcmp of the object.
+    // PrefixedString<16, 4> is the german string layout itself.
+    template <size_t TotalBytes, size_t PrefixBytes>
+    class PrefixedString
+    {
+    public:
+        using size_type = std::uint32_t;
+        static constexpr size_t INLINE_CAPACITY = TotalBytes - sizeof(size_type);
+        static constexpr size_t PREFIX_SIZE = PrefixBytes;
+
+    private:
+        static constexpr size_t PREFIX_OFFSET = sizeof(size_type);
+        static constexpr size_t POINTER_OFFSET = TotalBytes - sizeof(char *);
+        static_assert(TotalBytes % alignof(char *) == 0, "The pointer must stay aligned");
+        static_assert(PREFIX_OFFSET + PrefixBytes <= POINTER_OFFSET, "The prefix must not overlap the pointer");
+
+        alignas(char *) unsigned char bytes_[TotalBytes];
+
+        bool is_inline() const
+        {
+            return size() <= INLINE_CAPACITY;
+        }
+
+        char *heap_ptr() const
+        {
+            char *ptr;
+            std::memcpy(&ptr, bytes_ + POINTER_OFFSET, sizeof(ptr));
+            return ptr;
+        }
+
+        void assign(const char *str, size_type size)
+        {
+            std::memset(bytes_, 0, TotalBytes);
+            std::memcpy(bytes_, &size, sizeof(size));
+            if (size <= INLINE_CAPACITY)
+            {
+                std::memcpy(bytes_ + PREFIX_OFFSET, str, size);
+                return;
+            }
+            char *copied_str = new char[size];
+            std::memcpy(copied_str, str, size);
+            std::memcpy(bytes_ + PREFIX_OFFSET, str, PrefixBytes);
+            std::memcpy(bytes_ + POINTER_OFFSET, &copied_str, sizeof(copied_str));
+        }
+
+        void release()
+        {
+            if (!is_inline())
+            {
+                delete[] heap_ptr();
+            }
+        }
+
+    public:
+        PrefixedString()
+        {
+            std::memset(bytes_, 0, TotalBytes);
+        }
+
+        PrefixedString(const char *str, size_t size)
+        {
+            assign(str, gs::detail::_checked_size_cast(size));
+        }
+
+        PrefixedString(const PrefixedString &other)
+        {
+            assign(other.data(), other.size());
+        }
+
+        PrefixedString(PrefixedString &&other) noexcept
+        {
+            std::memcpy(bytes_, other.bytes_, TotalBytes);
+            std::memset(other.bytes_, 0, TotalBytes);
+        }
+
+        PrefixedString &operator=(PrefixedString other) noexcept
+        {
+            std::swap(bytes_, other.bytes_);
+            return *this;
+        }
+
+        ~PrefixedString()
+        {
+            release();
+        }
+
+        size_type size() const
+        {
+            size_type size;
+            std::memcpy(&size, bytes_, sizeof(size));
+            return size;
+        }
+
+        const char *data() const
+        {
+            return is_inline() ? reinterpret_cast<const char *>(bytes_ + PREFIX_OFFSET) : heap_ptr();
+        }
+
+        std::string_view as_string_view() const
+        {
+            return std::string_view(data(), size());
+        }
+
+        bool operator==(const PrefixedString &other) const
+        {
+            // Size and prefix first, they live in the object
+            if (std::memcmp(bytes_, other.bytes_, PREFIX_OFFSET + PrefixBytes) != 0)
+            {
+                return false;
+            }
+            if (is_inline())
+            {
+                return std::memcmp(bytes_, other.bytes_, TotalBytes) == 0;
+            }
+            return std::memcmp(heap_ptr() + PrefixBytes, other.heap_ptr() + PrefixBytes, size() - PrefixBytes) == 0;
+        }
+
+        std::strong_ordering operator<=>(const PrefixedString &other) const
+        {
+            const size_t min_size = std::min(size(), other.size());
+            const size_t prefix_size = std::min(min_size, PrefixBytes);
+            int result = std::memcmp(bytes_ + PREFIX_OFFSET, other.bytes_ + PREFIX_OFFSET, prefix_size);
+            if (result == 0 && min_size > prefix_size)
+            {
+                result = std::memcmp(data() + prefix_size, other.data() + prefix_size, min_size - prefix_size);
+            }
+            return result != 0 ? result <=> 0 : size() <=> other.size();
+        }
+
+        bool starts_with(const PrefixedString &other) const
+        {
+            if (other.size() > size())
+            {
+                return false;
+            }
+            const size_t prefix_size = std::min<size_t>(other.size(), PrefixBytes);
+            if (std::memcmp(bytes_ + PREFIX_OFFSET, other.bytes_ + PREFIX_OFFSET, prefix_size) != 0)
+            {
+                return false;
+            }
+            return std::memcmp(data() + prefix_size, other.data() + prefix_size, other.size() - prefix_size) == 0;
+        }
+    };
+
+    // 24 bytes, an 8 byte prefix and 20 inline bytes
+    using Prefix8String = PrefixedString<24, 8>;
+
+    // 32 bytes, the german 4 byte prefix and 28 inline bytes
+    using Sso32String = PrefixedString<32, 4>;
+
+    // Size of the bytes a layout keeps in the object, for the trade-off counters of the benchmarks
+    struct Traits
+    {
+        size_t prefix_size = 0;
+        size_t inline_capacity = 0;
+    };
+
+    template <typename StringType>
+    Traits traits()
+    {
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            return {0, std::string().capacity()};
+        }
+        else if constexpr (std::is_same_v<StringType, gs::german_string>)
+        {
+            return {4, gs::german_string::SMALL_STRING_SIZE};
+        }
+        else if constexpr (requires { StringType::PREFIX_SIZE; })
+        {
+            return {StringType::PREFIX_SIZE, StringType::INLINE_CAPACITY};
+        }
+        else
+        {
+            return {};
+        }
+    }
+}
+
+template <>
+struct std::hash<layouts::PointerLengthString>
+{
+    std::size_t operator()(const layouts::PointerLengthString &s) const noexcept
+    {
+        return std::hash<std::string_view>()(s.as_string_view());
+    }
+};
+
+template <size_t TotalBytes, size_t PrefixBytes>
+struct std::hash<layouts::PrefixedString<TotalBytes, PrefixBytes>>
+{
+    std::size_t operator()(const layouts::PrefixedString<TotalBytes, PrefixBytes> &s) const noexcept
+    {
+        return std::hash<std::string_view>()(s.as_string_view());
+    }
+};
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "german_string.h"
+#include "random_strings.h"
+
+// Multi-threaded benchmarks, built as german_strings_talk_threaded_benchmarks. Every family runs
+// with 1, 2, 4, ... threads up to the core count and reports wall clock time, so allocator
+// contention and cache line sharing show up as lost scaling.
+
+constexpr size_t SHARED_STRING_COUNT = 100000;
+constexpr size_t LOOKUPS_PER_ITERATION = 1000;
+constexpr size_t QUEUE_BATCH = 256;
+
+int max_benchmark_threads()
+{
+    return static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+}
+
+// Plain bytes shared by all threads, converted to the string type under test by each benchmark
+const std::vector<std::string> &shared_source()
+{
+    static const auto source = generate_random_strings<std::string>(SHARED_STRING_COUNT, 8, 128, 42);
+    return source;
+}
+
+template <typename StringType>
+StringType make_string(const std::string &source)
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return source;
+    }
+    else
+    {
+        return StringType(source.data(), static_cast<uint32_t>(source.size()), gs::temporary_t{});
+    }
+}
+
+template <typename StringType>
+std::vector<StringType> make_strings(std::vector<std::string>::const_iterator first, std::vector<std::string>::const_iterator last)
+{
+    std::vector<StringType> strings;
+    strings.reserve(static_cast<size_t>(last - first));
+    for (; first != last; ++first)
+    {
+        strings.push_back(make_string<StringType>(*first));
+    }
+    return strings;
+}
+
+// 1. Read-only lookups in one hash map shared by all threads
+template <typename StringType>
+struct SharedLookupTable
+{
+    std::vector<StringType> keys;
+    std::unordered_map<StringType, uint32_t> map;
+
+    static const SharedLookupTable &get()
+    {
+        static const SharedLookupTable table = []
+        {
+            SharedLookupTable built;
+            built.keys = make_strings<StringType>(shared_source().begin(), shared_source().end());
+            built.map.reserve(built.keys.size());
+            for (size_t i = 0; i < built.keys.size(); ++i)
+            {
+                built.map.emplace(built.keys[i], static_cast<uint32_t>(i));
+            }
+            return built;
+        }();
+        return table;
+    }
+};
+
+template <typename StringType>
+void ConcurrentHashMapLookup(benchmark::State &state)
+{
+    const auto &table = SharedLookupTable<StringType>::get();
+
+    // Every thread probes its own random keys, drawn before the timed loop
+    std::mt19937 generator(static_cast<uint32_t>(1000 + state.thread_index()));
+    std::uniform_int_distribution<size_t> key_distribution(0, table.keys.size() - 1);
+    std::vector<size_t> probes(LOOKUPS_PER_ITERATION);
+    for (auto &probe : probes)
+    {
+        probe = key_distribution(generator);
+    }
+
+    for (auto _ : state)
+    {
+        uint64_t total = 0;
+        for (const size_t probe : probes)
+        {
+            auto it = table.map.find(table.keys[probe]);
+            if (it != table.map.end())
+            {
+                total += it->second;
+            }
+        }
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(probes.size()));
+}
+
+BENCHMARK_TEMPLATE(ConcurrentHashMapLookup, std::string)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(ConcurrentHashMapLookup, gs::german_string)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+
+// 2. Every thread sorts its own partition, reshuffled untimed before each sort
+template <typename StringType>
+void ConcurrentPartitionSort(benchmark::State &state)
+{
+    const size_t partition_size = static_cast<size_t>(state.range(0));
+    const auto &source = shared_source();
+    const size_t first = (static_cast<size_t>(state.thread_index()) * partition_size) % (source.size() - partition_size);
+    auto strings = make_strings<StringType>(source.begin() + static_cast<std::ptrdiff_t>(first),
+                                            source.begin() + static_cast<std::ptrdiff_t>(first + partition_size));
+    std::mt19937 shuffle_generator(static_cast<uint32_t>(42 + state.thread_index()));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::shuffle(strings.begin(), strings.end(), shuffle_generator);
+        state.ResumeTiming();
+
+        std::sort(strings.begin(), strings.end());
+        benchmark::DoNotOptimize(strings.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(partition_size));
+}
+
+BENCHMARK_TEMPLATE(ConcurrentPartitionSort, std::string)->Arg(10000)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(ConcurrentPartitionSort, gs::german_string)->Arg(10000)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+
+// 3. Producer/consumer: every thread pushes copies of its strings into one shared queue and pops
+// as many back, usually ones another thread copied, so buffers are freed away from where they were
+// allocated. A thread only pops what it pushed before, the queue never runs dry for good.
+template <typename StringType>
+class SharedQueue
+{
+private:
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::deque<StringType> items_;
+
+public:
+    static SharedQueue &get()
+    {
+        static SharedQueue queue;
+        return queue;
+    }
+
+    void push(const std::vector<StringType> &batch)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            for (const auto &str : batch)
+            {
+                items_.push_back(str);
+            }
+        }
+        not_empty_.notify_all();
+    }
+
+    StringType pop()
+    {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty(); });
+        StringType str = std::move(items_.front());
+        items_.pop_front();
+        return str;
+    }
+};
+
+template <typename StringType>
+void ConcurrentQueuePassing(benchmark::State &state)
+{
+    auto &queue = SharedQueue<StringType>::get();
+    const auto &source = shared_source();
+    const size_t first = (static_cast<size_t>(state.thread_index()) * QUEUE_BATCH) % (source.size() - QUEUE_BATCH);
+    const auto batch = make_strings<StringType>(source.begin() + static_cast<std::ptrdiff_t>(first),
+                                                source.begin() + static_cast<std::ptrdiff_t>(first + QUEUE_BATCH));
+
+    for (auto _ : state)
+    {
+        queue.push(batch);
+        size_t bytes = 0;
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            bytes += queue.pop().size();
+        }
+        benchmark::DoNotOptimize(bytes);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(batch.size()));
+}
+
+BENCHMARK_TEMPLATE(ConcurrentQueuePassing, std::string)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(ConcurrentQueuePassing, gs::german_string)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+
+// 4. Construction from shared bytes, every thread allocating and freeing at once
+template <typename StringType>
+void ConcurrentConstruction(benchmark::State &state)
+{
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto &source = shared_source();
+    const size_t first = (static_cast<size_t>(state.thread_index()) * count) % (source.size() - count);
+
+    for (auto _ : state)
+    {
+        auto strings = make_strings<StringType>(source.begin() + static_cast<std::ptrdiff_t>(first),
+                                                source.begin() + static_cast<std::ptrdiff_t>(first + count));
+        benchmark::DoNotOptimize(strings.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+
+BENCHMARK_TEMPLATE(ConcurrentConstruction, std::string)->Arg(10000)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+BENCHMARK_TEMPLATE(ConcurrentConstruction, gs::german_string)->Arg(10000)->ThreadRange(1, max_benchmark_threads())->UseRealTime();
+
+BENCHMARK_MAIN();
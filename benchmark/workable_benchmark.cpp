@@ -4,148 +4,44 @@
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 
 #include <benchmark/benchmark.h>
 
 #include "german_string.h"
+#include "corpus.h"
+#include "perf_counters.h"
+#include "random_strings.h"
 
-constexpr auto SMALL_KNOWN_STRING = "Hello World";
-constexpr auto MEDIUM_KNOWN_STRING = "The quick brown fox jumps over the lazy dog and then continues running through the forest.";
-constexpr auto LARGE_KNOWN_STRING = "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum.";
-
-// Common string patterns for realistic benchmarks
-const std::vector<std::string> COMMON_PREFIXES = {
-    "https://", "http://", "file://", "data:",
-    "user_", "admin_", "guest_", "system_",
-    "GET ", "POST ", "PUT ", "DELETE ",
-    "ERROR:", "WARNING:", "INFO:", "DEBUG:",
-    "/home/", "/usr/", "/var/", "/tmp/"};
-
-const std::vector<std::string> COMMON_SUFFIXES = {
-    ".txt", ".cpp", ".h", ".json", ".xml",
-    "_backup", "_temp", "_old", "_new",
-    "?query=1", "&param=value", "#section",
-    ".log", ".dat", ".bin"};
-
+// Strings for one benchmark run. The mixed generator takes (count, min_length, max_length, seed)
+// arguments, the corpora only a count and label the run with the shape of their data.
 template <typename StringType>
-std::vector<StringType> generate_random_strings(size_t count, uint32_t min_length, uint32_t max_length, uint32_t seed)
+std::vector<StringType> benchmark_strings(benchmark::State &state, corpus::Kind kind)
 {
-    std::vector<StringType> strings;
-    strings.reserve(count);
-    std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()_+[]{}|;:,.<>?/-_";
-    std::mt19937 generator(seed);
-    std::uniform_int_distribution<> length_distribution(min_length, max_length);
-    std::uniform_int_distribution<> char_distribution(0, static_cast<int>(alphabet.size() - 1));
-
-    constexpr float small_known_string_probability = 0.08f;
-    constexpr float medium_known_string_probability = 0.05f;
-    constexpr float large_known_string_probability = 0.03f;
-    constexpr float common_pattern_probability = 0.15f;
-    std::uniform_real_distribution<> known_string_distribution(0.0f, 1.0f);
-    std::uniform_int_distribution<> prefix_distribution(0, static_cast<int>(COMMON_PREFIXES.size() - 1));
-    std::uniform_int_distribution<> suffix_distribution(0, static_cast<int>(COMMON_SUFFIXES.size() - 1));
-
-    for (size_t i = 0; i < count; ++i)
+    if (kind == corpus::Kind::mixed)
     {
-        float rand_val = known_string_distribution(generator);
-
-        if (rand_val < small_known_string_probability)
-        {
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                strings.emplace_back(SMALL_KNOWN_STRING);
-            }
-            else
-            {
-                strings.emplace_back(SMALL_KNOWN_STRING, static_cast<uint32_t>(std::strlen(SMALL_KNOWN_STRING)), gs::persistent_t{});
-            }
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability)
-        {
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                strings.emplace_back(MEDIUM_KNOWN_STRING);
-            }
-            else
-            {
-                strings.emplace_back(MEDIUM_KNOWN_STRING, static_cast<uint32_t>(std::strlen(MEDIUM_KNOWN_STRING)), gs::persistent_t{});
-            }
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability + large_known_string_probability)
-        {
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                strings.emplace_back(LARGE_KNOWN_STRING);
-            }
-            else
-            {
-                strings.emplace_back(LARGE_KNOWN_STRING, static_cast<uint32_t>(std::strlen(LARGE_KNOWN_STRING)), gs::persistent_t{});
-            }
-            continue;
-        }
-        else if (rand_val < small_known_string_probability + medium_known_string_probability + large_known_string_probability + common_pattern_probability)
-        {
-            // Generate strings with common patterns
-            std::string pattern_string = COMMON_PREFIXES[prefix_distribution(generator)];
-            size_t remaining_length = std::max(0, static_cast<int>(length_distribution(generator)) - static_cast<int>(pattern_string.length()));
-            for (size_t j = 0; j < remaining_length; ++j)
-            {
-                pattern_string += alphabet[char_distribution(generator)];
-            }
-            if (rand_val > 0.5f) // 50% chance to add suffix
-            {
-                pattern_string += COMMON_SUFFIXES[suffix_distribution(generator)];
-            }
-
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                strings.emplace_back(pattern_string);
-            }
-            else
-            {
-                strings.emplace_back(pattern_string.c_str(), static_cast<uint32_t>(pattern_string.length()), gs::temporary_t{});
-            }
-            continue;
-        }
-
-        // Generate completely random string
-        std::string new_built_string;
-        size_t length = length_distribution(generator);
-        for (size_t j = 0; j < length; ++j)
-        {
-            new_built_string += alphabet[char_distribution(generator)];
-        }
-
-        if constexpr (std::is_same_v<StringType, std::string>)
-        {
-            strings.emplace_back(new_built_string);
-        }
-        else
-        {
-            strings.emplace_back(new_built_string.c_str(), static_cast<uint32_t>(new_built_string.length()), gs::temporary_t{});
-        }
+        return generate_random_strings<StringType>(static_cast<size_t>(state.range(0)), static_cast<uint32_t>(state.range(1)),
+                                                   static_cast<uint32_t>(state.range(2)), static_cast<uint32_t>(state.range(3)));
     }
-    return strings;
+    const auto source = corpus::generate(kind, static_cast<size_t>(state.range(0)));
+    state.SetLabel(corpus::label(kind, source));
+    return corpus::to_strings<StringType>(source);
 }
 
 template <typename StringType>
-void StringStartsWithComparison(benchmark::State &state)
+void StringStartsWithComparison(benchmark::State &state, corpus::Kind kind)
 {
-    size_t count = state.range(0);
-    uint32_t min_length = static_cast<uint32_t>(state.range(1));
-    uint32_t max_length = static_cast<uint32_t>(state.range(2));
-    uint32_t seed = static_cast<uint32_t>(state.range(3));
-
-    auto strings = generate_random_strings<StringType>(count, min_length, max_length, seed);
+    auto strings = benchmark_strings<StringType>(state, kind);
+    const size_t count = strings.size();
+    const StringType prefix{"https://"};
 
+    perf::Scope perf(state, static_cast<double>(count));
     for (auto _ : state)
     {
         size_t starts_with_count = 0;
         for (const auto &str : strings)
         {
-            if (str.starts_with(StringType{"https://"}))
+            if (str.starts_with(prefix))
             {
                 ++starts_with_count;
             }
@@ -154,33 +50,15 @@ void StringStartsWithComparison(benchmark::State &state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
 }
 
-//BENCHMARK_TEMPLATE(StringStartsWithComparison, std::string)
-//    ->Args({1000, 8, 1024, 42})
-//    ->Args({10000, 8, 1024, 42})
-//    ->Args({100000, 8, 1024, 42})
-//    ->Args({500000, 8, 1024, 42})
-//    ->Args({1000000, 8, 1024, 42});
-//
-//BENCHMARK_TEMPLATE(StringStartsWithComparison, gs::german_string)
-//    ->Args({1000, 8, 1024, 42})
-//    ->Args({10000, 8, 1024, 42})
-//    ->Args({100000, 8, 1024, 42})
-//    ->Args({500000, 8, 1024, 42})
-//    ->Args({1000000, 8, 1024, 42});
-
 template <typename StringType>
-void StringEqualityComparison(benchmark::State &state)
+void StringEqualityComparison(benchmark::State &state, corpus::Kind kind)
 {
-    size_t count = state.range(0);
-    uint32_t min_length = static_cast<uint32_t>(state.range(1));
-    uint32_t max_length = static_cast<uint32_t>(state.range(2));
-    uint32_t seed = static_cast<uint32_t>(state.range(3));
-
-    auto strings = generate_random_strings<StringType>(count, min_length, max_length, seed);
+    auto strings = benchmark_strings<StringType>(state, kind);
 
+    perf::Scope perf(state, static_cast<double>(strings.size() / 2));
     for (auto _ : state)
     {
         size_t equal_count = 0;
@@ -195,33 +73,15 @@ void StringEqualityComparison(benchmark::State &state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
 }
 
-BENCHMARK_TEMPLATE(StringEqualityComparison, std::string)
-    ->Args({1000, 8, 1024, 42})
-    ->Args({10000, 8, 1024, 42})
-    ->Args({100000, 8, 1024, 42})
-    ->Args({500000, 8, 1024, 42})
-    ->Args({1000000, 8, 1024, 42});
-
-BENCHMARK_TEMPLATE(StringEqualityComparison, gs::german_string)
-    ->Args({1000, 8, 1024, 42})
-    ->Args({10000, 8, 1024, 42})
-    ->Args({100000, 8, 1024, 42})
-    ->Args({500000, 8, 1024, 42})
-    ->Args({1000000, 8, 1024, 42});
-
 template <typename StringType>
-void StringLexicographicComparison(benchmark::State &state)
+void StringLexicographicComparison(benchmark::State &state, corpus::Kind kind)
 {
-    size_t count = state.range(0);
-    uint32_t min_length = static_cast<uint32_t>(state.range(1));
-    uint32_t max_length = static_cast<uint32_t>(state.range(2));
-    uint32_t seed = static_cast<uint32_t>(state.range(3));
-
-    auto strings = generate_random_strings<StringType>(count, min_length, max_length, seed);
+    auto strings = benchmark_strings<StringType>(state, kind);
 
+    perf::Scope perf(state, static_cast<double>(strings.size() / 2));
     for (auto _ : state)
     {
         size_t less_count = 0;
@@ -236,61 +96,37 @@ void StringLexicographicComparison(benchmark::State &state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
 }
 
-//BENCHMARK_TEMPLATE(StringLexicographicComparison, std::string)
-//    ->Args({1000, 8, 128, 42})
-//    ->Args({10000, 8, 128, 42})
-//    ->Args({100000, 8, 128, 42})
-//    ->Args({500000, 8, 128, 42})
-//    ->Args({1000000, 8, 128, 42});
-//
-//BENCHMARK_TEMPLATE(StringLexicographicComparison, gs::german_string)
-//    ->Args({1000, 8, 128, 42})
-//    ->Args({10000, 8, 128, 42})
-//    ->Args({100000, 8, 128, 42})
-//    ->Args({500000, 8, 128, 42})
-//    ->Args({1000000, 8, 128, 42});
-
 template <typename StringType>
-void StringSorting(benchmark::State &state)
+void StringSorting(benchmark::State &state, corpus::Kind kind)
 {
-    size_t count = state.range(0);
-    uint32_t min_length = static_cast<uint32_t>(state.range(1));
-    uint32_t max_length = static_cast<uint32_t>(state.range(2));
-    uint32_t seed = static_cast<uint32_t>(state.range(3));
-
-    // Generate the strings once, outside the benchmark loop (like the original)
-    auto strings = generate_random_strings<StringType>(count, min_length, max_length, seed);
+    // Generate the strings once, outside the benchmark loop
+    auto strings = benchmark_strings<StringType>(state, kind);
+    const size_t count = strings.size();
+    std::mt19937 shuffle_generator(42);
 
+    // Per comparison, about n log2 n of them for a sort
+    perf::Scope perf(state, static_cast<double>(count) * std::log2(static_cast<double>(std::max<size_t>(count, 2))));
     for (auto _ : state)
     {
-        // Sort forward and backward like the original benchmark for more stable measurements
+        // Sorting already sorted data is a different benchmark, reshuffle untimed. Shuffling only
+        // swaps, so german strings keep their buffers
+        state.PauseTiming();
+        perf.pause();
+        std::shuffle(strings.begin(), strings.end(), shuffle_generator);
+        perf.resume();
+        state.ResumeTiming();
+
         std::sort(strings.begin(), strings.end());
         benchmark::DoNotOptimize(strings);
-        std::sort(strings.rbegin(), strings.rend());
-        benchmark::DoNotOptimize(strings);
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * count);
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
 }
 
-BENCHMARK_TEMPLATE(StringSorting, std::string)
-    ->Args({1000, 8, 128, 42})
-    ->Args({10000, 8, 128, 42})
-    ->Args({50000, 8, 128, 42})
-    ->Args({100000, 8, 128, 42})
-    ->Args({200000, 8, 128, 42});
-
-BENCHMARK_TEMPLATE(StringSorting, gs::german_string)
-    ->Args({1000, 8, 128, 42})
-    ->Args({10000, 8, 128, 42})
-    ->Args({50000, 8, 128, 42})
-    ->Args({100000, 8, 128, 42})
-    ->Args({200000, 8, 128, 42});
-
 template <typename StringType>
 void StringComparisonByLength(benchmark::State &state)
 {
@@ -299,6 +135,7 @@ void StringComparisonByLength(benchmark::State &state)
 
     auto strings = generate_random_strings<StringType>(2000, length, length, seed);
 
+    perf::Scope perf(state, static_cast<double>(strings.size() / 2));
     for (auto _ : state)
     {
         size_t equal_count = 0;
@@ -313,35 +150,35 @@ void StringComparisonByLength(benchmark::State &state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
     state.SetLabel("length=" + std::to_string(length));
 }
 
-//BENCHMARK_TEMPLATE(StringComparisonByLength, std::string)
-//    ->Arg(4)
-//    ->Arg(8)
-//    ->Arg(12)
-//    ->Arg(16)
-//    ->Arg(32)
-//    ->Arg(64)
-//    ->Arg(128)
-//    ->Arg(256)
-//    ->Arg(512)
-//    ->Arg(1024)
-//    ->Arg(2048);
-//
-//BENCHMARK_TEMPLATE(StringComparisonByLength, gs::german_string)
-//    ->Arg(4)
-//    ->Arg(8)
-//    ->Arg(12)
-//    ->Arg(16)
-//    ->Arg(32)
-//    ->Arg(64)
-//    ->Arg(128)
-//    ->Arg(256)
-//    ->Arg(512)
-//    ->Arg(1024)
-//    ->Arg(2048);
+BENCHMARK_TEMPLATE(StringComparisonByLength, std::string)
+    ->Args({4, 42})
+    ->Args({8, 42})
+    ->Args({12, 42})
+    ->Args({16, 42})
+    ->Args({32, 42})
+    ->Args({64, 42})
+    ->Args({128, 42})
+    ->Args({256, 42})
+    ->Args({512, 42})
+    ->Args({1024, 42})
+    ->Args({2048, 42});
+
+BENCHMARK_TEMPLATE(StringComparisonByLength, gs::german_string)
+    ->Args({4, 42})
+    ->Args({8, 42})
+    ->Args({12, 42})
+    ->Args({16, 42})
+    ->Args({32, 42})
+    ->Args({64, 42})
+    ->Args({128, 42})
+    ->Args({256, 42})
+    ->Args({512, 42})
+    ->Args({1024, 42})
+    ->Args({2048, 42});
 
 template <typename StringType>
 void StringHashingByLength(benchmark::State& state)
@@ -351,6 +188,7 @@ void StringHashingByLength(benchmark::State& state)
 
     auto strings = generate_random_strings<StringType>(2000, length, length, seed);
 
+    perf::Scope perf(state, static_cast<double>(strings.size() / 2));
     for (auto _ : state)
     {
         uint64_t ResultingHash = 0;
@@ -362,38 +200,34 @@ void StringHashingByLength(benchmark::State& state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
     state.SetLabel("length=" + std::to_string(length));
 }
 
-//BENCHMARK_TEMPLATE(StringHashingByLength, std::string)
-//->Arg(12)
-//->Arg(16)
-//->Arg(64)
-//->Arg(256)
-//->Arg(512)
-//->Arg(1024)
-//->Arg(2048);
-//
-//BENCHMARK_TEMPLATE(StringHashingByLength, gs::german_string)
-//->Arg(12)
-//->Arg(16)
-//->Arg(64)
-//->Arg(256)
-//->Arg(512)
-//->Arg(1024)
-//->Arg(2048);
+BENCHMARK_TEMPLATE(StringHashingByLength, std::string)
+    ->Args({12, 42})
+    ->Args({16, 42})
+    ->Args({64, 42})
+    ->Args({256, 42})
+    ->Args({512, 42})
+    ->Args({1024, 42})
+    ->Args({2048, 42});
+
+BENCHMARK_TEMPLATE(StringHashingByLength, gs::german_string)
+    ->Args({12, 42})
+    ->Args({16, 42})
+    ->Args({64, 42})
+    ->Args({256, 42})
+    ->Args({512, 42})
+    ->Args({1024, 42})
+    ->Args({2048, 42});
 
 template <typename StringType>
-void StringHashing(benchmark::State& state)
+void StringHashing(benchmark::State &state, corpus::Kind kind)
 {
-    size_t count = state.range(0);
-    uint32_t min_length = static_cast<uint32_t>(state.range(1));
-    uint32_t max_length = static_cast<uint32_t>(state.range(2));
-    uint32_t seed = static_cast<uint32_t>(state.range(3));
-
-    auto strings = generate_random_strings<StringType>(count, min_length, max_length, seed);
+    auto strings = benchmark_strings<StringType>(state, kind);
 
+    perf::Scope perf(state, static_cast<double>(strings.size() / 2));
     for (auto _ : state)
     {
         uint64_t ResultingHash = 0;
@@ -405,21 +239,61 @@ void StringHashing(benchmark::State& state)
         benchmark::ClobberMemory();
     }
 
-    state.SetItemsProcessed(state.iterations() * (strings.size() / 2));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(strings.size() / 2));
+}
+
+using StringBenchmark = void (*)(benchmark::State &, corpus::Kind);
+
+constexpr int64_t CORPUS_STRING_COUNT = 100000;
+
+// Registers a family for both string types: once per row of mixed generator arguments, under the
+// usual names like StringSorting<std::string>/1000/8/128/42, then once per corpus as
+// StringSorting<std::string>/urls/100000
+void register_string_family(const std::string &family, StringBenchmark std_benchmark, StringBenchmark gs_benchmark,
+                            const std::vector<std::vector<int64_t>> &mixed_args)
+{
+    const std::pair<std::string, StringBenchmark> types[] = {{family + "<std::string>", std_benchmark},
+                                                             {family + "<gs::german_string>", gs_benchmark}};
+    if (!mixed_args.empty())
+    {
+        for (const auto &[name, run] : types)
+        {
+            auto *registered = benchmark::RegisterBenchmark(name.c_str(), run, corpus::Kind::mixed);
+            for (const auto &args : mixed_args)
+            {
+                registered->Args(args);
+            }
+        }
+    }
+    for (const auto kind : corpus::kinds())
+    {
+        for (const auto &[name, run] : types)
+        {
+            benchmark::RegisterBenchmark((name + "/" + corpus::name(kind)).c_str(), run, kind)->Arg(CORPUS_STRING_COUNT);
+        }
+    }
 }
 
-BENCHMARK_TEMPLATE(StringHashing, std::string)
-->Args({ 1000, 8, 1024, 42 })
-->Args({ 10000, 8, 1024, 42 })
-->Args({ 100000, 8, 1024, 42 })
-->Args({ 500000, 8, 1024, 42 })
-->Args({ 1000000, 8, 1024, 42 });
-
-BENCHMARK_TEMPLATE(StringHashing, gs::german_string)
-->Args({ 1000, 8, 1024, 42 })
-->Args({ 10000, 8, 1024, 42 })
-->Args({ 100000, 8, 1024, 42 })
-->Args({ 500000, 8, 1024, 42 })
-->Args({ 1000000, 8, 1024, 42 });
+const std::vector<std::vector<int64_t>> LONG_STRING_ARGS = {
+    {1000, 8, 1024, 42}, {10000, 8, 1024, 42}, {100000, 8, 1024, 42}, {500000, 8, 1024, 42}, {1000000, 8, 1024, 42}};
+
+const std::vector<std::vector<int64_t>> SHORT_STRING_ARGS = {
+    {1000, 8, 128, 42}, {10000, 8, 128, 42}, {100000, 8, 128, 42}, {500000, 8, 128, 42}, {1000000, 8, 128, 42}};
+
+const std::vector<std::vector<int64_t>> SORTING_ARGS = {
+    {1000, 8, 128, 42}, {10000, 8, 128, 42}, {50000, 8, 128, 42}, {100000, 8, 128, 42}, {200000, 8, 128, 42}};
+
+[[maybe_unused]] const bool string_families_registered = []
+{
+    register_string_family("StringStartsWithComparison", StringStartsWithComparison<std::string>,
+                           StringStartsWithComparison<gs::german_string>, LONG_STRING_ARGS);
+    register_string_family("StringEqualityComparison", StringEqualityComparison<std::string>,
+                           StringEqualityComparison<gs::german_string>, LONG_STRING_ARGS);
+    register_string_family("StringLexicographicComparison", StringLexicographicComparison<std::string>,
+                           StringLexicographicComparison<gs::german_string>, SHORT_STRING_ARGS);
+    register_string_family("StringSorting", StringSorting<std::string>, StringSorting<gs::german_string>, SORTING_ARGS);
+    register_string_family("StringHashing", StringHashing<std::string>, StringHashing<gs::german_string>, LONG_STRING_ARGS);
+    return true;
+}();
 
 BENCHMARK_MAIN();
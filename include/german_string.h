@@ -14,8 +14,9 @@
 #include <bit>
 #include <iterator>
 #include <ostream>
+#include <type_traits>
 
-// TODO: I'm passing a lot by const reference, but I should be passing by value maybe???
+// Functions that only read a string can take a german_string_view by value, it travels in two registers
 // TODO: A constructor withj size type being size_t and check if the size fits in 32 bits and panic if it doesn't
 
 // define per-compiler macros for force inline
@@ -200,6 +201,163 @@ namespace gs
         }
     }
 
+    template <typename TAllocator>
+    class basic_german_string;
+
+    // Non-owning view with the german string layout. It is trivially copyable, so it is passed and
+    // returned in registers and sorts by plain 16 byte copies. Small strings are copied into the view,
+    // large ones are borrowed and must outlive it, just like a transient german string.
+    class german_string_view
+    {
+    public:
+        using size_type = std::uint32_t;
+        static constexpr size_type SMALL_STRING_SIZE = 12;
+        static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+    private:
+        template <typename TAllocator>
+        friend class basic_german_string;
+
+        explicit german_string_view(const detail::_gs_impl_no_alloc &impl) noexcept
+            : _impl(impl)
+        {
+        }
+
+        detail::_gs_impl_no_alloc _impl;
+
+    public:
+        german_string_view() noexcept = default;
+
+        german_string_view(const char *str, size_type size) noexcept
+        {
+            _impl._state[0] = size;
+            if (_impl._is_small())
+            {
+                std::memcpy(_impl._get_small_ptr(), str, size);
+            }
+            else
+            {
+                std::memcpy(_impl._get_small_ptr(), str, 4);
+                _impl._state[1] = reinterpret_cast<std::uint64_t>(str) | detail::_gs_impl_no_alloc::_get_ptr_tag(string_class::transient);
+            }
+        }
+
+        explicit german_string_view(std::string_view str)
+            : german_string_view(str.data(), detail::_checked_size_cast(str.size()))
+        {
+        }
+
+        german_string_view(std::nullptr_t) = delete;
+
+        const char *data() const noexcept
+        {
+            return _impl._get_maybe_small_ptr();
+        }
+
+        size_type size() const noexcept
+        {
+            return _impl._get_size();
+        }
+
+        size_type length() const noexcept
+        {
+            return _impl._get_size();
+        }
+
+        bool empty() const noexcept
+        {
+            return _impl._get_size() == 0;
+        }
+
+        char operator[](size_type index) const noexcept
+        {
+            return data()[index];
+        }
+
+        std::string_view as_string_view() const noexcept
+        {
+            return std::string_view(data(), size());
+        }
+
+        std::string_view get_prefix_sv() const noexcept
+        {
+            return std::string_view(_impl._get_small_ptr(), 4);
+        }
+
+        int compare(german_string_view other) const noexcept
+        {
+            return _impl._compare(other._impl);
+        }
+
+        friend bool operator==(german_string_view a, german_string_view b) noexcept
+        {
+            return a._impl._equals(b._impl);
+        }
+
+        friend std::strong_ordering operator<=>(german_string_view a, german_string_view b) noexcept
+        {
+            return a._impl._compare(b._impl) <=> 0;
+        }
+
+        // The prefix settles most mismatches, the heap is only read past the first 4 bytes
+        bool starts_with(german_string_view other) const noexcept
+        {
+            if (other.size() > size())
+            {
+                return false;
+            }
+            const int prefix_size = static_cast<int>(std::min(other.size(), size_type{4}));
+            if (detail::prefix_memcmp(_impl._get_prefix(), other._impl._get_prefix(), prefix_size) != 0)
+            {
+                return false;
+            }
+            return other.size() <= 4 || std::memcmp(data() + 4, other.data() + 4, other.size() - 4) == 0;
+        }
+
+        bool ends_with(german_string_view other) const noexcept
+        {
+            return other.size() <= size() && std::memcmp(data() + size() - other.size(), other.data(), other.size()) == 0;
+        }
+
+        size_type find(char ch, size_type start = 0) const noexcept
+        {
+            const auto position = as_string_view().find(ch, start);
+            return position == std::string_view::npos ? npos : static_cast<size_type>(position);
+        }
+
+        size_type find(german_string_view needle, size_type start = 0) const noexcept
+        {
+            if (needle.size() > size() || start > size() - needle.size())
+            {
+                return npos;
+            }
+            const auto position = as_string_view().find(needle.as_string_view(), start);
+            return position == std::string_view::npos ? npos : static_cast<size_type>(position);
+        }
+
+        bool contains(char ch) const noexcept
+        {
+            return find(ch) != npos;
+        }
+
+        bool contains(german_string_view needle) const noexcept
+        {
+            return find(needle) != npos;
+        }
+
+        german_string_view substr(size_type start, size_type length) const
+        {
+            if (start > size() || length > size() - start)
+            {
+                throw std::out_of_range("Substring out of range");
+            }
+            return german_string_view(data() + start, length);
+        }
+    };
+
+    static_assert(std::is_trivially_copyable_v<german_string_view>, "german_string_view must be passed in registers");
+    static_assert(sizeof(german_string_view) == 16, "german_string_view must keep the german string layout");
+
     // TODO: Add stream operators and getline
 
     template <typename TAllocator = std::allocator<char>>
@@ -321,6 +479,14 @@ namespace gs
         {
         }
 
+        // Copies the bytes, a view does not own them
+        explicit basic_german_string(german_string_view view,
+                                     string_class cls = string_class::temporary,
+                                     const TAllocator &allocator = TAllocator())
+            : basic_german_string(view.data(), view.size(), cls, allocator)
+        {
+        }
+
         basic_german_string(basic_german_string &&other) noexcept
             : _impl(std::move(other._impl))
         {
@@ -380,6 +546,12 @@ namespace gs
             return std::string_view(_impl._get_maybe_small_ptr(), _impl._get_size());
         }
 
+        // Free, the view copies the 16 bytes; it borrows the heap buffer of a large string
+        operator german_string_view() const noexcept
+        {
+            return german_string_view(_impl);
+        }
+
         basic_german_string copy_to_temporary() const
         {
             if (_impl._is_small())
@@ -489,6 +661,13 @@ namespace gs
         os << str.as_string_view();
         return os;
     }
+
+    inline std::basic_ostream<char, std::char_traits<char>> &
+    operator<<(std::basic_ostream<char, std::char_traits<char>> &os, german_string_view str)
+    {
+        os << str.as_string_view();
+        return os;
+    }
 }
 
 // TODO: Probably stupid, review later
@@ -499,4 +678,14 @@ struct std::hash<gs::german_string>
     {
         return std::hash<std::string_view>()(s.as_string_view());
     }
+};
+
+// Same hash as gs::german_string, so views can look up owned strings
+template <>
+struct std::hash<gs::german_string_view>
+{
+    std::size_t operator()(gs::german_string_view s) const noexcept
+    {
+        return std::hash<std::string_view>()(s.as_string_view());
+    }
 };
\ No newline at end of file
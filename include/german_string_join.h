@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "german_string.h"
+
+// Equi-join kernels on string keys. They work on any string type with data(), size(), == and <=>,
+// so std::string runs the same algorithms for comparison, but german strings answer most key
+// comparisons from the size and prefix stored in the object.
+namespace gs
+{
+    // One pair of equal keys, as indices into the left (build) and right (probe) input
+    struct join_match
+    {
+        std::uint32_t left;
+        std::uint32_t right;
+
+        bool operator==(const join_match &) const = default;
+        auto operator<=>(const join_match &) const = default;
+    };
+
+    // Pass as radix_bits to let hash_join pick the partition count from the build size
+    inline constexpr unsigned HASH_JOIN_AUTO_RADIX_BITS = std::numeric_limits<unsigned>::max();
+
+    namespace detail
+    {
+        // Partitions are sized so their hash table and entries stay in a 256 KiB L2
+        inline constexpr size_t HASH_JOIN_PARTITION_BYTES = 256 * 1024;
+        inline constexpr unsigned HASH_JOIN_MAX_RADIX_BITS = 12;
+
+        template <typename StringType>
+        std::uint32_t checked_join_size(std::span<const StringType> keys)
+        {
+            if (keys.size() >= std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::length_error("Join input exceeds maximum size");
+            }
+            return static_cast<std::uint32_t>(keys.size());
+        }
+
+        template <typename StringType>
+        std::uint64_t join_hash(const StringType &key)
+        {
+            return std::hash<std::string_view>()(std::string_view(key.data(), key.size()));
+        }
+
+        // First 4 bytes as a big endian number, zero padded, so a smaller prefix means a smaller
+        // string. German strings keep these bytes in the object, other types read them from data().
+        template <typename StringType>
+        std::uint32_t order_prefix(const StringType &key)
+        {
+            unsigned char bytes[4] = {0, 0, 0, 0};
+            if constexpr (requires { key.get_prefix_sv(); })
+            {
+                std::memcpy(bytes, key.get_prefix_sv().data(), sizeof(bytes));
+            }
+            else
+            {
+                std::memcpy(bytes, key.data(), std::min<size_t>(key.size(), sizeof(bytes)));
+            }
+            return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+                   (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+        }
+
+        inline unsigned hash_join_radix_bits(size_t build_size, size_t key_size)
+        {
+            // Per build key: its entry, two table slots and the key itself
+            const size_t bytes = build_size * (sizeof(std::uint64_t) * 2 + sizeof(std::uint32_t) * 2 + key_size);
+            const size_t partitions = std::bit_ceil(std::max<size_t>(bytes / HASH_JOIN_PARTITION_BYTES, 1));
+            return std::min(static_cast<unsigned>(std::countr_zero(partitions)), HASH_JOIN_MAX_RADIX_BITS);
+        }
+
+        struct hash_entry
+        {
+            std::uint64_t hash;
+            std::uint32_t index;
+        };
+
+        // Entries of one input scattered by the top radix_bits of their hash, partition p is
+        // entries[offsets[p], offsets[p + 1])
+        struct radix_partitions
+        {
+            std::vector<hash_entry> entries;
+            std::vector<size_t> offsets;
+        };
+
+        template <typename StringType>
+        radix_partitions radix_partition(std::span<const StringType> keys, unsigned radix_bits)
+        {
+            const std::uint32_t count = checked_join_size(keys);
+            const size_t partition_count = size_t{1} << radix_bits;
+            const auto partition_of = [radix_bits](std::uint64_t hash)
+            {
+                return radix_bits == 0 ? std::uint64_t{0} : hash >> (64 - radix_bits);
+            };
+
+            std::vector<std::uint64_t> hashes(count);
+            radix_partitions result;
+            result.offsets.assign(partition_count + 1, 0);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                hashes[i] = join_hash(keys[i]);
+                ++result.offsets[static_cast<size_t>(partition_of(hashes[i])) + 1];
+            }
+            for (size_t p = 0; p < partition_count; ++p)
+            {
+                result.offsets[p + 1] += result.offsets[p];
+            }
+
+            std::vector<size_t> cursors(result.offsets.begin(), result.offsets.end() - 1);
+            result.entries.resize(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                result.entries[cursors[static_cast<size_t>(partition_of(hashes[i]))]++] = {hashes[i], i};
+            }
+            return result;
+        }
+
+        // First position at or after from whose prefix is not below prefix, galloping so long runs
+        // of smaller keys are skipped in O(log n) prefix reads and no key bytes are touched
+        inline size_t skip_to_prefix(const std::vector<std::uint64_t> &sorted, size_t from, std::uint32_t prefix)
+        {
+            const auto prefix_of = [&](size_t i) { return static_cast<std::uint32_t>(sorted[i] >> 32); };
+            size_t step = 1;
+            size_t low = from;
+            size_t high = from + step;
+            while (high < sorted.size() && prefix_of(high) < prefix)
+            {
+                low = high;
+                step *= 2;
+                high = from + step;
+            }
+            high = std::min(high, sorted.size());
+            while (low < high)
+            {
+                const size_t middle = low + (high - low) / 2;
+                if (prefix_of(middle) < prefix)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+            return low;
+        }
+
+        // Key order of one input as prefix << 32 | index, sorted by prefix, then key, then index
+        template <typename StringType>
+        std::vector<std::uint64_t> sort_by_key(std::span<const StringType> keys)
+        {
+            const std::uint32_t count = checked_join_size(keys);
+            std::vector<std::uint64_t> sorted(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                sorted[i] = (static_cast<std::uint64_t>(order_prefix(keys[i])) << 32) | i;
+            }
+            std::sort(sorted.begin(), sorted.end(), [&](std::uint64_t a, std::uint64_t b)
+                      {
+                          if ((a >> 32) != (b >> 32))
+                          {
+                              return (a >> 32) < (b >> 32);
+                          }
+                          // Equal keys keep their input order, so the output is deterministic
+                          const auto order = keys[static_cast<std::uint32_t>(a)] <=> keys[static_cast<std::uint32_t>(b)];
+                          return order != 0 ? order < 0 : a < b;
+                      });
+            return sorted;
+        }
+    }
+
+    // Radix partitioned hash join: both inputs are scattered by hash into partitions small enough
+    // for their hash table to stay in cache, then every partition builds a linear probing table
+    // over its left keys and probes it with its right keys. Matches come out grouped by partition.
+    template <typename StringType>
+    std::vector<join_match> hash_join(std::span<const StringType> left, std::span<const StringType> right,
+                                      unsigned radix_bits = HASH_JOIN_AUTO_RADIX_BITS)
+    {
+        if (radix_bits == HASH_JOIN_AUTO_RADIX_BITS)
+        {
+            radix_bits = detail::hash_join_radix_bits(left.size(), sizeof(StringType));
+        }
+        radix_bits = std::min(radix_bits, detail::HASH_JOIN_MAX_RADIX_BITS);
+
+        const auto build = detail::radix_partition(left, radix_bits);
+        const auto probe = detail::radix_partition(right, radix_bits);
+
+        constexpr std::uint32_t EMPTY_SLOT = std::numeric_limits<std::uint32_t>::max();
+        std::vector<join_match> matches;
+        std::vector<std::uint32_t> table;
+        for (size_t p = 0; p + 1 < build.offsets.size(); ++p)
+        {
+            const size_t build_begin = build.offsets[p];
+            const size_t build_end = build.offsets[p + 1];
+            const size_t probe_begin = probe.offsets[p];
+            const size_t probe_end = probe.offsets[p + 1];
+            if (build_begin == build_end || probe_begin == probe_end)
+            {
+                continue;
+            }
+
+            // Load factor of at most one half, slots hold entry positions in the partition
+            const size_t mask = std::bit_ceil(2 * (build_end - build_begin)) - 1;
+            table.assign(mask + 1, EMPTY_SLOT);
+            for (size_t e = build_begin; e < build_end; ++e)
+            {
+                size_t slot = build.entries[e].hash & mask;
+                while (table[slot] != EMPTY_SLOT)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                table[slot] = static_cast<std::uint32_t>(e - build_begin);
+            }
+
+            for (size_t e = probe_begin; e < probe_end; ++e)
+            {
+                const auto &probe_entry = probe.entries[e];
+                const auto &probe_key = right[probe_entry.index];
+                for (size_t slot = probe_entry.hash & mask; table[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+                {
+                    const auto &build_entry = build.entries[build_begin + table[slot]];
+                    if (build_entry.hash == probe_entry.hash && left[build_entry.index] == probe_key)
+                    {
+                        matches.push_back({build_entry.index, probe_entry.index});
+                    }
+                }
+            }
+        }
+        return matches;
+    }
+
+    // Sort-merge join. Both inputs are ordered by their 4 byte prefix and then the full key; the
+    // merge compares prefixes first and gallops past runs of smaller prefixes without reading key
+    // bytes, so only keys whose prefixes tie are compared in full. Matches come out in key order.
+    template <typename StringType>
+    std::vector<join_match> sort_merge_join(std::span<const StringType> left, std::span<const StringType> right)
+    {
+        const auto left_sorted = detail::sort_by_key(left);
+        const auto right_sorted = detail::sort_by_key(right);
+        const auto prefix_of = [](std::uint64_t entry) { return static_cast<std::uint32_t>(entry >> 32); };
+        const auto index_of = [](std::uint64_t entry) { return static_cast<std::uint32_t>(entry); };
+
+        std::vector<join_match> matches;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < left_sorted.size() && j < right_sorted.size())
+        {
+            const std::uint32_t left_prefix = prefix_of(left_sorted[i]);
+            const std::uint32_t right_prefix = prefix_of(right_sorted[j]);
+            if (left_prefix < right_prefix)
+            {
+                i = detail::skip_to_prefix(left_sorted, i, right_prefix);
+                continue;
+            }
+            if (right_prefix < left_prefix)
+            {
+                j = detail::skip_to_prefix(right_sorted, j, left_prefix);
+                continue;
+            }
+
+            const auto &key = left[index_of(left_sorted[i])];
+            const auto order = key <=> right[index_of(right_sorted[j])];
+            if (order < 0)
+            {
+                ++i;
+                continue;
+            }
+            if (order > 0)
+            {
+                ++j;
+                continue;
+            }
+
+            // Equal keys are adjacent on both sides, emit their cross product
+            size_t left_end = i + 1;
+            while (left_end < left_sorted.size() && prefix_of(left_sorted[left_end]) == left_prefix &&
+                   left[index_of(left_sorted[left_end])] == key)
+            {
+                ++left_end;
+            }
+            size_t right_end = j + 1;
+            while (right_end < right_sorted.size() && prefix_of(right_sorted[right_end]) == right_prefix &&
+                   right[index_of(right_sorted[right_end])] == key)
+            {
+                ++right_end;
+            }
+            for (size_t l = i; l < left_end; ++l)
+            {
+                for (size_t r = j; r < right_end; ++r)
+                {
+                    matches.push_back({index_of(left_sorted[l]), index_of(right_sorted[r])});
+                }
+            }
+            i = left_end;
+            j = right_end;
+        }
+        return matches;
+    }
+}
@@ -0,0 +1,708 @@
+#pragma once
+
+// Server mode includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unordered_map>
+
+#include "lsm_tree.h"
+
+// RESP (Redis serialization protocol) support for the serve and loadgen commands
+enum class RespStatus
+{
+    complete,
+    incomplete,
+    error,
+};
+
+// Reads a CRLF terminated line starting at offset, the returned view excludes the CRLF
+inline RespStatus resp_read_line(std::string_view buffer, size_t &offset, std::string_view &line)
+{
+    const size_t end = buffer.find("\r\n", offset);
+    if (end == std::string_view::npos)
+    {
+        return RespStatus::incomplete;
+    }
+    line = buffer.substr(offset, end - offset);
+    offset = end + 2;
+    return RespStatus::complete;
+}
+
+inline bool resp_parse_integer(std::string_view text, int64_t &value)
+{
+    const bool negative = !text.empty() && text.front() == '-';
+    if (negative)
+    {
+        text.remove_prefix(1);
+    }
+    if (text.empty() || text.size() > 18)
+    {
+        return false;
+    }
+    value = 0;
+    for (char c : text)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+    }
+    value = negative ? -value : value;
+    return true;
+}
+
+// Parses one request: an array of bulk strings as sent by redis-cli and client libraries, or a space
+// separated inline command for telnet and nc. The arguments point into buffer, offset only moves
+// past the request when it is complete.
+inline RespStatus resp_parse_request(std::string_view buffer, size_t &offset, std::vector<std::string_view> &args)
+{
+    args.clear();
+    size_t pos = offset;
+    std::string_view line;
+    if (auto status = resp_read_line(buffer, pos, line); status != RespStatus::complete)
+    {
+        return status;
+    }
+
+    if (line.empty() || line.front() != '*')
+    {
+        for (auto word : std::views::split(line, ' '))
+        {
+            if (!word.empty())
+            {
+                args.emplace_back(&*word.begin(), static_cast<size_t>(std::ranges::distance(word)));
+            }
+        }
+        offset = pos;
+        return RespStatus::complete;
+    }
+
+    int64_t count = 0;
+    if (!resp_parse_integer(line.substr(1), count) || count < 0)
+    {
+        return RespStatus::error;
+    }
+    for (int64_t i = 0; i < count; ++i)
+    {
+        if (auto status = resp_read_line(buffer, pos, line); status != RespStatus::complete)
+        {
+            return status;
+        }
+        int64_t length = 0;
+        if (line.empty() || line.front() != '$' || !resp_parse_integer(line.substr(1), length) || length < 0)
+        {
+            return RespStatus::error;
+        }
+        const auto size = static_cast<size_t>(length);
+        if (buffer.size() < pos + size + 2)
+        {
+            return RespStatus::incomplete;
+        }
+        args.push_back(buffer.substr(pos, size));
+        pos += size + 2;
+    }
+    offset = pos;
+    return RespStatus::complete;
+}
+
+// Skips one reply of any type, counting null bulk strings for the load generator
+inline RespStatus resp_skip_reply(std::string_view buffer, size_t &offset, size_t &nulls, size_t &errors)
+{
+    size_t pos = offset;
+    std::string_view line;
+    if (auto status = resp_read_line(buffer, pos, line); status != RespStatus::complete)
+    {
+        return status;
+    }
+    if (line.empty())
+    {
+        return RespStatus::error;
+    }
+
+    int64_t value = 0;
+    switch (line.front())
+    {
+    case '+':
+    case ':':
+        break;
+    case '-':
+        errors++;
+        break;
+    case '$':
+        if (!resp_parse_integer(line.substr(1), value))
+        {
+            return RespStatus::error;
+        }
+        if (value < 0)
+        {
+            nulls++;
+            break;
+        }
+        if (buffer.size() < pos + static_cast<size_t>(value) + 2)
+        {
+            return RespStatus::incomplete;
+        }
+        pos += static_cast<size_t>(value) + 2;
+        break;
+    case '*':
+        if (!resp_parse_integer(line.substr(1), value))
+        {
+            return RespStatus::error;
+        }
+        for (int64_t i = 0; i < value; ++i)
+        {
+            if (auto status = resp_skip_reply(buffer, pos, nulls, errors); status != RespStatus::complete)
+            {
+                return status;
+            }
+        }
+        break;
+    default:
+        return RespStatus::error;
+    }
+    offset = pos;
+    return RespStatus::complete;
+}
+
+inline void resp_append_simple(std::string &out, std::string_view text)
+{
+    out += '+';
+    out += text;
+    out += "\r\n";
+}
+
+inline void resp_append_error(std::string &out, std::string_view text)
+{
+    out += "-ERR ";
+    out += text;
+    out += "\r\n";
+}
+
+inline void resp_append_integer(std::string &out, uint64_t value)
+{
+    out += ':';
+    out += std::to_string(value);
+    out += "\r\n";
+}
+
+inline void resp_append_array_header(std::string &out, size_t count)
+{
+    out += '*';
+    out += std::to_string(count);
+    out += "\r\n";
+}
+
+inline void resp_append_bulk(std::string &out, std::string_view value)
+{
+    out += '$';
+    out += std::to_string(value.size());
+    out += "\r\n";
+    out += value;
+    out += "\r\n";
+}
+
+inline void resp_append_null(std::string &out)
+{
+    out += "$-1\r\n";
+}
+
+inline void resp_append_command(std::string &out, std::initializer_list<std::string_view> args)
+{
+    resp_append_array_header(out, args.size());
+    for (auto arg : args)
+    {
+        resp_append_bulk(out, arg);
+    }
+}
+
+inline bool ascii_iequals(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+                                              { return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y)); });
+}
+
+struct ServeConfig
+{
+    std::string socket_path; // Unix domain socket, TCP on localhost when empty
+    uint16_t port = 6380;
+    unsigned event_threads = 2;
+    size_t memtable_bytes = 8 * 1024 * 1024;
+};
+
+// Opens a non-blocking listening socket on a Unix domain path or 127.0.0.1:port
+inline int open_listen_socket(const std::string &socket_path, uint16_t port)
+{
+    const bool use_unix = !socket_path.empty();
+    int fd = socket(use_unix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
+    }
+
+    int result = 0;
+    if (use_unix)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(address.sun_path))
+        {
+            close(fd);
+            throw std::runtime_error("Socket path too long: " + socket_path);
+        }
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+        unlink(socket_path.c_str());
+        result = bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    }
+    else
+    {
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        result = bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    }
+    if (result == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        const std::string error = strerror(errno);
+        close(fd);
+        throw std::runtime_error("Failed to listen: " + error);
+    }
+    return fd;
+}
+
+// Blocking client connection for the load generator
+inline int connect_socket(const std::string &socket_path, uint16_t port)
+{
+    const bool use_unix = !socket_path.empty();
+    int fd = socket(use_unix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
+    }
+
+    int result = 0;
+    if (use_unix)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+        result = connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    }
+    else
+    {
+        int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        result = connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    }
+    if (result == -1)
+    {
+        const std::string error = strerror(errno);
+        close(fd);
+        throw std::runtime_error("Failed to connect: " + error);
+    }
+    return fd;
+}
+
+inline std::atomic<bool> serve_stop_requested{false};
+
+// Serves an LSMTree over RESP. Every event loop thread owns an epoll instance and the connections it
+// accepted; the shared listening socket is registered with EPOLLEXCLUSIVE so one loop wakes per connection.
+// All complete requests in a read are executed as a batch and answered with a single write, runs of
+// pipelined GETs share one lookup under the tree lock. Replies are serialized after the lock is
+// released while other loops flush and compact, which relies on the tree returning copies.
+template <typename StringType>
+class LsmServer
+{
+private:
+    static constexpr size_t READ_CHUNK = 64 * 1024;
+    static constexpr size_t MAX_BUFFERED_BYTES = 64 * 1024 * 1024;
+
+    struct Connection
+    {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        size_t output_offset = 0;
+        bool writing = false; // Registered for EPOLLOUT
+        bool closing = false; // Close once the output is written
+    };
+
+    LSMTree<StringType> &lsm_;
+    int listen_fd_;
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> batches_{0};
+
+    static void append_value(std::string &out, const std::optional<StringType> &value)
+    {
+        // Empty values are tombstones
+        if (value.has_value() && !value->empty())
+        {
+            resp_append_bulk(out, std::string_view(value->data(), value->size()));
+        }
+        else
+        {
+            resp_append_null(out);
+        }
+    }
+
+    std::vector<std::optional<StringType>> lookup(std::span<const std::string_view> keys)
+    {
+        std::vector<StringType> query_keys;
+        query_keys.reserve(keys.size());
+        for (auto key : keys)
+        {
+            query_keys.push_back(make_query_key<StringType>(key));
+        }
+        return lsm_.multi_get(query_keys);
+    }
+
+    void execute(std::span<const std::string_view> args, Connection &connection)
+    {
+        std::string &out = connection.output;
+        const std::string_view command = args.front();
+        if (ascii_iequals(command, "GET") && args.size() == 2)
+        {
+            append_value(out, lsm_.get(make_query_key<StringType>(args[1])));
+        }
+        else if ((ascii_iequals(command, "SET") || ascii_iequals(command, "PUT")) && args.size() == 3)
+        {
+            lsm_.put(make_owned_string<StringType>(args[1]), make_owned_string<StringType>(args[2]));
+            resp_append_simple(out, "OK");
+        }
+        else if (ascii_iequals(command, "DEL") && args.size() >= 2)
+        {
+            uint64_t deleted = 0;
+            for (const auto &value : lookup(args.subspan(1)))
+            {
+                deleted += value.has_value() && !value->empty() ? 1u : 0u;
+            }
+            for (auto key : args.subspan(1))
+            {
+                lsm_.delete_key(make_owned_string<StringType>(key));
+            }
+            resp_append_integer(out, deleted);
+        }
+        else if (ascii_iequals(command, "MGET") && args.size() >= 2)
+        {
+            auto values = lookup(args.subspan(1));
+            resp_append_array_header(out, values.size());
+            for (const auto &value : values)
+            {
+                append_value(out, value);
+            }
+        }
+        else if (ascii_iequals(command, "SCAN") && (args.size() == 2 || args.size() == 3))
+        {
+            // SCAN start [count]: key/value pairs from start on, not Redis cursor semantics
+            int64_t count = 10;
+            if (args.size() == 3 && (!resp_parse_integer(args[2], count) || count < 0))
+            {
+                resp_append_error(out, "invalid count");
+                return;
+            }
+            auto entries = lsm_.scan(make_query_key<StringType>(args[1]), static_cast<size_t>(count));
+            resp_append_array_header(out, entries.size() * 2);
+            for (const auto &[key, value] : entries)
+            {
+                resp_append_bulk(out, std::string_view(key.data(), key.size()));
+                resp_append_bulk(out, std::string_view(value.data(), value.size()));
+            }
+        }
+        else if (ascii_iequals(command, "PING"))
+        {
+            resp_append_simple(out, "PONG");
+        }
+        else if (ascii_iequals(command, "QUIT"))
+        {
+            resp_append_simple(out, "OK");
+            connection.closing = true;
+        }
+        else
+        {
+            resp_append_error(out, "unknown command or wrong number of arguments for '" + std::string(command) + "'");
+        }
+    }
+
+    // Executes every complete request in the input buffer, returns false on a protocol error. The
+    // requests pipelined ahead of a malformed one are still answered before the error.
+    bool process_batch(Connection &connection)
+    {
+        std::vector<std::vector<std::string_view>> requests;
+        std::vector<std::string_view> args;
+        size_t offset = 0;
+        RespStatus status;
+        while ((status = resp_parse_request(connection.input, offset, args)) == RespStatus::complete)
+        {
+            if (!args.empty())
+            {
+                requests.push_back(args);
+            }
+        }
+
+        for (size_t i = 0; i < requests.size() && !connection.closing;)
+        {
+            // Answer a run of plain GETs with one batched lookup
+            size_t run_end = i;
+            while (run_end < requests.size() && requests[run_end].size() == 2 && ascii_iequals(requests[run_end][0], "GET"))
+            {
+                run_end++;
+            }
+            if (run_end - i > 1)
+            {
+                std::vector<std::string_view> keys;
+                for (size_t j = i; j < run_end; ++j)
+                {
+                    keys.push_back(requests[j][1]);
+                }
+                try
+                {
+                    for (const auto &value : lookup(keys))
+                    {
+                        append_value(connection.output, value);
+                    }
+                }
+                catch (const SSTableCorruption &e)
+                {
+                    for (size_t j = i; j < run_end; ++j)
+                    {
+                        resp_append_error(connection.output, e.what());
+                    }
+                }
+                i = run_end;
+                continue;
+            }
+            // Commands read everything they need before writing a reply, so a failed read leaves no partial output
+            try
+            {
+                execute(requests[i], connection);
+            }
+            catch (const SSTableCorruption &e)
+            {
+                resp_append_error(connection.output, e.what());
+            }
+            i++;
+        }
+
+        // After a QUIT the connection is closing and gets no further replies
+        if (status == RespStatus::error && !connection.closing)
+        {
+            resp_append_error(connection.output, "protocol error");
+            connection.closing = true;
+        }
+
+        requests_.fetch_add(requests.size(), std::memory_order_relaxed);
+        if (!requests.empty())
+        {
+            batches_.fetch_add(1, std::memory_order_relaxed);
+        }
+        connection.input.erase(0, offset);
+        return status != RespStatus::error && connection.input.size() <= MAX_BUFFERED_BYTES;
+    }
+
+    // Writes as much pending output as the socket takes, returns false when the peer is gone
+    bool write_output(Connection &connection)
+    {
+        while (connection.output_offset < connection.output.size())
+        {
+            ssize_t written = send(connection.fd, connection.output.data() + connection.output_offset,
+                                   connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+            if (written < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    return true;
+                }
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            connection.output_offset += static_cast<size_t>(written);
+        }
+        connection.output.clear();
+        connection.output_offset = 0;
+        return true;
+    }
+
+    // Returns false when the connection should be closed
+    bool handle_events(int epoll_fd, Connection &connection, uint32_t events)
+    {
+        if (events & (EPOLLERR | EPOLLHUP))
+        {
+            return false;
+        }
+
+        bool peer_closed = false;
+        if (events & EPOLLIN)
+        {
+            char buffer[READ_CHUNK];
+            while (true)
+            {
+                ssize_t bytes = recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (bytes > 0)
+                {
+                    connection.input.append(buffer, static_cast<size_t>(bytes));
+                    continue;
+                }
+                if (bytes < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                peer_closed = bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            if (!process_batch(connection))
+            {
+                connection.closing = true;
+            }
+        }
+
+        if (!write_output(connection))
+        {
+            return false;
+        }
+        const bool pending = connection.output_offset < connection.output.size();
+        if (!pending && (connection.closing || peer_closed))
+        {
+            return false;
+        }
+        if (pending != connection.writing)
+        {
+            epoll_event event{};
+            event.events = EPOLLIN | (pending ? EPOLLOUT : 0u);
+            event.data.ptr = &connection;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.writing = pending;
+        }
+        return true;
+    }
+
+    void accept_connections(int epoll_fd, std::unordered_map<int, std::unique_ptr<Connection>> &connections)
+    {
+        while (true)
+        {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd == -1)
+            {
+                return;
+            }
+            int no_delay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+            auto connection = std::make_unique<Connection>();
+            connection->fd = fd;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = connection.get();
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1)
+            {
+                close(fd);
+                continue;
+            }
+            connections.emplace(fd, std::move(connection));
+        }
+    }
+
+    void event_loop()
+    {
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd == -1)
+        {
+            throw std::runtime_error("Failed to create epoll instance: " + std::string(strerror(errno)));
+        }
+        epoll_event listen_event{};
+        listen_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+        listen_event.data.ptr = nullptr;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd_, &listen_event);
+
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+        std::array<epoll_event, 128> events;
+        while (!serve_stop_requested.load(std::memory_order_relaxed))
+        {
+            // The timeout bounds how long a stop request goes unnoticed
+            int ready = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), 100);
+            for (int i = 0; i < ready; ++i)
+            {
+                const auto &event = events[static_cast<size_t>(i)];
+                if (event.data.ptr == nullptr)
+                {
+                    accept_connections(epoll_fd, connections);
+                    continue;
+                }
+                auto &connection = *static_cast<Connection *>(event.data.ptr);
+                if (!handle_events(epoll_fd, connection, event.events))
+                {
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection.fd, nullptr);
+                    close(connection.fd);
+                    connections.erase(connection.fd);
+                }
+            }
+        }
+
+        for (auto &[fd, connection] : connections)
+        {
+            close(fd);
+        }
+        close(epoll_fd);
+    }
+
+public:
+    LsmServer(LSMTree<StringType> &lsm, int listen_fd)
+        : lsm_(lsm), listen_fd_(listen_fd)
+    {
+    }
+
+    // Runs until serve_stop_requested is set
+    void run(unsigned thread_count)
+    {
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(std::max(thread_count, 1u));
+        for (unsigned t = 0; t < errors.size(); ++t)
+        {
+            threads.emplace_back([this, &errors, t]
+                                 {
+                try
+                {
+                    event_loop();
+                }
+                catch (...)
+                {
+                    errors[t] = std::current_exception();
+                    serve_stop_requested.store(true);
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    uint64_t requests() const
+    {
+        return requests_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t batches() const
+    {
+        return batches_.load(std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,4294 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory_resource>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <sstream>
+#include <span>
+#include <cstring>
+#include <stdexcept>
+#include <cstdint>
+#include <chrono>
+#include <ranges>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <iomanip>
+#include <cmath>
+#include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
+#include <thread>
+#include <random>
+#include <ctime>
+#include <cctype>
+#include <tuple>
+#include <utility>
+
+// Linux memory mapping includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// CRC32C instruction
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define LSM_HAVE_SSE42_CRC 1
+#endif
+
+// Counts where every get is answered (LSMStats::get_paths), build with -DLSM_GET_PATH_STATS=0
+// to compile the counters out of the read path
+#ifndef LSM_GET_PATH_STATS
+#define LSM_GET_PATH_STATS 1
+#endif
+
+// Include the german_string header
+#include "german_string.h"
+
+// Forward declarations
+template <typename StringType>
+class SSTable;
+template <typename StringType>
+class LSMTree;
+
+// Flushes hold up writers, compactions can wait
+enum class IOPriority
+{
+    low,
+    high,
+};
+
+// Token bucket limiting background I/O bandwidth. Waiting high priority requests are
+// served before any low priority ones. With auto tuning the rate follows compaction debt:
+// background work is throttled hard while little is pending and opens up as debt grows.
+class RateLimiter
+{
+private:
+    static constexpr auto REFILL_PERIOD = std::chrono::milliseconds(10);
+    static constexpr double MIN_AUTO_TUNE_FRACTION = 0.2;
+
+    const uint64_t max_bytes_per_second_;
+    const bool auto_tune_;
+    std::atomic<uint64_t> bytes_per_second_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    double available_;
+    std::chrono::steady_clock::time_point last_refill_;
+    std::array<size_t, 2> waiting_{};
+    std::array<std::atomic<uint64_t>, 2> bytes_granted_{};
+    std::atomic<uint64_t> wait_nanos_{0};
+
+    void refill(std::chrono::steady_clock::time_point now, size_t cap)
+    {
+        const double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+        available_ = std::min(available_ + elapsed * static_cast<double>(bytes_per_second()), static_cast<double>(cap));
+        last_refill_ = now;
+    }
+
+    void acquire(size_t bytes, IOPriority priority)
+    {
+        const auto index = static_cast<size_t>(priority);
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_lock lock(mutex_);
+        waiting_[index]++;
+        while (true)
+        {
+            refill(std::chrono::steady_clock::now(), std::max(burst_bytes(), bytes));
+            const bool behind_high = priority == IOPriority::low && waiting_[static_cast<size_t>(IOPriority::high)] > 0;
+            if (!behind_high && available_ >= static_cast<double>(bytes))
+            {
+                available_ -= static_cast<double>(bytes);
+                break;
+            }
+
+            auto wait = std::chrono::duration<double>(REFILL_PERIOD);
+            if (!behind_high)
+            {
+                wait = std::chrono::duration<double>((static_cast<double>(bytes) - available_) / static_cast<double>(bytes_per_second()));
+            }
+            cv_.wait_for(lock, std::chrono::duration_cast<std::chrono::nanoseconds>(wait));
+        }
+        waiting_[index]--;
+        lock.unlock();
+
+        // Low priority waiters re-check once the high priority queue drains
+        cv_.notify_all();
+        bytes_granted_[index].fetch_add(bytes, std::memory_order_relaxed);
+        auto waited = std::chrono::steady_clock::now() - start;
+        wait_nanos_.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()),
+                              std::memory_order_relaxed);
+    }
+
+public:
+    explicit RateLimiter(uint64_t bytes_per_second, bool auto_tune = false)
+        : max_bytes_per_second_(std::max<uint64_t>(bytes_per_second, 1)), auto_tune_(auto_tune),
+          bytes_per_second_(max_bytes_per_second_), available_(0.0), last_refill_(std::chrono::steady_clock::now())
+    {
+    }
+
+    RateLimiter(const RateLimiter &) = delete;
+    RateLimiter &operator=(const RateLimiter &) = delete;
+
+    // Blocks until bytes may be transferred, large requests are granted one burst at a time
+    void request(size_t bytes, IOPriority priority)
+    {
+        while (bytes > 0)
+        {
+            const size_t chunk = std::min(bytes, burst_bytes());
+            acquire(chunk, priority);
+            bytes -= chunk;
+        }
+    }
+
+    // Scales the rate between MIN_AUTO_TUNE_FRACTION and the configured maximum by pending / target
+    void update_compaction_debt(uint64_t pending_bytes, uint64_t target_bytes)
+    {
+        if (!auto_tune_)
+        {
+            return;
+        }
+        double fraction = target_bytes > 0 ? static_cast<double>(pending_bytes) / static_cast<double>(target_bytes) : 1.0;
+        fraction = std::clamp(fraction, MIN_AUTO_TUNE_FRACTION, 1.0);
+        bytes_per_second_.store(static_cast<uint64_t>(static_cast<double>(max_bytes_per_second_) * fraction),
+                                std::memory_order_relaxed);
+        cv_.notify_all();
+    }
+
+    uint64_t bytes_per_second() const
+    {
+        return bytes_per_second_.load(std::memory_order_relaxed);
+    }
+
+    size_t burst_bytes() const
+    {
+        return std::max<size_t>(bytes_per_second() * REFILL_PERIOD.count() / 1000, 1);
+    }
+
+    uint64_t bytes_granted(IOPriority priority) const
+    {
+        return bytes_granted_[static_cast<size_t>(priority)].load(std::memory_order_relaxed);
+    }
+
+    std::chrono::nanoseconds total_wait() const
+    {
+        return std::chrono::nanoseconds(wait_nanos_.load(std::memory_order_relaxed));
+    }
+
+    bool auto_tuned() const
+    {
+        return auto_tune_;
+    }
+};
+
+// Read-only memory-mapped file for Linux, SSTables are written through SSTableWriter
+class MappedFile
+{
+private:
+    int fd_;
+    void *data_;
+    size_t size_;
+
+public:
+    explicit MappedFile(const std::string &filename)
+        : fd_(-1), data_(nullptr), size_(0)
+    {
+        fd_ = open(filename.c_str(), O_RDONLY);
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Failed to open file: " + filename + " - " + strerror(errno));
+        }
+
+        struct stat sb;
+        if (fstat(fd_, &sb) == -1)
+        {
+            close(fd_);
+            throw std::runtime_error("Failed to get file stats: " + std::string(strerror(errno)));
+        }
+
+        size_ = static_cast<size_t>(sb.st_size);
+
+        if (size_ == 0)
+        {
+            // Empty file, nothing to map
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+
+        data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data_ == MAP_FAILED)
+        {
+            close(fd_);
+            throw std::runtime_error("Failed to map file: " + std::string(strerror(errno)));
+        }
+    }
+
+    ~MappedFile()
+    {
+        if (data_ != nullptr && data_ != MAP_FAILED)
+        {
+            munmap(data_, size_);
+        }
+        if (fd_ >= 0)
+        {
+            close(fd_);
+        }
+    }
+
+    // Non-copyable, movable
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : fd_(other.fd_), data_(other.data_), size_(other.size_)
+    {
+        other.fd_ = -1;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (data_ != nullptr && data_ != MAP_FAILED)
+            {
+                munmap(data_, size_);
+            }
+            if (fd_ >= 0)
+            {
+                close(fd_);
+            }
+
+            fd_ = other.fd_;
+            data_ = other.data_;
+            size_ = other.size_;
+
+            other.fd_ = -1;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    std::span<const char> data() const
+    {
+        if (data_ == nullptr || size_ == 0)
+        {
+            return {};
+        }
+        return {static_cast<const char *>(data_), size_};
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+};
+
+// Read-only file accessed with pread instead of a mapping, for tables whose pages should not
+// stay resident. Readahead is turned off, callers decide how much to read at once.
+class PreadFile
+{
+private:
+    int fd_;
+    uint64_t size_;
+
+public:
+    explicit PreadFile(const std::string &filename)
+        : fd_(open(filename.c_str(), O_RDONLY)), size_(0)
+    {
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Failed to open file: " + filename + " - " + strerror(errno));
+        }
+        struct stat sb;
+        if (fstat(fd_, &sb) == -1)
+        {
+            close(fd_);
+            throw std::runtime_error("Failed to get file stats: " + std::string(strerror(errno)));
+        }
+        size_ = static_cast<uint64_t>(sb.st_size);
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_RANDOM);
+    }
+
+    ~PreadFile()
+    {
+        close(fd_);
+    }
+
+    PreadFile(const PreadFile &) = delete;
+    PreadFile &operator=(const PreadFile &) = delete;
+
+    uint64_t size() const { return size_; }
+
+    // Replaces out with bytes [offset, offset + size), which must lie inside the file
+    void read(uint64_t offset, size_t size, std::string &out) const
+    {
+        if (offset > size_ || size > size_ - offset)
+        {
+            throw std::runtime_error("Read past the end of the file");
+        }
+        out.resize(size);
+        size_t done = 0;
+        while (done < size)
+        {
+            const ssize_t n = pread(fd_, out.data() + done, size - done, static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                throw std::runtime_error("Failed to read file: " + std::string(n < 0 ? strerror(errno) : "unexpected end"));
+            }
+            done += static_cast<size_t>(n);
+        }
+    }
+};
+
+// CRC32C (Castagnoli) lookup tables for slicing-by-8, table[k][b] is the CRC of byte b followed by k zero bytes
+constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32c_tables()
+{
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t b = 0; b < 256; ++b)
+    {
+        uint32_t crc = b;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82f63b78u : 0u);
+        }
+        tables[0][b] = crc;
+    }
+    for (size_t k = 1; k < 8; ++k)
+    {
+        for (uint32_t b = 0; b < 256; ++b)
+        {
+            tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xff];
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto CRC32C_TABLES = make_crc32c_tables();
+
+// Portable CRC32C over a raw (not inverted) crc state, eight bytes per step
+inline uint32_t crc32c_extend_software(uint32_t crc, const char *data, size_t size)
+{
+    const auto *p = reinterpret_cast<const unsigned char *>(data);
+    const auto &t = CRC32C_TABLES;
+    while (size >= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        word ^= crc;
+        crc = t[7][word & 0xff] ^ t[6][(word >> 8) & 0xff] ^ t[5][(word >> 16) & 0xff] ^ t[4][(word >> 24) & 0xff] ^
+              t[3][(word >> 32) & 0xff] ^ t[2][(word >> 40) & 0xff] ^ t[1][(word >> 48) & 0xff] ^ t[0][word >> 56];
+        p += 8;
+        size -= 8;
+    }
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    }
+    return crc;
+}
+
+#ifdef LSM_HAVE_SSE42_CRC
+__attribute__((target("sse4.2"))) inline uint32_t crc32c_extend_hardware(uint32_t crc, const char *data, size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    auto crc32 = static_cast<uint32_t>(crc64);
+    while (size-- > 0)
+    {
+        crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*data++));
+    }
+    return crc32;
+}
+#endif
+
+// Uses the SSE4.2 crc32 instruction when the CPU has it
+inline bool crc32c_hardware_supported()
+{
+#ifdef LSM_HAVE_SSE42_CRC
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// Continues a CRC32C over more bytes, start with crc = 0
+inline uint32_t crc32c_extend(uint32_t crc, const char *data, size_t size)
+{
+#ifdef LSM_HAVE_SSE42_CRC
+    if (crc32c_hardware_supported())
+    {
+        return ~crc32c_extend_hardware(~crc, data, size);
+    }
+#endif
+    return ~crc32c_extend_software(~crc, data, size);
+}
+
+inline uint32_t crc32c(std::span<const char> data)
+{
+    return crc32c_extend(0, data.data(), data.size());
+}
+
+// Damaged or inconsistent SSTable contents, as opposed to a file that cannot be opened
+class SSTableCorruption : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Block based SSTable layout (format version 5):
+//   |data block|crc|...|filter partition|crc|index partition|crc|data block|crc|...|top level index|crc|footer|
+// Every block is followed by the CRC32C of its bytes. Data blocks hold |shared varint|unshared varint|value_len varint|key suffix|value| records, keys
+// are front coded against the previous record. Every restart_interval records a key is stored in
+// full and the block ends with one |key_len u32|key prefix 4 bytes|offset u32| restart entry per
+// restart, laid out like a german string header, and a |restart_count u32| trailer. The index has
+// one |offset u64|size u32|entries u32|key_len u32|last key| entry per data block and the filter is
+// a Bloom filter over the keys of those blocks. Index and filter are partitioned: once
+// index_partition_size bytes of index accumulate, the partition's filter and index are written
+// after its data blocks and the top level index gets one |index_offset u64|index_size u32|filter_offset u64|filter_size u32|
+// block_count u32|key_len u32|last key| entry for it. Only the top level index stays in memory,
+// partitions go through the block cache. Version 4 tables have a single filter and index:
+//   |data block|crc|...|filter block|crc|index block|crc|footer|
+// Files without the footer magic are read as legacy tables, a |record_count u32| header followed
+// by one run of records.
+constexpr uint64_t SSTABLE_MAGIC = 0x3254534d534c5347ull; // "GSLSMST2"
+constexpr uint32_t SSTABLE_FORMAT_VERSION = 5;
+constexpr uint32_t SSTABLE_SINGLE_INDEX_VERSION = 4;
+constexpr size_t BLOCK_CHECKSUM_SIZE = sizeof(uint32_t);
+
+struct SSTableFooter
+{
+    uint64_t filter_offset = 0;
+    uint64_t filter_size = 0;
+    uint64_t index_offset = 0;
+    uint64_t index_size = 0;
+    uint64_t entry_count = 0;
+    uint32_t filter_probes = 0;
+    uint32_t version = SSTABLE_FORMAT_VERSION;
+    uint64_t magic = SSTABLE_MAGIC;
+};
+static_assert(sizeof(SSTableFooter) == 56, "SSTableFooter is written as raw bytes");
+
+inline void encode_varint32(std::string &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline bool decode_varint32(const char *&ptr, const char *end, uint32_t &value)
+{
+    value = 0;
+    for (uint32_t shift = 0; shift <= 28 && ptr < end; shift += 7)
+    {
+        const auto byte = static_cast<unsigned char>(*ptr++);
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Restart entry of a front coded block: length and first bytes of the full key, like a german
+// string header, so the restart binary search rarely has to touch the records
+struct BlockRestart
+{
+    uint32_t key_len = 0;
+    char prefix[4] = {};
+    uint32_t offset = 0;
+
+    static BlockRestart make(std::string_view key, uint32_t offset)
+    {
+        BlockRestart restart;
+        restart.key_len = static_cast<uint32_t>(key.size());
+        std::memcpy(restart.prefix, key.data(), std::min<size_t>(key.size(), sizeof(prefix)));
+        restart.offset = offset;
+        return restart;
+    }
+};
+static_assert(sizeof(BlockRestart) == 12, "BlockRestart is written as raw bytes");
+
+// Walks the records of one data block, rebuilding front coded keys. Keys stored in full are
+// viewed in place, others are assembled in a buffer that the next record overwrites.
+class BlockReader
+{
+private:
+    const char *begin_ = nullptr;
+    const char *ptr_ = nullptr;
+    const char *records_end_ = nullptr;
+    const char *restarts_ = nullptr;
+    uint32_t restart_count_ = 0;
+    std::string key_buffer_;
+    std::string_view key_;
+    std::string_view value_;
+
+    BlockRestart restart(size_t i) const
+    {
+        BlockRestart entry;
+        std::memcpy(&entry, restarts_ + i * sizeof(BlockRestart), sizeof(BlockRestart));
+        return entry;
+    }
+
+    // Orders the restart key against target, reading the record only when the header ties
+    int compare_restart(size_t i, std::string_view target) const
+    {
+        const BlockRestart entry = restart(i);
+        char target_prefix[4] = {};
+        std::memcpy(target_prefix, target.data(), std::min<size_t>(target.size(), sizeof(target_prefix)));
+        const int cmp = std::memcmp(entry.prefix, target_prefix, sizeof(target_prefix));
+        if (cmp != 0)
+        {
+            return cmp;
+        }
+        if (entry.key_len <= sizeof(target_prefix) && target.size() <= sizeof(target_prefix))
+        {
+            return entry.key_len < target.size() ? -1 : (entry.key_len > target.size() ? 1 : 0);
+        }
+        const char *ptr = begin_ + entry.offset;
+        uint32_t shared;
+        uint32_t unshared;
+        uint32_t value_len;
+        if (!decode_varint32(ptr, records_end_, shared) || !decode_varint32(ptr, records_end_, unshared) ||
+            !decode_varint32(ptr, records_end_, value_len) || shared != 0 || unshared != entry.key_len ||
+            static_cast<uint64_t>(records_end_ - ptr) < unshared)
+        {
+            throw SSTableCorruption("Corrupted SSTable block restart");
+        }
+        return std::string_view(ptr, unshared).compare(target);
+    }
+
+public:
+    BlockReader() = default;
+    BlockReader(const BlockReader &) = delete;
+    BlockReader &operator=(const BlockReader &) = delete;
+
+    void reset(std::span<const char> block)
+    {
+        begin_ = block.data();
+        ptr_ = begin_;
+        records_end_ = begin_ + block.size();
+        restarts_ = records_end_;
+        restart_count_ = 0;
+        key_ = {};
+        value_ = {};
+        if (block.size() < sizeof(uint32_t))
+        {
+            throw SSTableCorruption("Corrupted SSTable block trailer");
+        }
+        std::memcpy(&restart_count_, records_end_ - sizeof(uint32_t), sizeof(uint32_t));
+        const uint64_t trailer = static_cast<uint64_t>(restart_count_) * sizeof(BlockRestart) + sizeof(uint32_t);
+        if (trailer > block.size())
+        {
+            throw SSTableCorruption("Corrupted SSTable block trailer");
+        }
+        records_end_ = begin_ + (block.size() - trailer);
+        restarts_ = records_end_;
+    }
+
+    // Decodes the next record, false at the end of the block
+    bool next()
+    {
+        if (ptr_ >= records_end_)
+        {
+            return false;
+        }
+        uint32_t shared;
+        uint32_t unshared;
+        uint32_t value_len;
+        if (!decode_varint32(ptr_, records_end_, shared) || !decode_varint32(ptr_, records_end_, unshared) ||
+            !decode_varint32(ptr_, records_end_, value_len) || shared > key_.size() ||
+            static_cast<uint64_t>(records_end_ - ptr_) < static_cast<uint64_t>(unshared) + value_len)
+        {
+            throw SSTableCorruption("Corrupted SSTable block record");
+        }
+        if (shared == 0)
+        {
+            key_ = std::string_view(ptr_, unshared);
+        }
+        else
+        {
+            if (key_.data() == key_buffer_.data())
+            {
+                key_buffer_.resize(shared);
+            }
+            else
+            {
+                key_buffer_.assign(key_.data(), shared);
+            }
+            key_buffer_.append(ptr_, unshared);
+            key_ = key_buffer_;
+        }
+        value_ = std::string_view(ptr_ + unshared, value_len);
+        ptr_ += unshared + value_len;
+        return true;
+    }
+
+    // Positions on the first record >= target, false when every record is smaller
+    bool seek(std::string_view target)
+    {
+        if (restart_count_ > 0)
+        {
+            // Last restart whose key is <= target, the scan below covers at most one interval
+            size_t low = 0;
+            size_t high = restart_count_;
+            while (high - low > 1)
+            {
+                const size_t mid = low + (high - low) / 2;
+                if (compare_restart(mid, target) <= 0)
+                {
+                    low = mid;
+                }
+                else
+                {
+                    high = mid;
+                }
+            }
+            const uint32_t offset = restart(low).offset;
+            if (offset > static_cast<uint64_t>(records_end_ - begin_))
+            {
+                throw SSTableCorruption("Corrupted SSTable block restart");
+            }
+            ptr_ = begin_ + offset;
+            key_ = {};
+        }
+        while (next())
+        {
+            if (key_.compare(target) >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string_view key() const
+    {
+        return key_;
+    }
+
+    std::string_view value() const
+    {
+        return value_;
+    }
+};
+
+// Compares a block with the CRC32C stored in its last four bytes
+inline bool block_checksum_matches(std::span<const char> block_with_checksum)
+{
+    const size_t size = block_with_checksum.size() - BLOCK_CHECKSUM_SIZE;
+    uint32_t stored;
+    std::memcpy(&stored, block_with_checksum.data() + size, sizeof(stored));
+    return crc32c(block_with_checksum.first(size)) == stored;
+}
+
+// Checks the CRC32C stored in the last four bytes of a block
+inline void verify_block_checksum(std::span<const char> block_with_checksum, const std::string &what)
+{
+    if (block_with_checksum.size() < BLOCK_CHECKSUM_SIZE)
+    {
+        throw SSTableCorruption("Truncated " + what);
+    }
+    if (!block_checksum_matches(block_with_checksum))
+    {
+        throw SSTableCorruption("Checksum mismatch in " + what);
+    }
+}
+
+// Hands out the data blocks of a mapped table, checking each block's checksum the first time it
+// is read. A bit per block remembers the blocks that passed, so the page cache copy is trusted
+// afterwards and every block is checksummed once per open table instead of on every read.
+class BlockVerifier
+{
+private:
+    std::span<const char> data_;
+    std::string filename_;
+    std::string kind_;
+    std::vector<std::atomic<uint64_t>> verified_;
+
+public:
+    void reset(std::span<const char> data, const std::string &filename, size_t block_count, const std::string &kind = "block")
+    {
+        data_ = data;
+        filename_ = filename;
+        kind_ = kind;
+        verified_ = std::vector<std::atomic<uint64_t>>((block_count + 63) / 64);
+    }
+
+    // Block bytes without the checksum, throws SSTableCorruption on a mismatch
+    std::span<const char> block(size_t block, uint64_t offset, uint32_t size)
+    {
+        auto &word = verified_[block / 64];
+        const uint64_t bit = uint64_t{1} << (block % 64);
+        if ((word.load(std::memory_order_relaxed) & bit) == 0)
+        {
+            verify_block_checksum(data_.subspan(offset, size + BLOCK_CHECKSUM_SIZE),
+                                  kind_ + " " + std::to_string(block) + " of " + filename_);
+            word.fetch_or(bit, std::memory_order_relaxed);
+        }
+        return data_.subspan(offset, size);
+    }
+};
+
+// Sharded LRU cache of decoded table metadata, shared by all tables of a tree. Entries are keyed
+// by table id and file offset and charged with their decoded size. Tables get a fresh id when
+// opened, so entries of deleted tables are never hit again and simply age out.
+class BlockCache
+{
+private:
+    static constexpr size_t SHARD_BITS = 4;
+
+    struct Key
+    {
+        uint64_t table = 0;
+        uint64_t offset = 0;
+
+        bool operator==(const Key &) const = default;
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const
+        {
+            return mix(key);
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const void> value;
+        size_t charge = 0;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> map;
+        size_t usage = 0;
+    };
+
+    size_t capacity_;
+    std::array<Shard, 1u << SHARD_BITS> shards_;
+    std::atomic<uint64_t> next_table_id_{1};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+
+    static uint64_t mix(const Key &key)
+    {
+        uint64_t hash = key.table * 0x9e3779b97f4a7c15ull ^ key.offset;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    Shard &shard(const Key &key)
+    {
+        return shards_[mix(key) >> (64 - SHARD_BITS)];
+    }
+
+    size_t shard_capacity() const
+    {
+        return capacity_ >> SHARD_BITS;
+    }
+
+public:
+    explicit BlockCache(size_t capacity) : capacity_(capacity)
+    {
+    }
+
+    BlockCache(const BlockCache &) = delete;
+    BlockCache &operator=(const BlockCache &) = delete;
+
+    uint64_t new_table_id()
+    {
+        return next_table_id_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<const void> lookup(uint64_t table, uint64_t offset)
+    {
+        const Key key{table, offset};
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.map.find(key);
+        if (it == s.map.end())
+        {
+            misses_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second->value;
+    }
+
+    // Values larger than a shard are not cached, the caller keeps its own copy either way
+    void insert(uint64_t table, uint64_t offset, std::shared_ptr<const void> value, size_t charge)
+    {
+        if (charge > shard_capacity())
+        {
+            return;
+        }
+        const Key key{table, offset};
+        Shard &s = shard(key);
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (auto it = s.map.find(key); it != s.map.end())
+        {
+            // Another reader decoded the same block concurrently
+            return;
+        }
+        s.lru.push_front(Entry{key, std::move(value), charge});
+        s.map.emplace(key, s.lru.begin());
+        s.usage += charge;
+        while (s.usage > shard_capacity())
+        {
+            const Entry &victim = s.lru.back();
+            s.usage -= victim.charge;
+            s.map.erase(victim.key);
+            s.lru.pop_back();
+        }
+    }
+
+    size_t usage()
+    {
+        size_t total = 0;
+        for (auto &s : shards_)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            total += s.usage;
+        }
+        return total;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    uint64_t hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+};
+
+// 64-bit FNV-1a with a final avalanche, stable across platforms since filters are persisted
+inline uint64_t bloom_hash(std::string_view key)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : key)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Double hashing derives all probe positions from one key hash
+inline bool bloom_may_contain(std::span<const char> filter, uint32_t probes, uint64_t hash)
+{
+    const uint64_t bits = filter.size() * 8;
+    if (bits == 0)
+    {
+        return true;
+    }
+    const uint64_t delta = (hash >> 33) | (hash << 31);
+    for (uint32_t i = 0; i < probes; ++i)
+    {
+        const uint64_t bit = hash % bits;
+        if ((static_cast<unsigned char>(filter[bit / 8]) & (1u << (bit % 8))) == 0)
+        {
+            return false;
+        }
+        hash += delta;
+    }
+    return true;
+}
+
+struct SSTableWriterOptions
+{
+    size_t block_size = 4 * 1024;
+    size_t restart_interval = 16;   // Keys between full keys in a block, 1 disables front coding
+    size_t bloom_bits_per_key = 10; // 0 disables the filter
+    size_t index_partition_size = 4 * 1024; // Index bytes per partition, 0 writes one unpartitioned index
+    size_t buffer_size = 1024 * 1024;
+    bool direct_io = false; // Falls back to buffered I/O where O_DIRECT is not supported
+    RateLimiter *rate_limiter = nullptr;
+    IOPriority priority = IOPriority::high;
+};
+
+// Streams sorted entries into a block based SSTable through one aligned buffer, so a table never
+// has to be materialized in memory. The index and filter are collected while adding entries. The
+// file is written as filename.tmp and renamed after a single fdatasync in finish(), a writer
+// destroyed before finish() removes its temporary file.
+class SSTableWriter
+{
+private:
+    static constexpr size_t IO_ALIGNMENT = 4096;
+
+    std::string filename_;
+    std::string temp_filename_;
+    SSTableWriterOptions options_;
+    int fd_;
+    bool direct_io_;
+    char *buffer_;
+    size_t buffer_size_;
+    size_t buffer_used_;
+    uint64_t file_offset_; // Bytes already written to the file
+    uint64_t block_start_;
+    uint32_t block_entries_;
+    std::string last_key_;
+    std::string record_;
+    std::vector<BlockRestart> restarts_;
+    uint32_t checksum_; // CRC32C of the block being appended
+    std::string top_index_;
+    uint32_t partition_blocks_;
+    std::string index_;
+    std::vector<uint64_t> key_hashes_;
+    uint64_t entry_count_;
+    bool finished_;
+
+    uint64_t logical_offset() const
+    {
+        return file_offset_ + buffer_used_;
+    }
+
+    void write_fully(const char *data, size_t size, uint64_t offset)
+    {
+        while (size > 0)
+        {
+            ssize_t written = pwrite(fd_, data, size, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINVAL && direct_io_)
+            {
+                // The file system rejected O_DIRECT, continue with buffered writes
+                fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                direct_io_ = false;
+                continue;
+            }
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error("Failed to write " + temp_filename_ + ": " + strerror(errno));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+            offset += static_cast<uint64_t>(written);
+        }
+    }
+
+    // Writes the buffered bytes, O_DIRECT needs the last partial write padded to the alignment
+    void write_buffer()
+    {
+        if (buffer_used_ == 0)
+        {
+            return;
+        }
+        if (options_.rate_limiter != nullptr)
+        {
+            options_.rate_limiter->request(buffer_used_, options_.priority);
+        }
+
+        size_t write_size = buffer_used_;
+        if (direct_io_ && write_size % IO_ALIGNMENT != 0)
+        {
+            const size_t padded = (write_size + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+            std::memset(buffer_ + write_size, 0, padded - write_size);
+            write_size = padded;
+        }
+        write_fully(buffer_, write_size, file_offset_);
+        if (options_.rate_limiter != nullptr && !direct_io_)
+        {
+            // Keep dirty pages from piling up so paced writes reach the disk paced as well
+            sync_file_range(fd_, static_cast<off64_t>(file_offset_), static_cast<off64_t>(buffer_used_), SYNC_FILE_RANGE_WRITE);
+        }
+        file_offset_ += buffer_used_;
+        buffer_used_ = 0;
+    }
+
+    void append(const void *data, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(data);
+        checksum_ = crc32c_extend(checksum_, bytes, size);
+        while (size > 0)
+        {
+            const size_t chunk = std::min(size, buffer_size_ - buffer_used_);
+            std::memcpy(buffer_ + buffer_used_, bytes, chunk);
+            buffer_used_ += chunk;
+            bytes += chunk;
+            size -= chunk;
+            if (buffer_used_ == buffer_size_)
+            {
+                write_buffer();
+            }
+        }
+    }
+
+    // Ends the current block with the checksum of everything appended since the previous one
+    void append_checksum()
+    {
+        const uint32_t checksum = checksum_;
+        append(&checksum, sizeof(checksum));
+        checksum_ = 0;
+    }
+
+    template <typename T>
+    void append_value(std::string &out, T value)
+    {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void finish_block()
+    {
+        if (block_entries_ == 0)
+        {
+            return;
+        }
+        const auto restart_count = static_cast<uint32_t>(restarts_.size());
+        append(restarts_.data(), restarts_.size() * sizeof(BlockRestart));
+        append(&restart_count, sizeof(restart_count));
+        restarts_.clear();
+        const auto block_size = static_cast<uint32_t>(logical_offset() - block_start_);
+        append_checksum();
+
+        append_value(index_, block_start_);
+        append_value(index_, block_size);
+        append_value(index_, block_entries_);
+        append_value(index_, static_cast<uint32_t>(last_key_.size()));
+        index_ += last_key_;
+        partition_blocks_++;
+        if (options_.index_partition_size > 0 && index_.size() >= options_.index_partition_size)
+        {
+            finish_partition();
+        }
+        block_start_ = logical_offset();
+        block_entries_ = 0;
+    }
+
+    // Writes the filter and index of the blocks since the previous partition and records them in
+    // the top level index, so the writer never holds more than one partition of metadata
+    void finish_partition()
+    {
+        if (partition_blocks_ == 0)
+        {
+            return;
+        }
+        const std::string filter = build_filter();
+        const uint64_t filter_offset = logical_offset();
+        append(filter.data(), filter.size());
+        append_checksum();
+        const uint64_t index_offset = logical_offset();
+        append(index_.data(), index_.size());
+        append_checksum();
+
+        append_value(top_index_, index_offset);
+        append_value(top_index_, static_cast<uint32_t>(index_.size()));
+        append_value(top_index_, filter_offset);
+        append_value(top_index_, static_cast<uint32_t>(filter.size()));
+        append_value(top_index_, partition_blocks_);
+        append_value(top_index_, static_cast<uint32_t>(last_key_.size()));
+        top_index_ += last_key_;
+        index_.clear();
+        key_hashes_.clear();
+        partition_blocks_ = 0;
+    }
+
+    uint32_t filter_probes() const
+    {
+        if (options_.bloom_bits_per_key == 0)
+        {
+            return 0;
+        }
+        // ln(2) * bits per key minimizes the false positive rate
+        return static_cast<uint32_t>(std::clamp<double>(std::round(static_cast<double>(options_.bloom_bits_per_key) * 0.69), 1.0, 30.0));
+    }
+
+    std::string build_filter() const
+    {
+        const uint32_t probes = filter_probes();
+        if (probes == 0 || key_hashes_.empty())
+        {
+            return {};
+        }
+        const size_t bits = std::max<size_t>(key_hashes_.size() * options_.bloom_bits_per_key, 64);
+        std::string filter((bits + 7) / 8, '\0');
+        const uint64_t filter_bits = filter.size() * 8;
+        for (uint64_t hash : key_hashes_)
+        {
+            const uint64_t delta = (hash >> 33) | (hash << 31);
+            for (uint32_t i = 0; i < probes; ++i)
+            {
+                const uint64_t bit = hash % filter_bits;
+                filter[bit / 8] = static_cast<char>(static_cast<unsigned char>(filter[bit / 8]) | (1u << (bit % 8)));
+                hash += delta;
+            }
+        }
+        return filter;
+    }
+
+public:
+    explicit SSTableWriter(const std::string &filename, const SSTableWriterOptions &options = SSTableWriterOptions())
+        : filename_(filename), temp_filename_(filename + ".tmp"), options_(options), fd_(-1), direct_io_(options.direct_io),
+          buffer_(nullptr), buffer_size_(0), buffer_used_(0), file_offset_(0), block_start_(0), block_entries_(0),
+          checksum_(0), partition_blocks_(0), entry_count_(0), finished_(false)
+    {
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        fd_ = open(temp_filename_.c_str(), flags | (direct_io_ ? O_DIRECT : 0), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        if (fd_ == -1 && direct_io_ && errno == EINVAL)
+        {
+            direct_io_ = false;
+            fd_ = open(temp_filename_.c_str(), flags, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+        }
+        if (fd_ == -1)
+        {
+            throw std::runtime_error("Failed to create file: " + temp_filename_ + " - " + strerror(errno));
+        }
+
+        buffer_size_ = std::max<size_t>((options_.buffer_size + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT, IO_ALIGNMENT);
+        void *buffer = nullptr;
+        if (posix_memalign(&buffer, IO_ALIGNMENT, buffer_size_) != 0)
+        {
+            close(fd_);
+            unlink(temp_filename_.c_str());
+            throw std::runtime_error("Failed to allocate SSTable write buffer");
+        }
+        buffer_ = static_cast<char *>(buffer);
+    }
+
+    SSTableWriter(const SSTableWriter &) = delete;
+    SSTableWriter &operator=(const SSTableWriter &) = delete;
+
+    ~SSTableWriter()
+    {
+        if (fd_ >= 0)
+        {
+            close(fd_);
+        }
+        if (!finished_)
+        {
+            unlink(temp_filename_.c_str());
+        }
+        free(buffer_);
+    }
+
+    // Keys must be added in ascending order
+    void add(std::string_view key, std::string_view value)
+    {
+        size_t shared = 0;
+        if (block_entries_ % std::max<size_t>(options_.restart_interval, 1) == 0)
+        {
+            restarts_.push_back(BlockRestart::make(key, static_cast<uint32_t>(logical_offset() - block_start_)));
+        }
+        else
+        {
+            const size_t limit = std::min(key.size(), last_key_.size());
+            while (shared < limit && key[shared] == last_key_[shared])
+            {
+                shared++;
+            }
+        }
+        record_.clear();
+        encode_varint32(record_, static_cast<uint32_t>(shared));
+        encode_varint32(record_, static_cast<uint32_t>(key.size() - shared));
+        encode_varint32(record_, static_cast<uint32_t>(value.size()));
+        record_.append(key.substr(shared));
+        append(record_.data(), record_.size());
+        append(value.data(), value.size());
+
+        last_key_.assign(key);
+        if (options_.bloom_bits_per_key > 0)
+        {
+            key_hashes_.push_back(bloom_hash(key));
+        }
+        block_entries_++;
+        entry_count_++;
+        if (logical_offset() - block_start_ >= options_.block_size)
+        {
+            finish_block();
+        }
+    }
+
+    // Writes filter, index and footer, syncs once and moves the file into place. Returns the file size.
+    uint64_t finish()
+    {
+        finish_block();
+
+        SSTableFooter footer;
+        footer.filter_probes = filter_probes();
+        if (options_.index_partition_size > 0)
+        {
+            // The footer points at the top level index, there is no table wide filter
+            finish_partition();
+            footer.version = SSTABLE_FORMAT_VERSION;
+            footer.filter_offset = logical_offset();
+            footer.filter_size = 0;
+            footer.index_offset = logical_offset();
+            footer.index_size = top_index_.size();
+            append(top_index_.data(), top_index_.size());
+            append_checksum();
+        }
+        else
+        {
+            const std::string filter = build_filter();
+            footer.version = SSTABLE_SINGLE_INDEX_VERSION;
+            footer.filter_offset = logical_offset();
+            footer.filter_size = filter.size();
+            append(filter.data(), filter.size());
+            append_checksum();
+            footer.index_offset = logical_offset();
+            footer.index_size = index_.size();
+            append(index_.data(), index_.size());
+            append_checksum();
+        }
+        footer.entry_count = entry_count_;
+        append(&footer, sizeof(footer));
+
+        const uint64_t file_size = logical_offset();
+        const bool padded = direct_io_ && buffer_used_ % IO_ALIGNMENT != 0;
+        write_buffer();
+        if (padded && ftruncate(fd_, static_cast<off_t>(file_size)) == -1)
+        {
+            throw std::runtime_error("Failed to truncate " + temp_filename_ + ": " + strerror(errno));
+        }
+        if (fdatasync(fd_) == -1)
+        {
+            throw std::runtime_error("Failed to sync " + temp_filename_ + ": " + strerror(errno));
+        }
+        close(fd_);
+        fd_ = -1;
+        std::filesystem::rename(temp_filename_, filename_);
+        finished_ = true;
+        return file_size;
+    }
+
+    uint64_t entry_count() const
+    {
+        return entry_count_;
+    }
+};
+
+// Each thread gets a fixed shard so hot counters are not shared between cores
+constexpr size_t METRICS_SHARD_COUNT = 16;
+
+inline size_t metrics_shard_index()
+{
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARD_COUNT;
+    return shard;
+}
+
+// Merged view of a LatencyHistogram, values are in nanoseconds
+struct HistogramSnapshot
+{
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    double mean() const
+    {
+        return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+    }
+
+    // Returns the upper bound of the bucket containing the requested percentile
+    uint64_t percentile(double p) const;
+
+    void write_json(std::ostream &os) const
+    {
+        os << "{\"count\": " << count
+           << ", \"mean_ns\": " << mean()
+           << ", \"p50_ns\": " << percentile(50.0)
+           << ", \"p90_ns\": " << percentile(90.0)
+           << ", \"p99_ns\": " << percentile(99.0)
+           << ", \"p999_ns\": " << percentile(99.9)
+           << ", \"max_ns\": " << max << "}";
+    }
+};
+
+// HDR-style log-linear histogram: values below 16 get exact buckets, above that every
+// power of two is split into 16 linear sub-buckets (~6% relative error).
+// Recording is a few relaxed atomic increments on the calling thread's shard.
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    static size_t bucket_index(uint64_t value)
+    {
+        if (value < SUB_BUCKETS)
+        {
+            return value;
+        }
+        const unsigned exponent = static_cast<unsigned>(std::bit_width(value)) - 1;
+        const unsigned shift = exponent - SUB_BUCKET_BITS;
+        const uint64_t sub_bucket = (value >> shift) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + shift * SUB_BUCKETS + sub_bucket;
+    }
+
+    static uint64_t bucket_upper_bound(size_t index)
+    {
+        if (index < SUB_BUCKETS)
+        {
+            return index;
+        }
+        const uint64_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        const uint64_t sub_bucket = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub_bucket + 1) << shift) - 1;
+    }
+
+    void record(uint64_t value)
+    {
+        Shard &shard = shards_[metrics_shard_index()];
+        shard.buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t current_max = shard.max.load(std::memory_order_relaxed);
+        while (value > current_max && !shard.max.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    HistogramSnapshot snapshot() const
+    {
+        HistogramSnapshot result;
+        result.buckets.assign(BUCKET_COUNT, 0);
+        for (const Shard &shard : shards_)
+        {
+            for (size_t i = 0; i < BUCKET_COUNT; ++i)
+            {
+                result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+            result.count += shard.count.load(std::memory_order_relaxed);
+            result.sum += shard.sum.load(std::memory_order_relaxed);
+            result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+        }
+        return result;
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    std::array<Shard, METRICS_SHARD_COUNT> shards_;
+};
+
+inline uint64_t HistogramSnapshot::percentile(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const auto target = static_cast<uint64_t>(std::ceil(static_cast<double>(count) * p / 100.0));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i)
+    {
+        seen += buckets[i];
+        if (seen >= target && buckets[i] > 0)
+        {
+            return std::min(LatencyHistogram::bucket_upper_bound(i), max);
+        }
+    }
+    return max;
+}
+
+// Measures the lifetime of the scope into a histogram
+class ScopedLatency
+{
+private:
+    LatencyHistogram &histogram_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit ScopedLatency(LatencyHistogram &histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedLatency()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedLatency(const ScopedLatency &) = delete;
+    ScopedLatency &operator=(const ScopedLatency &) = delete;
+};
+
+// Where a get found its answer
+enum class GetSource
+{
+    memtable,
+    immutable_memtable,
+    sstable,
+    missing,
+};
+
+// What one get touched on its way down the tree
+struct GetTrace
+{
+    GetSource source = GetSource::missing;
+    int level = 0;               // Of the SSTable that answered
+    uint32_t tables_checked = 0; // Key range and Bloom filter consulted
+    uint32_t filter_rejects = 0;
+    uint32_t index_searches = 0; // Tables whose index was searched for the key
+    uint32_t blocks_read = 0;
+};
+
+// Merged get path counters
+struct GetPathStats
+{
+    static constexpr size_t LEVELS = 4;    // Hits in deeper levels are counted in the last one
+    static constexpr size_t MAX_DEPTH = 8; // Gets checking more tables share the last bucket
+
+    uint64_t memtable_hits = 0;
+    uint64_t immutable_memtable_hits = 0;
+    std::array<uint64_t, LEVELS> level_hits{};
+    uint64_t misses = 0;
+    uint64_t tables_checked = 0;
+    uint64_t filter_rejects = 0;
+    uint64_t index_searches = 0;
+    uint64_t blocks_read = 0;
+    std::array<uint64_t, MAX_DEPTH + 1> depth{}; // Gets by number of tables checked
+
+    uint64_t gets() const
+    {
+        uint64_t total = memtable_hits + immutable_memtable_hits + misses;
+        for (const auto hits : level_hits)
+        {
+            total += hits;
+        }
+        return total;
+    }
+
+    // Counts accumulated since an earlier snapshot
+    GetPathStats since(const GetPathStats &earlier) const
+    {
+        GetPathStats delta = *this;
+        delta.memtable_hits -= earlier.memtable_hits;
+        delta.immutable_memtable_hits -= earlier.immutable_memtable_hits;
+        for (size_t i = 0; i < LEVELS; ++i)
+        {
+            delta.level_hits[i] -= earlier.level_hits[i];
+        }
+        delta.misses -= earlier.misses;
+        delta.tables_checked -= earlier.tables_checked;
+        delta.filter_rejects -= earlier.filter_rejects;
+        delta.index_searches -= earlier.index_searches;
+        delta.blocks_read -= earlier.blocks_read;
+        for (size_t i = 0; i <= MAX_DEPTH; ++i)
+        {
+            delta.depth[i] -= earlier.depth[i];
+        }
+        return delta;
+    }
+
+    void print(std::ostream &os) const
+    {
+        const double total = static_cast<double>(gets());
+        if (total == 0.0)
+        {
+            return;
+        }
+        auto percent = [&](uint64_t count)
+        {
+            return static_cast<double>(count) * 100.0 / total;
+        };
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        os << std::fixed << std::setprecision(2);
+        os << "  Get paths: memtable " << percent(memtable_hits) << "%, immutable memtable "
+           << percent(immutable_memtable_hits) << "%";
+        for (size_t i = 0; i < LEVELS; ++i)
+        {
+            if (level_hits[i] > 0)
+            {
+                os << ", L" << i << (i + 1 == LEVELS ? "+ " : " ") << percent(level_hits[i]) << "%";
+            }
+        }
+        os << ", not found " << percent(misses) << "%\n";
+        os << "  Per get: " << static_cast<double>(tables_checked) / total << " tables checked, "
+           << static_cast<double>(filter_rejects) / total << " filter rejects, "
+           << static_cast<double>(index_searches) / total << " index searches, "
+           << static_cast<double>(blocks_read) / total << " blocks read\n";
+        os << "  Tables checked per get:";
+        for (size_t i = 0; i <= MAX_DEPTH; ++i)
+        {
+            if (depth[i] > 0)
+            {
+                os << " " << i << (i == MAX_DEPTH ? "+" : "") << ": " << percent(depth[i]) << "%";
+            }
+        }
+        os << "\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void write_json(std::ostream &os) const
+    {
+        os << "{\"memtable_hits\": " << memtable_hits
+           << ", \"immutable_memtable_hits\": " << immutable_memtable_hits
+           << ", \"level_hits\": [";
+        for (size_t i = 0; i < LEVELS; ++i)
+        {
+            os << (i == 0 ? "" : ", ") << level_hits[i];
+        }
+        os << "], \"misses\": " << misses
+           << ", \"tables_checked\": " << tables_checked
+           << ", \"filter_rejects\": " << filter_rejects
+           << ", \"index_searches\": " << index_searches
+           << ", \"blocks_read\": " << blocks_read
+           << ", \"tables_checked_histogram\": [";
+        for (size_t i = 0; i <= MAX_DEPTH; ++i)
+        {
+            os << (i == 0 ? "" : ", ") << depth[i];
+        }
+        os << "]}";
+    }
+};
+
+// Get path counters on per-thread shards like LatencyHistogram, one relaxed add per field and get
+class GetPathCounters
+{
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> memtable_hits{0};
+        std::atomic<uint64_t> immutable_memtable_hits{0};
+        std::array<std::atomic<uint64_t>, GetPathStats::LEVELS> level_hits{};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> tables_checked{0};
+        std::atomic<uint64_t> filter_rejects{0};
+        std::atomic<uint64_t> index_searches{0};
+        std::atomic<uint64_t> blocks_read{0};
+        std::array<std::atomic<uint64_t>, GetPathStats::MAX_DEPTH + 1> depth{};
+    };
+
+    std::array<Shard, METRICS_SHARD_COUNT> shards_;
+
+public:
+    void record(const GetTrace &trace)
+    {
+        Shard &shard = shards_[metrics_shard_index()];
+        switch (trace.source)
+        {
+        case GetSource::memtable:
+            shard.memtable_hits.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case GetSource::immutable_memtable:
+            shard.immutable_memtable_hits.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case GetSource::sstable:
+            shard.level_hits[std::min(static_cast<size_t>(trace.level), GetPathStats::LEVELS - 1)].fetch_add(1, std::memory_order_relaxed);
+            break;
+        case GetSource::missing:
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        if (trace.tables_checked > 0)
+        {
+            shard.tables_checked.fetch_add(trace.tables_checked, std::memory_order_relaxed);
+            shard.filter_rejects.fetch_add(trace.filter_rejects, std::memory_order_relaxed);
+            shard.index_searches.fetch_add(trace.index_searches, std::memory_order_relaxed);
+            shard.blocks_read.fetch_add(trace.blocks_read, std::memory_order_relaxed);
+        }
+        shard.depth[std::min<size_t>(trace.tables_checked, GetPathStats::MAX_DEPTH)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    GetPathStats snapshot() const
+    {
+        GetPathStats result;
+        for (const Shard &shard : shards_)
+        {
+            result.memtable_hits += shard.memtable_hits.load(std::memory_order_relaxed);
+            result.immutable_memtable_hits += shard.immutable_memtable_hits.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < GetPathStats::LEVELS; ++i)
+            {
+                result.level_hits[i] += shard.level_hits[i].load(std::memory_order_relaxed);
+            }
+            result.misses += shard.misses.load(std::memory_order_relaxed);
+            result.tables_checked += shard.tables_checked.load(std::memory_order_relaxed);
+            result.filter_rejects += shard.filter_rejects.load(std::memory_order_relaxed);
+            result.index_searches += shard.index_searches.load(std::memory_order_relaxed);
+            result.blocks_read += shard.blocks_read.load(std::memory_order_relaxed);
+            for (size_t i = 0; i <= GetPathStats::MAX_DEPTH; ++i)
+            {
+                result.depth[i] += shard.depth[i].load(std::memory_order_relaxed);
+            }
+        }
+        return result;
+    }
+};
+
+// Live counters owned by an LSMTree, all updates are relaxed
+struct LSMCounters
+{
+    std::atomic<uint64_t> puts{0};
+    std::atomic<uint64_t> gets{0};
+    std::atomic<uint64_t> user_bytes_written{0};
+    std::atomic<uint64_t> flush_count{0};
+    std::atomic<uint64_t> flush_bytes_written{0};
+    std::atomic<uint64_t> compaction_count{0};
+    std::atomic<uint64_t> subcompaction_count{0};
+    std::atomic<uint64_t> compaction_bytes_read{0};
+    std::atomic<uint64_t> compaction_bytes_written{0};
+    std::atomic<uint64_t> compaction_entries_dropped{0}; // By the compaction filter
+    std::atomic<uint64_t> compaction_entries_changed{0};
+    std::atomic<uint64_t> sstable_probes{0};
+    std::atomic<uint64_t> filter_checks{0};
+    std::atomic<uint64_t> filter_rejects{0};
+    std::atomic<uint64_t> memtable_allocations{0}; // Of flushed memtables
+
+    LatencyHistogram get_latency;
+    LatencyHistogram put_latency;
+    LatencyHistogram compaction_duration;
+#if LSM_GET_PATH_STATS
+    GetPathCounters get_paths;
+#endif
+
+    static void add(std::atomic<uint64_t> &counter, uint64_t value = 1)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+};
+
+struct LevelStats
+{
+    int level = 0;
+    size_t file_count = 0;
+    uint64_t bytes = 0;
+    uint64_t entries = 0;
+};
+
+// Point-in-time copy of the LSM tree metrics
+struct LSMStats
+{
+    uint64_t puts = 0;
+    uint64_t gets = 0;
+    uint64_t user_bytes_written = 0;
+    uint64_t flush_count = 0;
+    uint64_t flush_bytes_written = 0;
+    uint64_t compaction_count = 0;
+    uint64_t subcompaction_count = 0;
+    uint64_t compaction_bytes_read = 0;
+    uint64_t compaction_bytes_written = 0;
+    uint64_t compaction_entries_dropped = 0;
+    uint64_t compaction_entries_changed = 0;
+    uint64_t sstable_probes = 0;
+    uint64_t filter_checks = 0;
+    uint64_t filter_rejects = 0;
+    uint64_t cache_hits = 0; // Block cache, counted for every tree sharing it
+    uint64_t cache_misses = 0;
+    size_t block_cache_usage = 0;
+    size_t block_cache_capacity = 0;
+    uint64_t rate_limit_bytes_per_second = 0; // 0 without a rate limiter
+    uint64_t rate_limited_flush_bytes = 0;
+    uint64_t rate_limited_compaction_bytes = 0;
+    uint64_t rate_limit_wait_ns = 0;
+    size_t memtable_bytes = 0;
+    size_t memtable_entries = 0; // Active and immutable memtables
+    size_t memtable_threshold = 0;
+    uint64_t memtable_allocations = 0;
+    size_t cold_file_count = 0; // Tables in the cold tier, also counted in their level
+    uint64_t cold_bytes = 0;
+    std::vector<LevelStats> levels;
+    HistogramSnapshot get_latency;
+    HistogramSnapshot put_latency;
+    HistogramSnapshot compaction_duration;
+    GetPathStats get_paths; // Empty when built without LSM_GET_PATH_STATS
+
+    uint64_t total_sstable_bytes() const
+    {
+        uint64_t total = 0;
+        for (const auto &level : levels)
+        {
+            total += level.bytes;
+        }
+        return total;
+    }
+
+    // Bytes written to SSTables per byte of user data
+    double write_amplification() const
+    {
+        if (user_bytes_written == 0)
+        {
+            return 0.0;
+        }
+        return static_cast<double>(flush_bytes_written + compaction_bytes_written) / static_cast<double>(user_bytes_written);
+    }
+
+    // SSTables actually searched per get
+    double read_amplification() const
+    {
+        return gets > 0 ? static_cast<double>(sstable_probes) / static_cast<double>(gets) : 0.0;
+    }
+
+    // Total SSTable bytes relative to the bottom level, which holds the fully merged data
+    double space_amplification() const
+    {
+        for (const auto &level : std::views::reverse(levels))
+        {
+            if (level.bytes > 0)
+            {
+                return static_cast<double>(total_sstable_bytes()) / static_cast<double>(level.bytes);
+            }
+        }
+        return 0.0;
+    }
+
+    double filter_reject_rate() const
+    {
+        return filter_checks > 0 ? static_cast<double>(filter_rejects) / static_cast<double>(filter_checks) : 0.0;
+    }
+
+    double cache_hit_rate() const
+    {
+        const uint64_t lookups = cache_hits + cache_misses;
+        return lookups > 0 ? static_cast<double>(cache_hits) / static_cast<double>(lookups) : 0.0;
+    }
+
+    void print(std::ostream &os) const
+    {
+        os << std::fixed << std::setprecision(2);
+        os << "  Puts: " << puts << ", gets: " << gets << "\n";
+        os << "  Bytes written: user " << user_bytes_written << ", flush " << flush_bytes_written
+           << " (" << flush_count << " flushes), compaction " << compaction_bytes_written
+           << " (" << compaction_count << " compactions, " << subcompaction_count << " subcompactions)\n";
+        if (compaction_entries_dropped + compaction_entries_changed > 0)
+        {
+            os << "  Compaction filter: dropped " << compaction_entries_dropped << " entries ("
+               << (compaction_count > 0 ? static_cast<double>(compaction_entries_dropped) / static_cast<double>(compaction_count) : 0.0)
+               << " per compaction), changed " << compaction_entries_changed << "\n";
+        }
+        os << "  Amplification: write " << write_amplification() << ", read " << read_amplification()
+           << ", space " << space_amplification() << "\n";
+        os << "  Filter reject rate: " << filter_reject_rate() * 100.0 << "% of " << filter_checks
+           << " checks, cache hit rate: " << cache_hit_rate() * 100.0 << "%\n";
+        os << "  Block cache: " << block_cache_usage << " of " << block_cache_capacity << " bytes, "
+           << cache_hits << " hits, " << cache_misses << " misses\n";
+        os << "  MemTable: " << memtable_bytes << " bytes in " << memtable_entries << " entries ("
+           << (memtable_entries > 0 ? static_cast<double>(memtable_bytes) / static_cast<double>(memtable_entries) : 0.0)
+           << " per entry)\n";
+        os << "  MemTable allocations: " << memtable_allocations << " ("
+           << (puts > 0 ? static_cast<double>(memtable_allocations) / static_cast<double>(puts) : 0.0) << " per put)\n";
+        if (rate_limit_bytes_per_second > 0)
+        {
+            os << "  Rate limit: " << static_cast<double>(rate_limit_bytes_per_second) / (1024.0 * 1024.0)
+               << " MB/s, granted flush " << rate_limited_flush_bytes << " / compaction " << rate_limited_compaction_bytes
+               << " bytes, waited " << static_cast<double>(rate_limit_wait_ns) / 1e6 << " ms\n";
+        }
+        for (const auto &level : levels)
+        {
+            os << "  Level " << level.level << ": " << level.file_count << " files, "
+               << level.bytes << " bytes, " << level.entries << " entries\n";
+        }
+        if (cold_file_count > 0)
+        {
+            os << "  Cold tier: " << cold_file_count << " files, " << cold_bytes << " bytes\n";
+        }
+        get_paths.print(os);
+        if (get_latency.count > 0)
+        {
+            os << "  Get latency ns: p50 " << get_latency.percentile(50.0) << ", p99 " << get_latency.percentile(99.0)
+               << ", max " << get_latency.max << "\n";
+        }
+        if (put_latency.count > 0)
+        {
+            os << "  Put latency ns: p50 " << put_latency.percentile(50.0) << ", p99 " << put_latency.percentile(99.0)
+               << ", max " << put_latency.max << "\n";
+        }
+        if (compaction_duration.count > 0)
+        {
+            os << "  Compaction duration ms: mean " << compaction_duration.mean() / 1e6
+               << ", max " << static_cast<double>(compaction_duration.max) / 1e6 << "\n";
+        }
+        os << std::defaultfloat;
+    }
+
+    void write_json(std::ostream &os) const
+    {
+        os << "{\n";
+        os << "  \"puts\": " << puts << ",\n";
+        os << "  \"gets\": " << gets << ",\n";
+        os << "  \"memtable_bytes\": " << memtable_bytes << ",\n";
+        os << "  \"memtable_entries\": " << memtable_entries << ",\n";
+        os << "  \"memtable_threshold\": " << memtable_threshold << ",\n";
+        os << "  \"memtable_allocations\": " << memtable_allocations << ",\n";
+        os << "  \"user_bytes_written\": " << user_bytes_written << ",\n";
+        os << "  \"flush_count\": " << flush_count << ",\n";
+        os << "  \"flush_bytes_written\": " << flush_bytes_written << ",\n";
+        os << "  \"compaction_count\": " << compaction_count << ",\n";
+        os << "  \"subcompaction_count\": " << subcompaction_count << ",\n";
+        os << "  \"compaction_bytes_read\": " << compaction_bytes_read << ",\n";
+        os << "  \"compaction_bytes_written\": " << compaction_bytes_written << ",\n";
+        os << "  \"compaction_entries_dropped\": " << compaction_entries_dropped << ",\n";
+        os << "  \"compaction_entries_changed\": " << compaction_entries_changed << ",\n";
+        os << "  \"write_amplification\": " << write_amplification() << ",\n";
+        os << "  \"read_amplification\": " << read_amplification() << ",\n";
+        os << "  \"space_amplification\": " << space_amplification() << ",\n";
+        os << "  \"filter_checks\": " << filter_checks << ",\n";
+        os << "  \"filter_rejects\": " << filter_rejects << ",\n";
+        os << "  \"cache_hits\": " << cache_hits << ",\n";
+        os << "  \"cache_misses\": " << cache_misses << ",\n";
+        os << "  \"block_cache_usage\": " << block_cache_usage << ",\n";
+        os << "  \"block_cache_capacity\": " << block_cache_capacity << ",\n";
+        os << "  \"rate_limit_bytes_per_second\": " << rate_limit_bytes_per_second << ",\n";
+        os << "  \"rate_limited_flush_bytes\": " << rate_limited_flush_bytes << ",\n";
+        os << "  \"rate_limited_compaction_bytes\": " << rate_limited_compaction_bytes << ",\n";
+        os << "  \"rate_limit_wait_ns\": " << rate_limit_wait_ns << ",\n";
+        os << "  \"cold_files\": " << cold_file_count << ",\n";
+        os << "  \"cold_bytes\": " << cold_bytes << ",\n";
+        os << "  \"levels\": [";
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            os << (i == 0 ? "" : ", ")
+               << "{\"level\": " << levels[i].level
+               << ", \"files\": " << levels[i].file_count
+               << ", \"bytes\": " << levels[i].bytes
+               << ", \"entries\": " << levels[i].entries << "}";
+        }
+        os << "],\n";
+        os << "  \"get_paths\": ";
+        get_paths.write_json(os);
+        os << ",\n  \"get_latency\": ";
+        get_latency.write_json(os);
+        os << ",\n  \"put_latency\": ";
+        put_latency.write_json(os);
+        os << ",\n  \"compaction_duration\": ";
+        compaction_duration.write_json(os);
+        os << "\n}\n";
+    }
+};
+
+inline auto as_transient = []<typename T>(const T &str) -> T
+{
+    if constexpr (std::is_same_v<T, gs::german_string>)
+    {
+        return str.as_transient();
+    }
+    else
+    {
+        return str;
+    }
+};
+
+// Copy that owns its bytes, for strings that must outlive the buffer they point into
+inline auto as_owned = []<typename T>(const T &str) -> T
+{
+    if constexpr (std::is_same_v<T, gs::german_string>)
+    {
+        return str.copy_to_temporary();
+    }
+    else
+    {
+        return str;
+    }
+};
+
+// Forward cursor over a sorted run of key/value entries
+template <typename StringType>
+class EntryCursor
+{
+public:
+    virtual ~EntryCursor() = default;
+    virtual bool valid() const = 0;
+    virtual const StringType &key() const = 0;
+    virtual const StringType &value() const = 0;
+    virtual void next() = 0;
+};
+
+// Cursor over an iterator range of pairs, used for MemTable and SSTable data
+template <typename StringType, typename Iterator>
+class RangeCursor : public EntryCursor<StringType>
+{
+private:
+    Iterator it_;
+    Iterator end_;
+
+public:
+    RangeCursor(Iterator begin, Iterator end)
+        : it_(begin), end_(end)
+    {
+    }
+
+    bool valid() const override { return it_ != end_; }
+    const StringType &key() const override { return it_->first; }
+    const StringType &value() const override { return it_->second; }
+    void next() override { ++it_; }
+};
+
+// Merges sorted runs into one sorted stream. Children are ordered newest first and
+// when several runs contain the same key only the newest entry is returned.
+template <typename StringType>
+class MergingCursor : public EntryCursor<StringType>
+{
+private:
+    std::vector<std::unique_ptr<EntryCursor<StringType>>> children_;
+    std::vector<size_t> heap_;
+
+    // Heap ordering: smallest key on top, newest child first among equal keys
+    bool heap_after(size_t a, size_t b) const
+    {
+        const auto &key_a = children_[a]->key();
+        const auto &key_b = children_[b]->key();
+        if (key_b < key_a)
+        {
+            return true;
+        }
+        if (key_a < key_b)
+        {
+            return false;
+        }
+        return a > b;
+    }
+
+    void push(size_t index)
+    {
+        heap_.push_back(index);
+        std::push_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return heap_after(a, b); });
+    }
+
+    size_t pop()
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return heap_after(a, b); });
+        size_t index = heap_.back();
+        heap_.pop_back();
+        return index;
+    }
+
+public:
+    explicit MergingCursor(std::vector<std::unique_ptr<EntryCursor<StringType>>> children)
+        : children_(std::move(children))
+    {
+        for (size_t i = 0; i < children_.size(); ++i)
+        {
+            if (children_[i]->valid())
+            {
+                push(i);
+            }
+        }
+    }
+
+    bool valid() const override { return !heap_.empty(); }
+    const StringType &key() const override { return children_[heap_.front()]->key(); }
+    const StringType &value() const override { return children_[heap_.front()]->value(); }
+
+    // Index of the child the current entry comes from
+    size_t source() const { return heap_.front(); }
+
+    void next() override
+    {
+        size_t top = pop();
+        // Skip the older versions of the current key before moving the newest one forward
+        while (!heap_.empty() && !(children_[top]->key() < children_[heap_.front()]->key()))
+        {
+            size_t shadowed = pop();
+            children_[shadowed]->next();
+            if (children_[shadowed]->valid())
+            {
+                push(shadowed);
+            }
+        }
+        children_[top]->next();
+        if (children_[top]->valid())
+        {
+            push(top);
+        }
+    }
+};
+
+// Bump allocator owning every memtable key, value and map node. Nothing is
+// freed individually, the whole arena goes away with its flushed memtable.
+class MemTableArena : public std::pmr::memory_resource
+{
+private:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char *ptr_ = nullptr;
+    size_t remaining_ = 0;
+    size_t allocated_bytes_ = 0;
+    size_t used_bytes_ = 0;
+
+public:
+    MemTableArena() = default;
+    MemTableArena(const MemTableArena &) = delete;
+    MemTableArena &operator=(const MemTableArena &) = delete;
+
+    std::string_view copy(std::string_view bytes)
+    {
+        char *dst = static_cast<char *>(allocate(bytes.size(), 1));
+        std::memcpy(dst, bytes.data(), bytes.size());
+        return {dst, bytes.size()};
+    }
+
+    // Bytes handed out, including alignment padding
+    size_t used_bytes() const
+    {
+        return used_bytes_;
+    }
+
+    // Bytes reserved from the heap
+    size_t allocated_bytes() const
+    {
+        return allocated_bytes_;
+    }
+
+    size_t chunk_count() const
+    {
+        return chunks_.size();
+    }
+
+private:
+    char *new_chunk(size_t bytes)
+    {
+        chunks_.push_back(std::make_unique_for_overwrite<char[]>(bytes));
+        allocated_bytes_ += bytes;
+        return chunks_.back().get();
+    }
+
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        size_t padding = (alignment - reinterpret_cast<uintptr_t>(ptr_) % alignment) % alignment;
+        if (padding + bytes > remaining_)
+        {
+            // Large requests get a chunk of their own so the current one keeps its tail
+            if (bytes > CHUNK_SIZE / 4)
+            {
+                used_bytes_ += bytes;
+                return new_chunk(bytes);
+            }
+            ptr_ = new_chunk(CHUNK_SIZE);
+            remaining_ = CHUNK_SIZE;
+            padding = 0;
+        }
+        char *result = ptr_ + padding;
+        ptr_ = result + bytes;
+        remaining_ -= padding + bytes;
+        used_bytes_ += padding + bytes;
+        return result;
+    }
+
+    void do_deallocate(void *, size_t, size_t) override
+    {
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+// MemTable: In-memory sorted storage. Map nodes live in the arena; german string
+// keys and values are copied into it once and stored as persistent strings.
+// std::string keeps its own heap buffers, which are accounted separately.
+template <typename StringType>
+class MemTable
+{
+public:
+    using Map = std::pmr::map<StringType, StringType>;
+
+private:
+    std::unique_ptr<MemTableArena> arena_; // Must outlive data_
+    Map data_;
+    size_t size_threshold_;
+    size_t heap_bytes_;
+    uint64_t heap_allocations_;
+
+public:
+    explicit MemTable(size_t threshold = 8 * 1024 * 1024)
+        : arena_(std::make_unique<MemTableArena>()), data_(arena_.get()), size_threshold_(threshold),
+          heap_bytes_(0), heap_allocations_(0)
+    {
+    }
+
+    // Strings reference the arena, so the table stays put
+    MemTable(const MemTable &) = delete;
+    MemTable &operator=(const MemTable &) = delete;
+
+public:
+    void put(StringType &&key, StringType &&value)
+    {
+        auto it = data_.lower_bound(key);
+        put_at(it, std::move(key), std::move(value));
+    }
+
+    // Inserts entries sorted by key, a later duplicate overwrites the earlier one. Each key is
+    // looked for right after the previous one, so a sorted run only descends the tree where other
+    // memtable keys fall in between.
+    template <typename Entries>
+    void put_sorted(const Entries &entries)
+    {
+        auto it = data_.end();
+        bool positioned = false;
+        for (const auto &[key_bytes, value_bytes] : entries)
+        {
+            StringType key = make_view(key_bytes);
+            if (positioned && it != data_.end() && it->first < key)
+            {
+                ++it;
+            }
+            if (!positioned || (it != data_.end() && it->first < key))
+            {
+                it = data_.lower_bound(key);
+                positioned = true;
+            }
+            it = put_at(it, std::move(key), make_view(value_bytes));
+        }
+    }
+
+private:
+    // it is the first entry not less than key
+    typename Map::iterator put_at(typename Map::iterator it, StringType &&key, StringType &&value)
+    {
+        if (it != data_.end() && !data_.key_comp()(key, it->first))
+        {
+            release(it->second);
+            it->second = store(std::move(value));
+            return it;
+        }
+        return data_.emplace_hint(it, store(std::move(key)), store(std::move(value)));
+    }
+
+    // Batch bytes are only borrowed until store() copies them
+    static StringType make_view(std::string_view bytes)
+    {
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            return StringType(bytes);
+        }
+        else
+        {
+            return StringType(bytes.data(), static_cast<typename StringType::size_type>(bytes.size()), gs::string_class::transient);
+        }
+    }
+
+    // Takes ownership of a string for the lifetime of the table
+    StringType store(StringType &&str)
+    {
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            static const size_t inline_capacity = std::string().capacity();
+            if (str.capacity() > inline_capacity)
+            {
+                heap_bytes_ += str.capacity() + 1;
+                ++heap_allocations_;
+            }
+            return std::move(str);
+        }
+        else
+        {
+            if (str.size() <= StringType::SMALL_STRING_SIZE)
+            {
+                return StringType(str.data(), str.size(), gs::string_class::persistent);
+            }
+            const std::string_view bytes = arena_->copy(std::string_view(str.data(), str.size()));
+            return StringType(bytes.data(), str.size(), gs::string_class::persistent);
+        }
+    }
+
+    // Overwritten german strings stay in the arena until the table is dropped
+    void release(const StringType &str)
+    {
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            static const size_t inline_capacity = std::string().capacity();
+            if (str.capacity() > inline_capacity)
+            {
+                heap_bytes_ -= str.capacity() + 1;
+            }
+        }
+    }
+
+public:
+
+    std::optional<StringType> get(const StringType &key) const
+    {
+        auto it = data_.find(key);
+        if (it != data_.end())
+        {
+            return as_transient(it->second);
+        }
+        return std::nullopt;
+    }
+
+    bool is_full() const
+    {
+        return size() >= size_threshold_;
+    }
+
+    bool empty() const
+    {
+        return data_.empty();
+    }
+
+    // Exact bytes in use: arena allocations plus out-of-line std::string buffers
+    size_t size() const
+    {
+        return arena_->used_bytes() + heap_bytes_;
+    }
+
+    size_t threshold() const
+    {
+        return size_threshold_;
+    }
+
+    // Heap allocations made on behalf of this table
+    uint64_t allocations() const
+    {
+        return arena_->chunk_count() + heap_allocations_;
+    }
+
+    size_t entry_count() const
+    {
+        return data_.size();
+    }
+
+    std::unique_ptr<EntryCursor<StringType>> cursor(const StringType &start) const
+    {
+        using Iterator = typename Map::const_iterator;
+        return std::make_unique<RangeCursor<StringType, Iterator>>(data_.lower_bound(start), data_.end());
+    }
+
+    // Get all data for flushing to SSTable
+    const Map &get_all_data() const
+    {
+        return data_;
+    }
+};
+
+// One index entry per data block of a block based SSTable
+template <typename StringType>
+struct SSTableIndexEntry
+{
+    StringType last_key;
+    uint64_t offset = 0;
+    uint32_t size = 0;
+    uint32_t entries = 0;
+};
+
+// Top level index entry for one index and filter partition, pinned while the table is open. The
+// partition's last key is kept apart in SSTable::partition_keys_.
+struct SSTablePartition
+{
+    uint64_t index_offset = 0;
+    uint32_t index_size = 0;
+    uint64_t filter_offset = 0;
+    uint32_t filter_size = 0;
+    size_t first_block = 0; // Table wide number of the partition's first data block
+    uint32_t block_count = 0;
+};
+
+// Decoded block index of one partition, the unit the block cache holds
+template <typename StringType>
+struct IndexPartition
+{
+    std::vector<SSTableIndexEntry<StringType>> blocks;
+    size_t first_block = 0;
+    size_t charge = 0; // Approximate decoded bytes
+    std::string bytes; // Raw index the keys point into, for tables that are not mapped
+};
+
+// How an SSTable reads its file
+enum class TableAccess
+{
+    mapped, // Zero copy through a mapping, blocks checksummed once
+    pread,  // Copied out with pread, blocks checksummed on every read
+};
+
+// Bytes last read from a pread table, reused while later reads fall inside them
+struct ReadBuffer
+{
+    std::string data;
+    uint64_t offset = 0;
+
+    bool covers(uint64_t start, size_t size) const
+    {
+        return start >= offset && start + size <= offset + data.size();
+    }
+};
+
+// Filter bits of one partition, with the cache entry that owns them when they were copied
+struct FilterHandle
+{
+    std::span<const char> bits;
+    std::shared_ptr<const std::string> owner;
+};
+
+// Views mapped bytes as a string, german strings reference the mapping instead of copying
+template <typename StringType>
+StringType make_mapped_string(std::string_view bytes)
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return StringType(bytes);
+    }
+    else
+    {
+        return StringType(bytes.data(), static_cast<typename StringType::size_type>(bytes.size()), gs::string_class::transient);
+    }
+}
+
+// Builds an owning string from arbitrary bytes
+template <typename StringType>
+StringType make_owned_string(std::string_view str)
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return std::string(str);
+    }
+    else
+    {
+        return StringType(str.data(), gs::detail::_checked_size_cast(str.size()), gs::string_class::temporary);
+    }
+}
+
+// Builds a lookup key without copying for german strings, the source must outlive the result
+template <typename StringType>
+StringType make_query_key(std::string_view str)
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return std::string(str);
+    }
+    else
+    {
+        return StringType(str.data(), gs::detail::_checked_size_cast(str.size()), gs::string_class::transient);
+    }
+}
+
+template <typename StringType>
+class SSTable;
+
+// Decodes the records of a block based SSTable block by block, loading index partitions as it
+// crosses them. Front coded keys are rebuilt in the reader, so a german string key only stays
+// valid until the cursor moves on, and so do values of tables read with pread.
+template <typename StringType>
+class BlockCursor : public EntryCursor<StringType>
+{
+private:
+    const SSTable<StringType> &table_;
+    size_t partition_;
+    std::shared_ptr<const IndexPartition<StringType>> index_;
+    size_t block_;
+    BlockReader reader_;
+    ReadBuffer buffer_; // Read ahead of the current block on pread tables
+    size_t readahead_;  // Doubles with every block read, so short seeks do not pay for a long scan
+    StringType key_;
+    StringType value_;
+    bool valid_;
+
+    static constexpr size_t INITIAL_READAHEAD = 16 * 1024;
+
+    void open_block()
+    {
+        reader_.reset(table_.read_block(*index_, block_, buffer_, readahead_));
+        readahead_ = std::min(std::max(readahead_ * 2, INITIAL_READAHEAD), table_.readahead_bytes_);
+    }
+
+    void set_current()
+    {
+        key_ = make_mapped_string<StringType>(reader_.key());
+        value_ = make_mapped_string<StringType>(reader_.value());
+        valid_ = true;
+    }
+
+    void read_next()
+    {
+        while (!reader_.next())
+        {
+            if (++block_ >= index_->blocks.size())
+            {
+                if (++partition_ >= table_.partitions_.size())
+                {
+                    valid_ = false;
+                    return;
+                }
+                index_ = table_.load_partition(partition_);
+                block_ = 0;
+            }
+            open_block();
+        }
+        set_current();
+    }
+
+public:
+    // Positions on the first entry >= start
+    BlockCursor(const SSTable<StringType> &table, const StringType &start)
+        : table_(table), partition_(table.find_partition(start)), block_(0), readahead_(0), valid_(false)
+    {
+        if (partition_ >= table_.partitions_.size())
+        {
+            return;
+        }
+        index_ = table_.load_partition(partition_);
+        block_ = SSTable<StringType>::find_block(*index_, start);
+        if (block_ >= index_->blocks.size())
+        {
+            return;
+        }
+        open_block();
+        if (reader_.seek(std::string_view(start.data(), start.size())))
+        {
+            set_current();
+        }
+        else
+        {
+            read_next();
+        }
+    }
+
+    bool valid() const override { return valid_; }
+    const StringType &key() const override { return key_; }
+    const StringType &value() const override { return value_; }
+    void next() override { read_next(); }
+};
+
+struct SSTableVerifyResult
+{
+    uint64_t blocks = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    bool checksummed = false;
+};
+
+// SSTable: Immutable sorted string table on disk, read through a memory mapping or with pread
+template <typename StringType>
+class SSTable
+{
+private:
+    enum class Format
+    {
+        legacy,      // Parsed into data_cache_ on load
+        block_based, // Read block by block through the index
+    };
+
+    friend class BlockCursor<StringType>;
+
+    std::string filename_;
+    mutable std::vector<std::pair<StringType, StringType>> data_cache_; // Cache for parsed data (sorted by key)
+    mutable std::atomic<bool> cache_loaded_;
+    mutable std::mutex load_mutex_;
+    mutable std::unique_ptr<MappedFile> mapped_file_; // Persistent mapping
+    mutable std::unique_ptr<PreadFile> pread_file_;   // Instead of the mapping for TableAccess::pread
+    mutable std::string legacy_bytes_;                // Backs data_cache_ of legacy tables read with pread
+    mutable Format format_;
+    mutable SSTableFooter footer_;
+    mutable std::vector<SSTablePartition> partitions_;
+    mutable std::vector<StringType> partition_keys_; // Last key of each partition, searched on every lookup
+    mutable std::string top_level_keys_;             // Backs partition_keys_ of partitioned tables
+    // Tables with a single index keep it decoded here, partitioned tables go through cache_
+    mutable std::shared_ptr<const IndexPartition<StringType>> pinned_index_;
+    mutable std::shared_ptr<const std::string> pinned_filter_; // Their filter, when read with pread
+    mutable BlockVerifier blocks_;
+    mutable BlockVerifier filters_; // One "block" per filter partition
+    std::shared_ptr<BlockCache> cache_;
+    mutable uint64_t cache_id_;
+    TableAccess access_;
+    size_t readahead_bytes_; // Read size of cursors over pread tables
+    int level_;
+    uint64_t file_bytes_;
+    std::filesystem::file_time_type modified_;
+
+    // Parse memory-mapped file data into cache
+    void load_cache() const
+    {
+        if (cache_loaded_.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        // Concurrent readers may race to the first load
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        if (cache_loaded_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        try
+        {
+            // Keep the mapping or file open for the lifetime of the table
+            uint64_t file_size;
+            if (access_ == TableAccess::mapped)
+            {
+                mapped_file_ = std::make_unique<MappedFile>(filename_);
+                file_size = mapped_file_->size();
+            }
+            else
+            {
+                pread_file_ = std::make_unique<PreadFile>(filename_);
+                file_size = pread_file_->size();
+            }
+            if (file_size == 0)
+            {
+                cache_loaded_.store(true, std::memory_order_release);
+                return;
+            }
+
+            if (!parse_footer(file_size))
+            {
+                format_ = Format::legacy;
+                parse_data_from_span(read_bytes(0, file_size, legacy_bytes_));
+            }
+            cache_loaded_.store(true, std::memory_order_release);
+        }
+        catch (const SSTableCorruption &)
+        {
+            // Damaged files stay unloaded so every access reports the corruption
+            data_cache_.clear();
+            clear_index();
+            close_file();
+            throw;
+        }
+        catch (const std::exception &e)
+        {
+            // File doesn't exist or can't be read, leave cache empty
+            // Reset the mapped file pointer on error
+            clear_index();
+            close_file();
+            cache_loaded_.store(true, std::memory_order_release);
+        }
+    }
+
+    void clear_index() const
+    {
+        partitions_.clear();
+        partition_keys_.clear();
+        pinned_index_.reset();
+        pinned_filter_.reset();
+    }
+
+    void close_file() const
+    {
+        mapped_file_.reset();
+        pread_file_.reset();
+        legacy_bytes_.clear();
+    }
+
+    // Bytes [offset, offset + size) of the file, viewed in the mapping or read into buffer
+    std::span<const char> read_bytes(uint64_t offset, size_t size, std::string &buffer) const
+    {
+        if (access_ == TableAccess::mapped)
+        {
+            return mapped_file_->data().subspan(offset, size);
+        }
+        pread_file_->read(offset, size, buffer);
+        return buffer;
+    }
+
+    // Reads, checks and decodes the index stored at offset. Keys of pread tables point into the
+    // partition's own copy of the bytes.
+    std::shared_ptr<IndexPartition<StringType>> read_index(uint64_t offset, uint32_t size, size_t first_block,
+                                                            uint64_t data_end, const std::string &what) const
+    {
+        auto partition = std::make_shared<IndexPartition<StringType>>();
+        const auto bytes = read_bytes(offset, size + BLOCK_CHECKSUM_SIZE, partition->bytes);
+        verify_block_checksum(bytes, what);
+        decode_index(*partition, bytes.first(size), first_block, data_end);
+        return partition;
+    }
+
+    // Decodes |offset u64|size u32|entries u32|key_len u32|last key| entries, whose blocks must
+    // end before data_end
+    void decode_index(IndexPartition<StringType> &partition, std::span<const char> bytes, size_t first_block,
+                      uint64_t data_end) const
+    {
+        partition.first_block = first_block;
+        partition.charge = sizeof(IndexPartition<StringType>) + partition.bytes.capacity();
+        const char *ptr = bytes.data();
+        const char *end = ptr + bytes.size();
+        while (ptr < end)
+        {
+            SSTableIndexEntry<StringType> entry;
+            uint32_t key_len;
+            if (end - ptr < static_cast<std::ptrdiff_t>(sizeof(uint64_t) + sizeof(uint32_t) * 3))
+            {
+                throw SSTableCorruption("Corrupted SSTable index: " + filename_);
+            }
+            std::memcpy(&entry.offset, ptr, sizeof(uint64_t));
+            std::memcpy(&entry.size, ptr + 8, sizeof(uint32_t));
+            std::memcpy(&entry.entries, ptr + 12, sizeof(uint32_t));
+            std::memcpy(&key_len, ptr + 16, sizeof(uint32_t));
+            ptr += 20;
+            if (static_cast<uint64_t>(end - ptr) < key_len || entry.offset + entry.size + BLOCK_CHECKSUM_SIZE > data_end)
+            {
+                throw SSTableCorruption("Corrupted SSTable index: " + filename_);
+            }
+            entry.last_key = make_mapped_string<StringType>(std::string_view(ptr, key_len));
+            ptr += key_len;
+            if constexpr (std::is_same_v<StringType, std::string>)
+            {
+                partition.charge += entry.last_key.capacity();
+            }
+            partition.blocks.push_back(std::move(entry));
+        }
+        partition.charge += partition.blocks.capacity() * sizeof(SSTableIndexEntry<StringType>);
+    }
+
+    // Reads footer and index of a block based table, false for legacy files
+    bool parse_footer(uint64_t file_size) const
+    {
+        if (file_size < sizeof(SSTableFooter))
+        {
+            return false;
+        }
+        std::string footer_bytes;
+        SSTableFooter footer;
+        std::memcpy(&footer, read_bytes(file_size - sizeof(SSTableFooter), sizeof(SSTableFooter), footer_bytes).data(),
+                    sizeof(SSTableFooter));
+        if (footer.magic != SSTABLE_MAGIC)
+        {
+            return false;
+        }
+
+        const uint64_t body_size = file_size - sizeof(SSTableFooter);
+        const bool partitioned = footer.version == SSTABLE_FORMAT_VERSION;
+        if ((!partitioned && footer.version != SSTABLE_SINGLE_INDEX_VERSION) ||
+            footer.filter_offset + footer.filter_size + BLOCK_CHECKSUM_SIZE > body_size ||
+            footer.index_offset + footer.index_size + BLOCK_CHECKSUM_SIZE > body_size)
+        {
+            throw SSTableCorruption("Corrupted SSTable footer: " + filename_);
+        }
+
+        size_t block_count = 0;
+        if (partitioned)
+        {
+            // Only the top level index is decoded up front. Its keys are copied next to each other,
+            // so the binary search over them stays in cache instead of touching a page of the
+            // mapping per step.
+            std::string index_bytes;
+            const auto index = read_bytes(footer.index_offset, footer.index_size + BLOCK_CHECKSUM_SIZE, index_bytes);
+            verify_block_checksum(index, "index of " + filename_);
+            std::vector<std::string_view> keys;
+            const char *ptr = index.data();
+            const char *end = ptr + footer.index_size;
+            constexpr size_t ENTRY_HEADER = sizeof(uint64_t) * 2 + sizeof(uint32_t) * 4;
+            while (ptr < end)
+            {
+                SSTablePartition partition;
+                uint32_t key_len;
+                if (end - ptr < static_cast<std::ptrdiff_t>(ENTRY_HEADER))
+                {
+                    throw SSTableCorruption("Corrupted SSTable top level index: " + filename_);
+                }
+                std::memcpy(&partition.index_offset, ptr, sizeof(uint64_t));
+                std::memcpy(&partition.index_size, ptr + 8, sizeof(uint32_t));
+                std::memcpy(&partition.filter_offset, ptr + 12, sizeof(uint64_t));
+                std::memcpy(&partition.filter_size, ptr + 20, sizeof(uint32_t));
+                std::memcpy(&partition.block_count, ptr + 24, sizeof(uint32_t));
+                std::memcpy(&key_len, ptr + 28, sizeof(uint32_t));
+                ptr += ENTRY_HEADER;
+                if (static_cast<uint64_t>(end - ptr) < key_len ||
+                    partition.filter_offset + partition.filter_size + BLOCK_CHECKSUM_SIZE > partition.index_offset ||
+                    partition.index_offset + partition.index_size + BLOCK_CHECKSUM_SIZE > footer.index_offset)
+                {
+                    throw SSTableCorruption("Corrupted SSTable top level index: " + filename_);
+                }
+                keys.emplace_back(ptr, key_len);
+                ptr += key_len;
+                partition.first_block = block_count;
+                block_count += partition.block_count;
+                partitions_.push_back(std::move(partition));
+            }
+            size_t key_bytes = 0;
+            for (const auto &key : keys)
+            {
+                key_bytes += key.size();
+            }
+            top_level_keys_.clear();
+            top_level_keys_.reserve(key_bytes);
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                const size_t offset = top_level_keys_.size();
+                top_level_keys_ += keys[i];
+                partition_keys_.push_back(make_mapped_string<StringType>(std::string_view(top_level_keys_).substr(offset, keys[i].size())));
+            }
+        }
+        else
+        {
+            auto index = read_index(footer.index_offset, static_cast<uint32_t>(footer.index_size), 0, footer.filter_offset,
+                                    "index of " + filename_);
+            if (!index->blocks.empty())
+            {
+                SSTablePartition partition;
+                partition.index_offset = footer.index_offset;
+                partition.index_size = static_cast<uint32_t>(footer.index_size);
+                partition.filter_offset = footer.filter_offset;
+                partition.filter_size = static_cast<uint32_t>(footer.filter_size);
+                partition.block_count = static_cast<uint32_t>(index->blocks.size());
+                partitions_.push_back(partition);
+                partition_keys_.push_back(index->blocks.back().last_key);
+            }
+            block_count = index->blocks.size();
+            pinned_index_ = std::move(index);
+            if (access_ == TableAccess::pread && footer.filter_probes != 0 && !partitions_.empty())
+            {
+                pinned_filter_ = read_filter(partitions_[0], 0);
+            }
+        }
+
+        // Pread tables check every read themselves, the verifiers only record the format
+        const auto data_span = access_ == TableAccess::mapped ? mapped_file_->data() : std::span<const char>();
+        blocks_.reset(data_span, filename_, block_count);
+        filters_.reset(data_span, filename_, partitions_.size(), "filter partition");
+        footer_ = footer;
+        format_ = Format::block_based;
+        return true;
+    }
+
+    // Block index of a partition, decoded and checked on a cache miss
+    std::shared_ptr<const IndexPartition<StringType>> load_partition(size_t p) const
+    {
+        if (pinned_index_)
+        {
+            return pinned_index_;
+        }
+        const auto &partition = partitions_[p];
+        if (cache_)
+        {
+            if (auto cached = cache_->lookup(cache_id_, partition.index_offset))
+            {
+                return std::static_pointer_cast<const IndexPartition<StringType>>(cached);
+            }
+        }
+        auto index = read_index(partition.index_offset, partition.index_size, partition.first_block, partition.filter_offset,
+                                "index partition " + std::to_string(p) + " of " + filename_);
+        if (index->blocks.size() != partition.block_count)
+        {
+            throw SSTableCorruption("Index partition " + std::to_string(p) + " holds " + std::to_string(index->blocks.size()) +
+                                    " of " + std::to_string(partition.block_count) + " blocks: " + filename_);
+        }
+        if (cache_)
+        {
+            cache_->insert(cache_id_, partition.index_offset, index, index->charge);
+        }
+        return index;
+    }
+
+    std::shared_ptr<const std::string> read_filter(const SSTablePartition &partition, size_t p) const
+    {
+        auto bits = std::make_shared<std::string>();
+        read_bytes(partition.filter_offset, partition.filter_size + BLOCK_CHECKSUM_SIZE, *bits);
+        verify_block_checksum(*bits, "filter partition " + std::to_string(p) + " of " + filename_);
+        bits->resize(partition.filter_size);
+        return bits;
+    }
+
+    // Pread tables keep filters in the block cache next to the index partitions
+    FilterHandle filter(size_t p) const
+    {
+        const auto &partition = partitions_[p];
+        if (access_ == TableAccess::mapped)
+        {
+            return {filters_.block(p, partition.filter_offset, partition.filter_size), nullptr};
+        }
+        if (pinned_filter_)
+        {
+            return {*pinned_filter_, pinned_filter_};
+        }
+        if (cache_)
+        {
+            if (auto cached = cache_->lookup(cache_id_, partition.filter_offset))
+            {
+                auto bits = std::static_pointer_cast<const std::string>(cached);
+                return {*bits, bits};
+            }
+        }
+        auto bits = read_filter(partition, p);
+        if (cache_)
+        {
+            cache_->insert(cache_id_, partition.filter_offset, bits, sizeof(std::string) + bits->capacity());
+        }
+        return {*bits, bits};
+    }
+
+    // Bytes of block i of the index without the checksum. Pread tables fill buffer with at least
+    // readahead bytes from the block on, so the blocks after it are usually served from there.
+    std::span<const char> read_block(const IndexPartition<StringType> &index, size_t i, ReadBuffer &buffer, size_t readahead) const
+    {
+        const auto &entry = index.blocks[i];
+        const size_t number = index.first_block + i;
+        if (access_ == TableAccess::mapped)
+        {
+            return blocks_.block(number, entry.offset, entry.size);
+        }
+        const size_t size = entry.size + BLOCK_CHECKSUM_SIZE;
+        if (!buffer.covers(entry.offset, size))
+        {
+            const uint64_t end = std::max(entry.offset + size, std::min(entry.offset + readahead, pread_file_->size()));
+            pread_file_->read(entry.offset, static_cast<size_t>(end - entry.offset), buffer.data);
+            buffer.offset = entry.offset;
+        }
+        const auto bytes = std::span<const char>(buffer.data).subspan(static_cast<size_t>(entry.offset - buffer.offset), size);
+        if (!block_checksum_matches(bytes))
+        {
+            throw SSTableCorruption("Checksum mismatch in block " + std::to_string(number) + " of " + filename_);
+        }
+        return bytes.first(entry.size);
+    }
+
+    // First partition whose last key is >= key
+    size_t find_partition(const StringType &key) const
+    {
+        return static_cast<size_t>(std::lower_bound(partition_keys_.begin(), partition_keys_.end(), key) - partition_keys_.begin());
+    }
+
+    // First block of the partition whose last key is >= key
+    static size_t find_block(const IndexPartition<StringType> &index, const StringType &key)
+    {
+        auto it = std::lower_bound(index.blocks.begin(), index.blocks.end(), key,
+                                   [](const auto &entry, const StringType &k)
+                                   {
+                                       return entry.last_key < k;
+                                   });
+        return static_cast<size_t>(it - index.blocks.begin());
+    }
+
+    void parse_data_from_span(std::span<const char> data_span) const
+    {
+        const char *ptr = data_span.data();
+        const char *end = ptr + data_span.size();
+
+        // Check if we have at least the header
+        if (ptr + sizeof(uint32_t) > end)
+        {
+            throw SSTableCorruption("Truncated SSTable header: " + filename_);
+        }
+
+        // Read record count header (4 bytes, little endian)
+        uint32_t record_count;
+        std::memcpy(&record_count, ptr, sizeof(uint32_t));
+        ptr += sizeof(uint32_t);
+
+        // Every record has an 8 byte header, a damaged count must not reserve more than the file can hold
+        if (record_count > static_cast<uint64_t>(end - ptr) / (sizeof(uint32_t) * 2))
+        {
+            throw SSTableCorruption("Truncated SSTable, " + std::to_string(record_count) + " records do not fit: " + filename_);
+        }
+        data_cache_.reserve(record_count);
+
+        // Parse records
+        for (uint32_t i = 0; i < record_count && ptr + sizeof(uint32_t) * 2 <= end; ++i)
+        {
+            // Read key length (4 bytes, little endian)
+            uint32_t key_len;
+            std::memcpy(&key_len, ptr, sizeof(uint32_t));
+            ptr += sizeof(uint32_t);
+
+            // Read value length (4 bytes, little endian)
+            uint32_t value_len;
+            std::memcpy(&value_len, ptr, sizeof(uint32_t));
+            ptr += sizeof(uint32_t);
+
+            // Check if we have enough data for key and value
+            if (static_cast<uint64_t>(end - ptr) < static_cast<uint64_t>(key_len) + value_len)
+            {
+                throw SSTableCorruption("Corrupted SSTable record " + std::to_string(i) + ": " + filename_);
+            }
+
+            // Read key data
+            StringType key;
+            if constexpr (std::is_same_v<StringType, std::string>)
+            {
+                key = StringType(ptr, key_len);
+            }
+            else
+            {
+                key = StringType(ptr, key_len, gs::string_class::transient);
+            }
+            ptr += key_len;
+
+            // Read value data
+            StringType value;
+            if constexpr (std::is_same_v<StringType, std::string>)
+            {
+                value = StringType(ptr, value_len);
+            }
+            else
+            {
+                value = StringType(ptr, value_len, gs::string_class::transient);
+            }
+            ptr += value_len;
+
+            data_cache_.emplace_back(key, value);
+        }
+        if (data_cache_.size() != record_count)
+        {
+            throw SSTableCorruption("Truncated SSTable, " + std::to_string(data_cache_.size()) + " of " +
+                                    std::to_string(record_count) + " records: " + filename_);
+        }
+        
+        // Data should already be sorted by construction, but let's verify this assumption
+        // In debug builds, we can add an assertion to check this
+        #ifndef NDEBUG
+        if (!std::is_sorted(data_cache_.begin(), data_cache_.end(),
+                           [](const auto &a, const auto &b) { return a.first < b.first; }))
+        {
+            throw std::runtime_error("SSTable data is not sorted - this violates the invariant");
+        }
+        #endif
+    }
+
+public:
+    // Without a block cache index partitions are decoded on every access. Pread tables read
+    // readahead_bytes at a time when scanned.
+    SSTable(const std::string &filename, int level = 0, std::shared_ptr<BlockCache> cache = nullptr,
+            TableAccess access = TableAccess::mapped, size_t readahead_bytes = 0)
+        : filename_(filename), cache_loaded_(false), mapped_file_(nullptr), format_(Format::legacy), cache_(std::move(cache)),
+          cache_id_(cache_ ? cache_->new_table_id() : 0), access_(access), readahead_bytes_(readahead_bytes), level_(level),
+          file_bytes_(0)
+    {
+        std::error_code ec;
+        auto bytes = std::filesystem::file_size(filename_, ec);
+        file_bytes_ = ec ? 0 : bytes;
+        modified_ = std::filesystem::last_write_time(filename_, ec);
+    }
+
+    // Streams sorted entries through an SSTableWriter into a new table
+    template <typename Entries>
+    static std::unique_ptr<SSTable> create_from_entries(
+        const Entries &entries,
+        const std::string &filename,
+        int level = 0,
+        const SSTableWriterOptions &options = SSTableWriterOptions(),
+        std::shared_ptr<BlockCache> cache = nullptr)
+    {
+        SSTableWriter writer(filename, options);
+        for (const auto &[key, value] : entries)
+        {
+            writer.add(std::string_view(key.data(), key.size()), std::string_view(value.data(), value.size()));
+        }
+        writer.finish();
+        return std::make_unique<SSTable>(filename, level, std::move(cache));
+    }
+
+    // Create SSTable from MemTable data
+    static std::unique_ptr<SSTable> create_from_memtable(
+        const typename MemTable<StringType>::Map &data,
+        const std::string &filename,
+        int level = 0,
+        const SSTableWriterOptions &options = SSTableWriterOptions(),
+        std::shared_ptr<BlockCache> cache = nullptr)
+    {
+        return create_from_entries(data, filename, level, options, std::move(cache));
+    }
+
+    // Key-range check, plus the Bloom filter for block based tables
+    bool may_contain(const StringType &key) const
+    {
+        load_cache();
+        if (format_ == Format::block_based)
+        {
+            if (partition_keys_.empty() || partition_keys_.back() < key)
+            {
+                return false;
+            }
+            return footer_.filter_probes == 0 ||
+                   bloom_may_contain(filter(find_partition(key)).bits, footer_.filter_probes, bloom_hash(std::string_view(key.data(), key.size())));
+        }
+        if (data_cache_.empty())
+        {
+            return false;
+        }
+        return !(key < data_cache_.front().first) && !(data_cache_.back().first < key);
+    }
+
+    std::optional<StringType> get(const StringType &key, GetTrace *trace = nullptr) const
+    {
+        load_cache();
+        if (trace != nullptr)
+        {
+            trace->index_searches++;
+        }
+        if (format_ == Format::block_based)
+        {
+            // The top level index picks the partition and its index the only block that can hold the key
+            const size_t partition = find_partition(key);
+            if (partition >= partitions_.size())
+            {
+                return std::nullopt;
+            }
+            const auto index = load_partition(partition);
+            const size_t block = find_block(*index, key);
+            if (block >= index->blocks.size())
+            {
+                return std::nullopt;
+            }
+            const std::string_view target(key.data(), key.size());
+            ReadBuffer buffer;
+            BlockReader reader;
+            reader.reset(read_block(*index, block, buffer, 0));
+            if (trace != nullptr)
+            {
+                trace->blocks_read++;
+            }
+            if (reader.seek(target) && reader.key() == target)
+            {
+                // Values read with pread are copied out of the local buffer
+                return access_ == TableAccess::mapped ? make_mapped_string<StringType>(reader.value())
+                                                      : make_owned_string<StringType>(reader.value());
+            }
+            return std::nullopt;
+        }
+
+        auto it = std::lower_bound(data_cache_.begin(), data_cache_.end(), key,
+                                  [](const auto &pair, const StringType &k) 
+                                  {
+                                      return pair.first < k;
+                                  });
+        if (it != data_cache_.end() && it->first == key)
+        {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::unique_ptr<EntryCursor<StringType>> cursor(const StringType &start) const
+    {
+        load_cache();
+        if (format_ == Format::block_based)
+        {
+            return std::make_unique<BlockCursor<StringType>>(*this, start);
+        }
+        auto it = std::lower_bound(data_cache_.begin(), data_cache_.end(), start,
+                                   [](const auto &pair, const StringType &k)
+                                   {
+                                       return pair.first < k;
+                                   });
+        using Iterator = typename std::vector<std::pair<StringType, StringType>>::const_iterator;
+        return std::make_unique<RangeCursor<StringType, Iterator>>(it, data_cache_.cend());
+    }
+
+    // Sorted keys spread over the table. Block based tables return their partition keys, or the
+    // block keys when the index is not partitioned. The keys are copies, an index partition may be
+    // evicted from the block cache while the caller still uses them.
+    std::vector<StringType> index_keys() const
+    {
+        load_cache();
+        std::vector<StringType> keys;
+        if (format_ == Format::block_based)
+        {
+            if (partitions_.size() > 1)
+            {
+                for (const auto &partition_key : partition_keys_)
+                {
+                    keys.push_back(as_owned(partition_key));
+                }
+                return keys;
+            }
+            if (!partitions_.empty())
+            {
+                // Holds the partition until its keys are copied
+                const auto index = load_partition(0);
+                for (const auto &entry : index->blocks)
+                {
+                    keys.push_back(as_owned(entry.last_key));
+                }
+            }
+            return keys;
+        }
+        constexpr size_t LEGACY_KEYS_PER_BLOCK = 32;
+        for (size_t i = LEGACY_KEYS_PER_BLOCK - 1; i < data_cache_.size(); i += LEGACY_KEYS_PER_BLOCK)
+        {
+            keys.push_back(as_owned(data_cache_[i].first));
+        }
+        return keys;
+    }
+
+    const std::string &get_filename() const
+    {
+        return filename_;
+    }
+
+    int get_level() const
+    {
+        return level_;
+    }
+
+    uint64_t file_bytes() const
+    {
+        return file_bytes_;
+    }
+
+    // Modification time when the table was opened
+    std::filesystem::file_time_type modified() const
+    {
+        return modified_;
+    }
+
+    TableAccess access() const
+    {
+        return access_;
+    }
+
+    bool is_cache_loaded() const
+    {
+        return cache_loaded_.load(std::memory_order_acquire);
+    }
+
+    // Reads the whole table once, checking every block checksum. Legacy tables have none and are
+    // only decoded. Throws SSTableCorruption at the first damaged block.
+    SSTableVerifyResult verify() const
+    {
+        load_cache();
+        SSTableVerifyResult result;
+        result.bytes = file_bytes_;
+        if (format_ != Format::block_based)
+        {
+            result.entries = data_cache_.size();
+            return result;
+        }
+
+        result.checksummed = true;
+        ReadBuffer buffer;
+        for (size_t p = 0; p < partitions_.size(); ++p)
+        {
+            filter(p);
+            const auto index = load_partition(p);
+            for (size_t i = 0; i < index->blocks.size(); ++i)
+            {
+                read_block(*index, i, buffer, readahead_bytes_);
+                result.blocks++;
+                result.entries += index->blocks[i].entries;
+            }
+        }
+        return result;
+    }
+
+    bool is_block_based() const
+    {
+        load_cache();
+        return format_ == Format::block_based;
+    }
+
+    size_t size() const
+    {
+        load_cache();
+        return format_ == Format::block_based ? footer_.entry_count : data_cache_.size();
+    }
+
+    // Force reload from disk (useful for testing)
+    void reload_from_disk() const
+    {
+        {
+            std::lock_guard<std::mutex> lock(load_mutex_);
+            cache_loaded_.store(false, std::memory_order_release);
+            data_cache_.clear();
+            clear_index();
+            if (cache_)
+            {
+                // Cached partitions point into the old mapping
+                cache_id_ = cache_->new_table_id();
+            }
+            close_file(); // Release the existing mapping
+        }
+        load_cache();
+    }
+
+    // Check if the file is currently memory-mapped
+    bool is_mapped() const
+    {
+        return mapped_file_ != nullptr;
+    }
+
+    // Release the memory mapping (but keep the cache), block based tables read through the mapping
+    void release_mapping() const
+    {
+        if (format_ == Format::legacy)
+        {
+            mapped_file_.reset();
+        }
+    }
+};
+
+// Puts and deletes collected into one buffer of |type u8|key_len varint|value_len varint|key|value|
+// records, applied together by LSMTree::write. Deletes are stored as the empty value the tree
+// uses as a tombstone.
+class WriteBatch
+{
+private:
+    enum class RecordType : uint8_t
+    {
+        put = 1,
+        remove = 2,
+    };
+
+    std::string rep_;
+    size_t count_ = 0;
+
+    void append(RecordType type, std::string_view key, std::string_view value)
+    {
+        rep_.push_back(static_cast<char>(type));
+        encode_varint32(rep_, static_cast<uint32_t>(key.size()));
+        encode_varint32(rep_, static_cast<uint32_t>(value.size()));
+        rep_ += key;
+        rep_ += value;
+        count_++;
+    }
+
+public:
+    void put(std::string_view key, std::string_view value)
+    {
+        append(RecordType::put, key, value);
+    }
+
+    void delete_key(std::string_view key)
+    {
+        append(RecordType::remove, key, {});
+    }
+
+    void clear()
+    {
+        rep_.clear();
+        count_ = 0;
+    }
+
+    size_t count() const
+    {
+        return count_;
+    }
+
+    bool empty() const
+    {
+        return count_ == 0;
+    }
+
+    // Serialized size of the batch
+    size_t byte_size() const
+    {
+        return rep_.size();
+    }
+
+    // Calls fn(key, value) for every record in insertion order, deletes pass an empty value
+    template <typename Fn>
+    void for_each(Fn &&fn) const
+    {
+        const char *ptr = rep_.data();
+        const char *end = ptr + rep_.size();
+        while (ptr < end)
+        {
+            const auto type = static_cast<RecordType>(*ptr++);
+            uint32_t key_len;
+            uint32_t value_len;
+            if (!decode_varint32(ptr, end, key_len) || !decode_varint32(ptr, end, value_len) ||
+                static_cast<uint64_t>(end - ptr) < static_cast<uint64_t>(key_len) + value_len)
+            {
+                throw std::runtime_error("Corrupted write batch");
+            }
+            const std::string_view key(ptr, key_len);
+            ptr += key_len;
+            fn(key, type == RecordType::remove ? std::string_view() : std::string_view(ptr, value_len));
+            ptr += value_len;
+        }
+    }
+};
+
+// What a CompactionFilter does with one entry
+enum class CompactionDecision
+{
+    keep,
+    remove,       // Leave the entry out of the output, no tombstone is written
+    change_value, // Write new_value instead of the stored value
+};
+
+// Hook run on the newest version of every live key while compaction merges tables. Compactions
+// always merge every table, so a removed entry cannot uncover an older version of its key.
+// Subcompactions call filter() concurrently.
+class CompactionFilter
+{
+public:
+    virtual ~CompactionFilter() = default;
+
+    virtual CompactionDecision filter(std::string_view key, std::string_view value, std::string &new_value) const = 0;
+    virtual const char *name() const = 0;
+};
+
+// Values written for TtlCompactionFilter start with a |expires_at u64| header, seconds since the epoch
+constexpr size_t TTL_HEADER_SIZE = sizeof(uint64_t);
+
+inline uint64_t unix_seconds_now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                                     std::chrono::system_clock::now().time_since_epoch())
+                                     .count());
+}
+
+inline std::string make_ttl_value(std::string_view value, uint64_t expires_at)
+{
+    std::string result(TTL_HEADER_SIZE, '\0');
+    std::memcpy(result.data(), &expires_at, sizeof(expires_at));
+    result += value;
+    return result;
+}
+
+// Expiry time of a value with a TTL header, std::nullopt for values too short to carry one
+inline std::optional<uint64_t> ttl_value_expiry(std::string_view value)
+{
+    if (value.size() < TTL_HEADER_SIZE)
+    {
+        return std::nullopt;
+    }
+    uint64_t expires_at;
+    std::memcpy(&expires_at, value.data(), sizeof(expires_at));
+    return expires_at;
+}
+
+// Drops entries whose TTL header lies in the past, replacing explicit deletes of expiring keys
+class TtlCompactionFilter : public CompactionFilter
+{
+private:
+    std::function<uint64_t()> clock_;
+
+public:
+    explicit TtlCompactionFilter(std::function<uint64_t()> clock = unix_seconds_now) : clock_(std::move(clock))
+    {
+    }
+
+    CompactionDecision filter(std::string_view, std::string_view value, std::string &) const override
+    {
+        const auto expires_at = ttl_value_expiry(value);
+        return expires_at.has_value() && *expires_at <= clock_() ? CompactionDecision::remove : CompactionDecision::keep;
+    }
+
+    const char *name() const override
+    {
+        return "ttl";
+    }
+};
+
+// Tuning knobs for an LSMTree instance
+struct LSMOptions
+{
+    size_t memtable_threshold = 8 * 1024 * 1024;
+    bool verbose = true; // Log flushes and compactions to stdout
+    // Paces flush (high priority) and compaction (low priority) writes, may be shared between trees
+    std::shared_ptr<RateLimiter> rate_limiter;
+    bool rate_limit_reads = false; // Also charge compaction input reads to the limiter
+    // Key ranges a compaction may be split into, each merged and written on its own thread
+    size_t max_subcompactions = 1;
+    size_t block_size = 4 * 1024;
+    size_t restart_interval = 16;   // Front coded keys between full keys inside a block
+    size_t bloom_bits_per_key = 10; // 0 disables the per-table Bloom filter
+    bool use_direct_io = false;     // Write SSTables with O_DIRECT, bypassing the page cache
+    size_t index_partition_size = 4 * 1024; // Index bytes per partition, 0 writes one index per table
+    // Holds decoded index partitions, may be shared between trees. Created with block_cache_bytes if unset.
+    std::shared_ptr<BlockCache> block_cache;
+    size_t block_cache_bytes = 8 * 1024 * 1024;
+    std::shared_ptr<const CompactionFilter> compaction_filter; // Applied to every compaction, none by default
+    // Second directory for the cold tier, empty keeps every table in the tree's directory. Compaction
+    // moves entries older than cold_min_age there, cold tables are read with pread and readahead
+    // instead of being mapped so they do not compete with hot tables for the page cache.
+    std::string cold_dir;
+    // Measured from the flush of the table an entry came from. The default of 0 moves all of every
+    // compaction's output to cold_dir.
+    std::chrono::seconds cold_min_age{0};
+    size_t cold_readahead_bytes = 1024 * 1024; // Read size of scans and compactions over cold tables
+};
+
+// LSM Tree implementation
+// Reads take a shared lock and writes an exclusive one, so a tree can be shared between threads.
+// Flushes and compactions write their files outside the lock and only take it exclusively to
+// install the result, a full memtable stays readable as the immutable memtable meanwhile.
+// get, multi_get and scan return copies, the memtable arena or mapping a value was read from
+// can go away with the next flush or compaction once the lock is released.
+template <typename StringType>
+class LSMTree
+{
+private:
+    // Level 0 tables allowed before a compaction is triggered
+    static constexpr size_t COMPACTION_TRIGGER = 4;
+    // Smaller compactions are not worth splitting
+    static constexpr size_t MIN_SUBCOMPACTION_ENTRIES = 4096;
+
+    LSMOptions options_;
+    std::shared_ptr<MemTable<StringType>> memtable_;
+    std::shared_ptr<const MemTable<StringType>> immutable_memtable_; // Being flushed, if any
+    std::vector<std::shared_ptr<SSTable<StringType>>> sstables_;
+    std::string base_dir_;
+    std::atomic<int> next_sstable_id_;
+    LSMCounters counters_;
+    mutable std::shared_mutex mutex_;
+    std::mutex flush_mutex_;      // One flush at a time, writers filling the next memtable wait here
+    std::mutex compaction_mutex_; // One compaction at a time
+
+public:
+    explicit LSMTree(const std::string &base_dir = "./lsm_data", const LSMOptions &options = LSMOptions())
+        : options_(options), memtable_(std::make_shared<MemTable<StringType>>(options.memtable_threshold)), base_dir_(base_dir), next_sstable_id_(0)
+    {
+        if (!options_.block_cache)
+        {
+            options_.block_cache = std::make_shared<BlockCache>(options_.block_cache_bytes);
+        }
+
+        // Create directory if it doesn't exist
+        std::filesystem::create_directories(base_dir_);
+        if (!options_.cold_dir.empty())
+        {
+            std::filesystem::create_directories(options_.cold_dir);
+        }
+
+        // Load existing SSTables
+        load_existing_sstables();
+    }
+
+    void put(StringType key, StringType value)
+    {
+        ScopedLatency latency(counters_.put_latency);
+        LSMCounters::add(counters_.puts);
+        LSMCounters::add(counters_.user_bytes_written, key.size() + value.size());
+
+        bool flush_needed = false;
+        {
+            std::unique_lock lock(mutex_);
+
+            // Insert into MemTable
+            memtable_->put(std::move(key), std::move(value));
+
+            // Check if MemTable is full and needs to be flushed
+            flush_needed = memtable_->is_full();
+        }
+
+        if (flush_needed)
+        {
+            run_flush(false);
+        }
+    }
+
+    std::optional<StringType> get(const StringType &key)
+    {
+        ScopedLatency latency(counters_.get_latency);
+        LSMCounters::add(counters_.gets);
+
+        std::shared_lock lock(mutex_);
+        return get_locked(key);
+    }
+
+    // Looks up several keys under a single acquisition of the tree lock
+    std::vector<std::optional<StringType>> multi_get(const std::vector<StringType> &keys)
+    {
+        LSMCounters::add(counters_.gets, keys.size());
+
+        std::vector<std::optional<StringType>> results;
+        results.reserve(keys.size());
+        std::shared_lock lock(mutex_);
+        for (const auto &key : keys)
+        {
+            results.push_back(get_locked(key));
+        }
+        return results;
+    }
+
+private:
+    std::optional<StringType> get_locked(const StringType &key)
+    {
+        GetTrace trace;
+        auto result = find_locked(key, trace);
+        // Added once per get rather than per table, these counters are shared by all threads
+        if (trace.tables_checked > 0)
+        {
+            LSMCounters::add(counters_.filter_checks, trace.tables_checked);
+            LSMCounters::add(counters_.filter_rejects, trace.filter_rejects);
+            LSMCounters::add(counters_.sstable_probes, trace.index_searches);
+        }
+#if LSM_GET_PATH_STATS
+        counters_.get_paths.record(trace);
+#endif
+        return result.transform(as_owned);
+    }
+
+    std::optional<StringType> find_locked(const StringType &key, GetTrace &trace)
+    {
+        auto result = memtable_->get(key);
+        if (result.has_value())
+        {
+            trace.source = GetSource::memtable;
+            return result;
+        }
+        if (immutable_memtable_)
+        {
+            result = immutable_memtable_->get(key);
+            if (result.has_value())
+            {
+                trace.source = GetSource::immutable_memtable;
+                return result;
+            }
+        }
+
+        for (auto& sstable : std::views::reverse(sstables_))
+        {
+            trace.tables_checked++;
+            if (!sstable->may_contain(key))
+            {
+                trace.filter_rejects++;
+                continue;
+            }
+
+            result = sstable->get(key, &trace);
+            if (result.has_value())
+            {
+                trace.source = GetSource::sstable;
+                trace.level = sstable->get_level();
+                return result;
+            }
+        }
+        return std::nullopt;
+    }
+
+public:
+    // Returns up to limit live entries with keys >= start, in key order
+    std::vector<std::pair<StringType, StringType>> scan(const StringType &start, size_t limit)
+    {
+        std::shared_lock lock(mutex_);
+
+        std::vector<std::unique_ptr<EntryCursor<StringType>>> children;
+        children.push_back(memtable_->cursor(start));
+        if (immutable_memtable_)
+        {
+            children.push_back(immutable_memtable_->cursor(start));
+        }
+        for (auto &sstable : std::views::reverse(sstables_))
+        {
+            children.push_back(sstable->cursor(start));
+        }
+
+        std::vector<std::pair<StringType, StringType>> result;
+        for (MergingCursor<StringType> cursor(std::move(children)); cursor.valid() && result.size() < limit; cursor.next())
+        {
+            // Skip tombstones
+            if (!cursor.value().empty())
+            {
+                result.emplace_back(as_owned(cursor.key()), as_owned(cursor.value()));
+            }
+        }
+        return result;
+    }
+
+    // Applies every record of the batch under one acquisition of the tree lock, so readers see
+    // either none or all of it, and with one sorted pass over the memtable. The batch goes into the
+    // current memtable as a whole even if that takes it past the flush threshold. There is no
+    // write-ahead log, like single puts a batch is durable once its memtable is flushed.
+    void write(const WriteBatch &batch)
+    {
+        if (batch.empty())
+        {
+            return;
+        }
+        std::vector<std::pair<std::string_view, std::string_view>> entries;
+        entries.reserve(batch.count());
+        uint64_t bytes = 0;
+        batch.for_each([&](std::string_view key, std::string_view value)
+                       {
+                           entries.emplace_back(key, value);
+                           bytes += key.size() + value.size();
+                       });
+        // Stable, so the last record for a key is applied last and wins
+        std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                         { return a.first < b.first; });
+        LSMCounters::add(counters_.puts, entries.size());
+        LSMCounters::add(counters_.user_bytes_written, bytes);
+
+        bool flush_needed = false;
+        {
+            std::unique_lock lock(mutex_);
+            memtable_->put_sorted(entries);
+            flush_needed = memtable_->is_full();
+        }
+
+        if (flush_needed)
+        {
+            run_flush(false);
+        }
+    }
+
+    void delete_key(const StringType &key)
+    {
+        // In LSM-trees, deletion is implemented as putting a tombstone marker
+        // For simplicity, we'll use an empty string as the tombstone
+        // In a real implementation, you'd use a special marker to distinguish
+        // between empty values and deleted keys
+        put(key, ""); // Empty value acts as tombstone
+    }
+
+    void flush_memtable()
+    {
+        run_flush(true);
+    }
+
+    void compact()
+    {
+        run_compaction(true);
+    }
+
+    // Writes entries straight into a new newest SSTable, bypassing the memtable. Within entries
+    // the last occurrence of a key wins.
+    void bulk_load(std::vector<std::pair<StringType, StringType>> entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b)
+                         { return a.first < b.first; });
+        auto it = entries.begin();
+        bulk_load_sorted([&]() -> std::optional<std::pair<StringType, StringType>>
+                         {
+                             if (it == entries.end())
+                             {
+                                 return std::nullopt;
+                             }
+                             return std::move(*it++);
+                         });
+    }
+
+    // Streams entries in ascending key order from next(), which returns nullopt at the end, into
+    // a single new SSTable. Memory stays bounded by the writer's buffers however large the table.
+    template <typename Source>
+    void bulk_load_sorted(Source &&next)
+    {
+        // Older memtable data must not shadow the loaded table
+        flush_memtable();
+
+        std::lock_guard flush_lock(flush_mutex_);
+        std::string filename = base_dir_ + "/sstable_" + std::to_string(next_sstable_id_++) + ".dat";
+        SSTableWriter writer(filename, writer_options(IOPriority::high));
+        auto write = [&](const std::pair<StringType, StringType> &entry)
+        {
+            const auto &[key, value] = entry;
+            LSMCounters::add(counters_.user_bytes_written, key.size() + value.size());
+            writer.add(std::string_view(key.data(), key.size()), std::string_view(value.data(), value.size()));
+        };
+        std::optional<std::pair<StringType, StringType>> pending = next();
+        while (pending)
+        {
+            auto entry = next();
+            if (entry && entry->first < pending->first)
+            {
+                throw std::runtime_error("bulk_load_sorted: keys out of order");
+            }
+            if (!entry || pending->first < entry->first)
+            {
+                write(*pending);
+            }
+            // Rebuilt rather than move assigned, german string move assignment does not free an
+            // owned buffer it overwrites
+            pending.reset();
+            if (entry)
+            {
+                pending.emplace(std::move(*entry));
+            }
+        }
+        const uint64_t file_bytes = writer.finish();
+        LSMCounters::add(counters_.flush_count);
+        LSMCounters::add(counters_.flush_bytes_written, file_bytes);
+
+        bool compaction_needed = false;
+        {
+            std::unique_lock lock(mutex_);
+            sstables_.push_back(open_table(filename, 0, false));
+            update_compaction_debt_locked();
+            compaction_needed = should_compact();
+        }
+        if (compaction_needed)
+        {
+            run_compaction(false);
+        }
+    }
+
+private:
+    std::shared_ptr<SSTable<StringType>> open_table(const std::string &filename, int level, bool cold) const
+    {
+        if (cold)
+        {
+            return std::make_shared<SSTable<StringType>>(filename, level, options_.block_cache, TableAccess::pread,
+                                                         options_.cold_readahead_bytes);
+        }
+        return std::make_shared<SSTable<StringType>>(filename, level, options_.block_cache);
+    }
+
+    SSTableWriterOptions writer_options(IOPriority priority) const
+    {
+        SSTableWriterOptions options;
+        options.block_size = options_.block_size;
+        options.restart_interval = options_.restart_interval;
+        options.bloom_bits_per_key = options_.bloom_bits_per_key;
+        options.index_partition_size = options_.index_partition_size;
+        options.direct_io = options_.use_direct_io;
+        options.rate_limiter = options_.rate_limiter.get();
+        options.priority = priority;
+        return options;
+    }
+
+    // Turns the memtable into the immutable memtable and writes it out. Without force the flush is
+    // skipped when another writer already flushed the memtable while we waited for flush_mutex_.
+    void run_flush(bool force)
+    {
+        bool compaction_needed = false;
+        {
+            std::lock_guard flush_lock(flush_mutex_);
+            std::shared_ptr<const MemTable<StringType>> immutable;
+            {
+                std::unique_lock lock(mutex_);
+                if (memtable_->empty() || (!force && !memtable_->is_full()))
+                {
+                    return;
+                }
+                immutable_memtable_ = std::exchange(memtable_, std::make_shared<MemTable<StringType>>(options_.memtable_threshold));
+                immutable = immutable_memtable_;
+            }
+
+            // Create new SSTable from MemTable data
+            std::string filename = base_dir_ + "/sstable_" + std::to_string(next_sstable_id_++) + ".dat";
+            std::shared_ptr<SSTable<StringType>> sstable = SSTable<StringType>::create_from_memtable(
+                immutable->get_all_data(), filename, 0, writer_options(IOPriority::high), options_.block_cache);
+            LSMCounters::add(counters_.flush_count);
+            LSMCounters::add(counters_.flush_bytes_written, sstable->file_bytes());
+
+            std::unique_lock lock(mutex_);
+            sstables_.push_back(std::move(sstable));
+            immutable_memtable_.reset();
+            LSMCounters::add(counters_.memtable_allocations, immutable->allocations());
+            update_compaction_debt_locked();
+            compaction_needed = should_compact();
+        }
+
+        // A compaction already running elsewhere will be retriggered by a later flush
+        if (compaction_needed)
+        {
+            run_compaction(false);
+        }
+    }
+
+    bool should_compact() const
+    {
+        // Simple compaction strategy: compact when more than COMPACTION_TRIGGER flushed SSTables pile up
+        size_t level0_count = 0;
+        for (const auto &sstable : sstables_)
+        {
+            if (sstable->get_level() == 0)
+            {
+                level0_count++;
+            }
+        }
+        return level0_count > COMPACTION_TRIGGER;
+    }
+
+    // Feeds pending level 0 bytes to an auto tuned rate limiter
+    void update_compaction_debt_locked()
+    {
+        if (!options_.rate_limiter)
+        {
+            return;
+        }
+        uint64_t pending_bytes = 0;
+        for (const auto &sstable : sstables_)
+        {
+            if (sstable->get_level() == 0)
+            {
+                pending_bytes += sstable->file_bytes();
+            }
+        }
+        options_.rate_limiter->update_compaction_debt(pending_bytes, COMPACTION_TRIGGER * memtable_->threshold());
+    }
+
+    // Picks up to max_subcompactions - 1 split keys from the index keys of the inputs. Every index key
+    // stands for about one block, so their quantiles split the data into ranges of similar size.
+    std::vector<StringType> pick_subcompaction_boundaries(const std::vector<std::shared_ptr<SSTable<StringType>>> &inputs) const
+    {
+        size_t total_entries = 0;
+        for (const auto &sstable : inputs)
+        {
+            total_entries += sstable->size();
+        }
+        const size_t ranges = std::min(options_.max_subcompactions, total_entries / MIN_SUBCOMPACTION_ENTRIES);
+        if (ranges <= 1)
+        {
+            return {};
+        }
+
+        std::vector<StringType> samples;
+        for (const auto &sstable : inputs)
+        {
+            auto keys = sstable->index_keys();
+            samples.insert(samples.end(), std::make_move_iterator(keys.begin()), std::make_move_iterator(keys.end()));
+        }
+        if (samples.empty())
+        {
+            return {};
+        }
+        std::sort(samples.begin(), samples.end());
+
+        std::vector<StringType> boundaries;
+        for (size_t r = 1; r < ranges; ++r)
+        {
+            const auto &key = samples[r * samples.size() / ranges];
+            if (boundaries.empty() || boundaries.back() < key)
+            {
+                boundaries.push_back(as_owned(key));
+            }
+        }
+        return boundaries;
+    }
+
+    struct SubcompactionResult
+    {
+        std::vector<std::shared_ptr<SSTable<StringType>>> outputs; // The hot and the cold table, when written
+        uint64_t entries_dropped = 0;
+        uint64_t entries_changed = 0;
+    };
+
+    // Merges the entries in [lower, upper) into level 1 tables, passing live entries through the
+    // compaction filter. With a cold tier, entries coming from cold tables or from tables older than
+    // cold_min_age go to cold_filename and the rest to hot_filename. The hot table takes the
+    // modification time of its oldest source, so entry ages are tracked at table granularity and
+    // err towards moving data to the cold tier early.
+    SubcompactionResult run_subcompaction(const std::vector<std::shared_ptr<SSTable<StringType>>> &inputs,
+                                          const StringType *lower, const StringType *upper,
+                                          const std::string &hot_filename, const std::string &cold_filename) const
+    {
+        // MergingCursor expects the newest input first
+        const bool tiered = !options_.cold_dir.empty();
+        const auto now = std::filesystem::file_time_type::clock::now();
+        std::vector<std::unique_ptr<EntryCursor<StringType>>> children;
+        std::vector<bool> child_is_cold;
+        std::vector<std::filesystem::file_time_type> child_modified;
+        for (const auto &sstable : std::views::reverse(inputs))
+        {
+            children.push_back(sstable->cursor(lower != nullptr ? *lower : StringType()));
+            child_is_cold.push_back(tiered && (sstable->access() == TableAccess::pread ||
+                                               now - sstable->modified() >= options_.cold_min_age));
+            child_modified.push_back(sstable->modified());
+        }
+
+        // An unfinished writer removes its temporary file
+        SubcompactionResult result;
+        const CompactionFilter *filter = options_.compaction_filter.get();
+        std::string new_value;
+        SSTableWriter hot_writer(hot_filename, writer_options(IOPriority::low));
+        std::optional<SSTableWriter> cold_writer;
+        if (tiered)
+        {
+            cold_writer.emplace(cold_filename, writer_options(IOPriority::low));
+        }
+        std::optional<std::filesystem::file_time_type> hot_modified;
+        for (MergingCursor<StringType> cursor(std::move(children)); cursor.valid(); cursor.next())
+        {
+            if (upper != nullptr && !(cursor.key() < *upper))
+            {
+                break;
+            }
+            const std::string_view key(cursor.key().data(), cursor.key().size());
+            std::string_view value(cursor.value().data(), cursor.value().size());
+            // The filter only decides about live values, tombstones are kept as compaction always has
+            if (filter != nullptr && !value.empty())
+            {
+                switch (filter->filter(key, value, new_value))
+                {
+                case CompactionDecision::remove:
+                    result.entries_dropped++;
+                    continue;
+                case CompactionDecision::change_value:
+                    result.entries_changed++;
+                    value = new_value;
+                    break;
+                case CompactionDecision::keep:
+                    break;
+                }
+            }
+            const size_t source = cursor.source();
+            if (child_is_cold[source])
+            {
+                cold_writer->add(key, value);
+                continue;
+            }
+            hot_writer.add(key, value);
+            if (tiered && (!hot_modified || child_modified[source] < *hot_modified))
+            {
+                hot_modified = child_modified[source];
+            }
+        }
+        if (hot_writer.entry_count() > 0)
+        {
+            hot_writer.finish();
+            if (hot_modified)
+            {
+                std::filesystem::last_write_time(hot_filename, *hot_modified);
+            }
+            result.outputs.push_back(open_table(hot_filename, 1, false));
+        }
+        if (cold_writer && cold_writer->entry_count() > 0)
+        {
+            cold_writer->finish();
+            result.outputs.push_back(open_table(cold_filename, 1, true));
+        }
+        return result;
+    }
+
+    // Merges a snapshot of the current SSTables into level 1 tables with disjoint key ranges, one per
+    // subcompaction. With wait == false the call returns immediately when another thread is already compacting.
+    void run_compaction(bool wait)
+    {
+        std::unique_lock compaction_lock(compaction_mutex_, std::defer_lock);
+        if (wait)
+        {
+            compaction_lock.lock();
+        }
+        else if (!compaction_lock.try_lock())
+        {
+            return;
+        }
+
+        // Flushes only append while we hold compaction_mutex_, so the inputs stay a prefix of sstables_
+        std::vector<std::shared_ptr<SSTable<StringType>>> inputs;
+        {
+            std::shared_lock lock(mutex_);
+            inputs = sstables_;
+        }
+        if (inputs.size() < 2)
+        {
+            return;
+        }
+
+        if (options_.verbose)
+        {
+            std::cout << "Compacting " << inputs.size() << " SSTables...\n";
+        }
+        ScopedLatency duration(counters_.compaction_duration);
+
+        for (const auto &sstable : inputs)
+        {
+            LSMCounters::add(counters_.compaction_bytes_read, sstable->file_bytes());
+            if (options_.rate_limiter && options_.rate_limit_reads)
+            {
+                options_.rate_limiter->request(sstable->file_bytes(), IOPriority::low);
+            }
+        }
+
+        const auto boundaries = pick_subcompaction_boundaries(inputs);
+        const size_t range_count = boundaries.size() + 1;
+        // The hot and cold outputs of a range share an id, their keys are disjoint
+        std::vector<std::string> filenames;
+        for (size_t r = 0; r < range_count; ++r)
+        {
+            filenames.push_back("/compacted_" + std::to_string(next_sstable_id_++) + ".dat");
+        }
+
+        std::vector<SubcompactionResult> results(range_count);
+        std::vector<std::exception_ptr> errors(range_count);
+        auto run_range = [&](size_t r)
+        {
+            try
+            {
+                const StringType *lower = r > 0 ? &boundaries[r - 1] : nullptr;
+                const StringType *upper = r < boundaries.size() ? &boundaries[r] : nullptr;
+                results[r] = run_subcompaction(inputs, lower, upper, base_dir_ + filenames[r], options_.cold_dir + filenames[r]);
+            }
+            catch (...)
+            {
+                errors[r] = std::current_exception();
+            }
+        };
+
+        // The calling thread takes the first range itself
+        std::vector<std::thread> workers;
+        for (size_t r = 1; r < range_count; ++r)
+        {
+            workers.emplace_back(run_range, r);
+        }
+        run_range(0);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                // Nothing was installed, drop the partial output
+                for (const auto &result : results)
+                {
+                    for (const auto &output : result.outputs)
+                    {
+                        std::filesystem::remove(output->get_filename());
+                    }
+                }
+                std::rethrow_exception(error);
+            }
+        }
+
+        std::vector<std::shared_ptr<SSTable<StringType>>> outputs;
+        uint64_t entries_dropped = 0;
+        uint64_t entries_changed = 0;
+        for (const auto &result : results)
+        {
+            outputs.insert(outputs.end(), result.outputs.begin(), result.outputs.end());
+            entries_dropped += result.entries_dropped;
+            entries_changed += result.entries_changed;
+        }
+        LSMCounters::add(counters_.compaction_count);
+        LSMCounters::add(counters_.subcompaction_count, range_count);
+        LSMCounters::add(counters_.compaction_entries_dropped, entries_dropped);
+        LSMCounters::add(counters_.compaction_entries_changed, entries_changed);
+        for (const auto &output : outputs)
+        {
+            LSMCounters::add(counters_.compaction_bytes_written, output->file_bytes());
+        }
+
+        // Tables flushed meanwhile are newer than the merged data and stay on top of it
+        {
+            std::unique_lock lock(mutex_);
+            sstables_.erase(sstables_.begin(), sstables_.begin() + static_cast<std::ptrdiff_t>(inputs.size()));
+            sstables_.insert(sstables_.begin(), outputs.begin(), outputs.end());
+            update_compaction_debt_locked();
+        }
+
+        // Delete old SSTable files, mappings stay valid until the last reader drops them
+        for (const auto &sstable : inputs)
+        {
+            const std::string &old_filename = sstable->get_filename();
+            try
+            {
+                if (std::filesystem::remove(old_filename))
+                {
+                    if (options_.verbose)
+                    {
+                        std::cout << "Deleted old SSTable file: " << old_filename << "\n";
+                    }
+                }
+                else
+                {
+                    std::cerr << "Warning: Failed to delete old SSTable file: " << old_filename << "\n";
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Warning: Error deleting old SSTable file " << old_filename << ": " << e.what() << "\n";
+            }
+        }
+
+        if (options_.verbose)
+        {
+            std::cout << "Compaction completed. Merged into " << outputs.size() << " SSTable(s)";
+            if (options_.compaction_filter)
+            {
+                std::cout << ", " << options_.compaction_filter->name() << " filter dropped " << entries_dropped
+                          << " and changed " << entries_changed << " entries";
+            }
+            std::cout << ".\n";
+        }
+    }
+
+public:
+    void load_existing_sstables()
+    {
+        // Scan directory for existing SSTable files and load them
+        if (!std::filesystem::exists(base_dir_))
+        {
+            return;
+        }
+
+        // Paths of the tables and whether they are in the cold tier
+        std::vector<std::pair<std::string, bool>> sstable_files;
+        auto scan_directory = [&](const std::string &dir, bool cold)
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(dir))
+            {
+                if (entry.is_regular_file())
+                {
+                    const std::string filename = entry.path().filename().string();
+                    if (filename.ends_with(".dat"))
+                    {
+                        sstable_files.emplace_back(entry.path().string(), cold);
+                    }
+                }
+            }
+        };
+        scan_directory(base_dir_, false);
+        if (!options_.cold_dir.empty() && std::filesystem::exists(options_.cold_dir))
+        {
+            scan_directory(options_.cold_dir, true);
+        }
+
+        // Lookups scan from the back, so load the compacted run first and then
+        // the level-0 tables in ascending id order. A plain string sort would
+        // put sstable_10 before sstable_9.
+        const auto file_order = [](const std::string &path) {
+            const std::string filename = std::filesystem::path(path).filename().string();
+            const size_t underscore = filename.find('_');
+            const size_t dot = filename.find('.', underscore);
+            unsigned long id = 0;
+            if (underscore != std::string::npos && dot != std::string::npos)
+            {
+                try
+                {
+                    id = std::stoul(filename.substr(underscore + 1, dot - underscore - 1));
+                }
+                catch (...)
+                {
+                }
+            }
+            return std::make_tuple(!filename.starts_with("compacted_"), id, filename);
+        };
+        std::sort(sstable_files.begin(), sstable_files.end(),
+                  [&](const auto &a, const auto &b) { return file_order(a.first) < file_order(b.first); });
+
+        // Load each SSTable
+        for (const auto &[filepath, cold] : sstable_files)
+        {
+            try
+            {
+                const bool is_compacted = std::filesystem::path(filepath).filename().string().starts_with("compacted_");
+                auto sstable = open_table(filepath, is_compacted ? 1 : 0, cold);
+                // Test that the file can be read
+                sstable->size(); // This will trigger cache loading
+                sstables_.push_back(std::move(sstable));
+
+                // Update next_sstable_id_ to avoid conflicts
+                std::string filename = std::filesystem::path(filepath).filename().string();
+                if (filename.starts_with("sstable_") || filename.starts_with("compacted_"))
+                {
+                    // Extract number from filename
+                    size_t underscore = filename.find('_');
+                    size_t dot = filename.find('.', underscore);
+                    if (underscore != std::string::npos && dot != std::string::npos)
+                    {
+                        try
+                        {
+                            int file_id = std::stoi(filename.substr(underscore + 1, dot - underscore - 1));
+                            next_sstable_id_ = std::max(next_sstable_id_.load(), file_id + 1);
+                        }
+                        catch (...)
+                        {
+                            // Ignore parsing errors
+                        }
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "Warning: Failed to load SSTable " << filepath << ": " << e.what() << "\n";
+            }
+        }
+
+        if (!sstables_.empty())
+        {
+            std::clog << "Loaded " << sstables_.size() << " existing SSTables\n";
+        }
+    }
+
+    LSMStats get_stats() const
+    {
+        LSMStats stats;
+        stats.puts = counters_.puts.load(std::memory_order_relaxed);
+        stats.gets = counters_.gets.load(std::memory_order_relaxed);
+        stats.user_bytes_written = counters_.user_bytes_written.load(std::memory_order_relaxed);
+        stats.flush_count = counters_.flush_count.load(std::memory_order_relaxed);
+        stats.flush_bytes_written = counters_.flush_bytes_written.load(std::memory_order_relaxed);
+        stats.compaction_count = counters_.compaction_count.load(std::memory_order_relaxed);
+        stats.subcompaction_count = counters_.subcompaction_count.load(std::memory_order_relaxed);
+        stats.compaction_bytes_read = counters_.compaction_bytes_read.load(std::memory_order_relaxed);
+        stats.compaction_bytes_written = counters_.compaction_bytes_written.load(std::memory_order_relaxed);
+        stats.compaction_entries_dropped = counters_.compaction_entries_dropped.load(std::memory_order_relaxed);
+        stats.compaction_entries_changed = counters_.compaction_entries_changed.load(std::memory_order_relaxed);
+        stats.sstable_probes = counters_.sstable_probes.load(std::memory_order_relaxed);
+        stats.filter_checks = counters_.filter_checks.load(std::memory_order_relaxed);
+        stats.filter_rejects = counters_.filter_rejects.load(std::memory_order_relaxed);
+        stats.cache_hits = options_.block_cache->hits();
+        stats.cache_misses = options_.block_cache->misses();
+        stats.block_cache_usage = options_.block_cache->usage();
+        stats.block_cache_capacity = options_.block_cache->capacity();
+        stats.memtable_threshold = options_.memtable_threshold;
+        if (options_.rate_limiter)
+        {
+            stats.rate_limit_bytes_per_second = options_.rate_limiter->bytes_per_second();
+            stats.rate_limited_flush_bytes = options_.rate_limiter->bytes_granted(IOPriority::high);
+            stats.rate_limited_compaction_bytes = options_.rate_limiter->bytes_granted(IOPriority::low);
+            stats.rate_limit_wait_ns = static_cast<uint64_t>(options_.rate_limiter->total_wait().count());
+        }
+        stats.get_latency = counters_.get_latency.snapshot();
+        stats.put_latency = counters_.put_latency.snapshot();
+        stats.compaction_duration = counters_.compaction_duration.snapshot();
+#if LSM_GET_PATH_STATS
+        stats.get_paths = counters_.get_paths.snapshot();
+#endif
+
+        std::shared_lock lock(mutex_);
+        stats.memtable_bytes = memtable_->size() + (immutable_memtable_ ? immutable_memtable_->size() : 0);
+        stats.memtable_entries = memtable_->entry_count() + (immutable_memtable_ ? immutable_memtable_->entry_count() : 0);
+        stats.memtable_allocations = counters_.memtable_allocations.load(std::memory_order_relaxed) + memtable_->allocations() +
+                                     (immutable_memtable_ ? immutable_memtable_->allocations() : 0);
+        for (const auto &sstable : sstables_)
+        {
+            const auto level = static_cast<size_t>(sstable->get_level());
+            while (stats.levels.size() <= level)
+            {
+                stats.levels.push_back(LevelStats{static_cast<int>(stats.levels.size())});
+            }
+            auto &level_stats = stats.levels[level];
+            level_stats.file_count++;
+            level_stats.bytes += sstable->file_bytes();
+            level_stats.entries += sstable->size();
+            if (sstable->access() == TableAccess::pread)
+            {
+                stats.cold_file_count++;
+                stats.cold_bytes += sstable->file_bytes();
+            }
+        }
+        return stats;
+    }
+
+    // Debug function to print current state
+    void print_stats() const
+    {
+        {
+            std::shared_lock lock(mutex_);
+            std::cout << "LSM Tree Stats:\n";
+            std::cout << "  MemTable size: " << memtable_->size() << " bytes\n";
+            std::cout << "  SSTables count: " << sstables_.size() << "\n";
+            for (size_t i = 0; i < sstables_.size(); ++i)
+            {
+                std::cout << "    SSTable " << i << ": " << sstables_[i]->size()
+                          << " entries (" << sstables_[i]->get_filename() << ")\n";
+            }
+        }
+        get_stats().print(std::cout);
+    }
+};
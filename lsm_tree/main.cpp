@@ -1,1176 +1,1638 @@
-#include <algorithm>
-#include <fstream>
-#include <iostream>
-#include <map>
-#include <memory>
-#include <optional>
-#include <string>
-#include <vector>
-#include <filesystem>
-#include <sstream>
-#include <span>
-#include <cstring>
-#include <stdexcept>
-#include <cstdint>
-#include <chrono>
-#include <ranges>
-
-// Linux memory mapping includes
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <unistd.h>
-
-// Include the german_string header
-#include "german_string.h"
-
-// Forward declarations
-template <typename StringType>
-class SSTable;
-template <typename StringType>
-class LSMTree;
+// Signal handling for the serve command
+#include <csignal>
 
-// Memory-mapped file wrapper for Linux
-class MappedFile
+// The storage engine and the RESP server, shared with the tests
+#include "lsm_tree.h"
+#include "lsm_server.h"
+
+// CSV parsing helper function
+template <typename StringType>
+std::pair<StringType, StringType> parse_csv_line(const std::string &line)
 {
-private:
-    int fd_;
-    void *data_;
-    size_t size_;
-    bool writable_;
+    std::string key, value;
+    size_t comma_pos = line.find(';');
 
-public:
-    MappedFile(const std::string &filename, bool write_mode = false)
-        : fd_(-1), data_(nullptr), size_(0), writable_(write_mode)
+    if (comma_pos == std::string::npos)
     {
+        // No comma found, treat entire line as key with empty value
+        key = line;
+        value = "";
+    }
+    else
+    {
+        key = line.substr(0, comma_pos);
+        value = line.substr(comma_pos + 1);
+    }
 
-        int flags = write_mode ? (O_RDWR | O_CREAT) : O_RDONLY;
-        mode_t mode = write_mode ? (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) : 0;
-
-        fd_ = open(filename.c_str(), flags, mode);
-        if (fd_ == -1)
-        {
-            throw std::runtime_error("Failed to open file: " + filename + " - " + strerror(errno));
-        }
-
-        struct stat sb;
-        if (fstat(fd_, &sb) == -1)
+    // Simple CSV unescaping - remove surrounding quotes if present
+    auto trim_quotes = [](std::string &s)
+    {
+        if (s.size() >= 2 && s.front() == '"' && s.back() == '"')
         {
-            close(fd_);
-            throw std::runtime_error("Failed to get file stats: " + std::string(strerror(errno)));
+            s = s.substr(1, s.size() - 2);
         }
+    };
 
-        size_ = sb.st_size;
+    trim_quotes(key);
+    trim_quotes(value);
 
-        if (size_ == 0 && !write_mode)
-        {
-            // Empty file, nothing to map
-            close(fd_);
-            fd_ = -1;
-            return;
-        }
+    // Convert to target string type
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return {key, value};
+    }
+    else
+    {
+        auto result = std::make_pair(StringType(key), StringType(value));
+        return result;
+    }
+}
 
-        int prot = write_mode ? (PROT_READ | PROT_WRITE) : PROT_READ;
-        int flags_mmap = write_mode ? MAP_SHARED : MAP_PRIVATE;
+// Bulk ingest data from CSV file
+// With bulk, all records are sorted and written as one SSTable instead of going through the memtable
+template <typename StringType>
+void bulk_ingest_csv(const std::string &csv_filename, const std::string &lsm_dir = "./lsm_data", bool bulk = false,
+                     const LSMOptions &options = LSMOptions())
+{
+    std::cout << "=== CSV Bulk Ingestion ===\n";
+    std::cout << "Reading from: " << csv_filename << "\n";
+    std::cout << "LSM directory: " << lsm_dir << "\n\n";
 
-        data_ = mmap(nullptr, size_, prot, flags_mmap, fd_, 0);
-        if (data_ == MAP_FAILED)
-        {
-            close(fd_);
-            throw std::runtime_error("Failed to map file: " + std::string(strerror(errno)));
-        }
+    // Open CSV file
+    std::ifstream file(csv_filename);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open CSV file: " + csv_filename);
     }
 
-    // Constructor for creating a new file with a specific size
-    MappedFile(const std::string &filename, size_t size, bool use_temp_file = true)
-        : fd_(-1), data_(nullptr), size_(size), writable_(true)
+    // Create LSM tree
+    LSMTree<StringType> lsm(lsm_dir, options);
+
+    // Statistics
+    size_t line_count = 0;
+    size_t processed_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::pair<StringType, StringType>> bulk_entries;
+    constexpr size_t INGEST_BATCH_SIZE = 1000;
+    WriteBatch batch;
+
+    std::string line;
+    while (std::getline(file, line))
     {
-        std::string actual_filename = use_temp_file ? filename + ".tmp" : filename;
+        line_count++;
 
-        // Create and resize the file
-        fd_ = open(actual_filename.c_str(), O_CREAT | O_TRUNC | O_RDWR,
-                   S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-        if (fd_ == -1)
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#')
         {
-            throw std::runtime_error("Failed to create file: " + actual_filename + " - " + strerror(errno));
+            continue;
         }
 
-        if (size > 0)
+        try
         {
-            // Resize file to needed size
-            if (ftruncate(fd_, static_cast<off_t>(size)) == -1)
+            auto [key, value] = parse_csv_line<StringType>(line);
+            if (!key.empty() && bulk)
             {
-                close(fd_);
-                throw std::runtime_error("Failed to resize file: " + std::string(strerror(errno)));
+                bulk_entries.emplace_back(std::move(key), std::move(value));
+                processed_count++;
             }
-
-            // Memory map the file
-            data_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
-            if (data_ == MAP_FAILED)
+            else if (!key.empty())
             {
-                close(fd_);
-                throw std::runtime_error("Failed to map file: " + std::string(strerror(errno)));
-            }
-        }
-    }
+                batch.put(std::string_view(key.data(), key.size()), std::string_view(value.data(), value.size()));
+                processed_count++;
+                if (batch.count() >= INGEST_BATCH_SIZE)
+                {
+                    lsm.write(batch);
+                    batch.clear();
+                }
 
-    ~MappedFile()
-    {
-        if (data_ != nullptr && data_ != MAP_FAILED)
-        {
-            munmap(data_, size_);
+                // Progress report every 10000 records
+                if (processed_count % 10000 == 0)
+                {
+                    std::cout << "Processed " << processed_count << " records...\n";
+                    lsm.print_stats();
+                    std::cout << "\n";
+                }
+            }
         }
-        if (fd_ >= 0)
+        catch (const std::exception &e)
         {
-            close(fd_);
+            std::cerr << "Warning: Failed to process line " << line_count
+                      << ": " << e.what() << "\n";
         }
     }
 
-    // Non-copyable, movable
-    MappedFile(const MappedFile &) = delete;
-    MappedFile &operator=(const MappedFile &) = delete;
-
-    MappedFile(MappedFile &&other) noexcept
-        : fd_(other.fd_), data_(other.data_), size_(other.size_), writable_(other.writable_)
+    if (bulk)
     {
-        other.fd_ = -1;
-        other.data_ = nullptr;
-        other.size_ = 0;
+        lsm.bulk_load(std::move(bulk_entries));
     }
+    lsm.write(batch);
 
-    MappedFile &operator=(MappedFile &&other) noexcept
-    {
-        if (this != &other)
-        {
-            if (data_ != nullptr && data_ != MAP_FAILED)
-            {
-                munmap(data_, size_);
-            }
-            if (fd_ >= 0)
-            {
-                close(fd_);
-            }
+    // Final flush to ensure all data is persisted
+    lsm.flush_memtable();
 
-            fd_ = other.fd_;
-            data_ = other.data_;
-            size_ = other.size_;
-            writable_ = other.writable_;
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
-            other.fd_ = -1;
-            other.data_ = nullptr;
-            other.size_ = 0;
-        }
-        return *this;
-    }
+    std::cout << "=== Ingestion Complete ===\n";
+    std::cout << "Total lines read: " << line_count << "\n";
+    std::cout << "Records processed: " << processed_count << "\n";
+    std::cout << "Time taken: " << duration.count() << " ms\n";
+    auto duration_count = duration.count();
+    std::cout << "Records per second: " << (duration_count > 0 ? processed_count * 1000 / duration_count : 0) << "\n\n";
+
+    lsm.print_stats();
+}
+
+// Interactive query mode
+template <typename StringType>
+void interactive_query(const std::string &lsm_dir = "./lsm_data", const LSMOptions &options = LSMOptions())
+{
+    std::cout << "=== Interactive Query Mode ===\n";
+    std::cout << "Type keys to query, 'stats' for statistics, or 'quit' to exit.\n\n";
+
+    LSMTree<StringType> lsm(lsm_dir, options);
+    lsm.print_stats();
+    std::cout << "\n";
 
-    std::span<const char> data() const
+    std::string input;
+    while (true)
     {
-        if (data_ == nullptr || size_ == 0)
+        std::cout << "query> ";
+        if (!std::getline(std::cin, input))
         {
-            return {};
+            break; // EOF
         }
-        return {static_cast<const char *>(data_), size_};
-    }
 
-    std::span<char> writable_data()
-    {
-        if (!writable_ || data_ == nullptr || size_ == 0)
+        if (input == "quit" || input == "exit")
         {
-            return {};
+            break;
         }
-        return {static_cast<char *>(data_), size_};
-    }
-
-    size_t size() const { return size_; }
-    bool empty() const { return size_ == 0; }
-    bool is_writable() const { return writable_; }
 
-    // Sync data to disk (for writable files)
-    void sync()
-    {
-        if (writable_ && data_ != nullptr && data_ != MAP_FAILED && size_ > 0)
+        if (input == "stats")
         {
-            if (msync(data_, size_, MS_SYNC) == -1)
-            {
-                throw std::runtime_error("Failed to sync file: " + std::string(strerror(errno)));
-            }
+            lsm.print_stats();
+            continue;
         }
-    }
 
-    // Static method to create and write structured data atomically
-    template <typename StringType>
-    static void write_key_value_data(const std::string &filename, const std::map<StringType, StringType> &data)
-    {
-        // Calculate total size needed for binary format: |record_count|key_len|value_len|key|value|...
-        size_t total_size = sizeof(uint32_t); // Header for record count
-        for (const auto &[key, value] : data)
+        if (input.empty())
         {
-            total_size += sizeof(uint32_t) + sizeof(uint32_t) + key.size() + value.size();
+            continue;
         }
 
-        if (data.empty())
+        StringType query_key;
+        if constexpr (std::is_same_v<StringType, std::string>)
         {
-            // Create empty file with just the header
-            int fd = open((filename + ".tmp").c_str(), O_CREAT | O_TRUNC | O_WRONLY,
-                          S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
-            if (fd >= 0)
-            {
-                uint32_t record_count = 0;
-                write(fd, &record_count, sizeof(uint32_t));
-                close(fd);
-            }
-            std::filesystem::rename(filename + ".tmp", filename);
-            return;
+            query_key = input;
         }
-
-        // Create memory-mapped file with the calculated size
-        MappedFile mapped_file(filename, total_size, true);
-
-        // Write data in binary format: |record_count|key_len|value_len|key|value|...
-        auto writable_span = mapped_file.writable_data();
-        char *ptr = writable_span.data();
-
-        // Write record count header (4 bytes, little endian)
-        uint32_t record_count = static_cast<uint32_t>(data.size());
-        std::memcpy(ptr, &record_count, sizeof(uint32_t));
-        ptr += sizeof(uint32_t);
-
-        for (const auto &[key, value] : data)
+        else
         {
-            // Write key length (4 bytes, little endian)
-            uint32_t key_len = static_cast<uint32_t>(key.size());
-            std::memcpy(ptr, &key_len, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-
-            // Write value length (4 bytes, little endian)
-            uint32_t value_len = static_cast<uint32_t>(value.size());
-            std::memcpy(ptr, &value_len, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-
-            // Write key data
-            std::memcpy(ptr, key.data(), key.size());
-            ptr += key.size();
-
-            // Write value data
-            std::memcpy(ptr, value.data(), value.size());
-            ptr += value.size();
+            query_key = StringType(input.c_str(), input.size(), gs::string_class::transient);
         }
-
-        // Ensure data is written to disk
-        mapped_file.sync();
-
-        // The destructor will clean up the memory mapping and close the file descriptor
-        // Now we need to atomically rename the temp file to the final filename
-        std::filesystem::rename(filename + ".tmp", filename);
-    }
-};
-
-auto as_transient = []<typename T>(const T &str) -> T
-{
-    if constexpr (std::is_same_v<T, gs::german_string>)
-    {
-        return str.as_transient();
-    }
-    else
-    {
-        return str;
-    }
-};
-
-// MemTable: In-memory sorted storage
-template <typename StringType>
-class MemTable
-{
-private:
-    std::map<StringType, StringType> data_;
-    size_t size_threshold_;
-    size_t current_size_;
-
-public:
-    explicit MemTable(size_t threshold = 8 * 1024 * 1024) // 4 MB default threshold
-        : size_threshold_(threshold), current_size_(0)
-    {
-    }
-
-public:
-    void put(StringType &&key, StringType &&value)
-    {
-        auto emplace_result = data_.try_emplace(key, std::move(value));
-        if (!emplace_result.second)
+        auto result = lsm.get(query_key);
+        if (result.has_value())
         {
-            current_size_ -= calculate_entry_size(key, emplace_result.first->second);
-            // Key already exists, update the value
-            emplace_result.first->second = std::move(value);
+            std::cout << "Found: " << result.value() << "\n";
         }
-        current_size_ += calculate_entry_size(key, value);
-    }
-
-private:
-    // Count entries instead of memory footprint to ensure equal flush behavior
-    size_t calculate_entry_size(const StringType &key, const StringType& val) const
-    {
-        return key.size() + val.size() + sizeof(StringType) * 2;
-    }
-
-public:
-
-    std::optional<StringType> get(const StringType &key) const
-    {
-        auto it = data_.find(key);
-        if (it != data_.end())
+        else
         {
-            return as_transient(it->second);
+            std::cout << "Not found\n";
         }
-        return std::nullopt;
     }
 
-    bool is_full() const
-    {
-        return current_size_ >= size_threshold_;
-    }
-
-    bool empty() const
-    {
-        return data_.empty();
-    }
+    std::cout << "Goodbye!\n";
+}
 
-    size_t size() const
-    {
-        return current_size_;
-    }
+// Bulk read keys from file
+template <typename StringType>
+void bulk_read_keys(const std::string &keys_filename, const std::string &lsm_dir = "./lsm_data", const LSMOptions &options = LSMOptions())
+{
+    std::cout << "=== Bulk Key Reading ===\n";
+    std::cout << "Reading keys from: " << keys_filename << "\n";
+    std::cout << "LSM directory: " << lsm_dir << "\n\n";
 
-    // Get all data for flushing to SSTable
-    const std::map<StringType, StringType>& get_all_data() const
+    // Open keys file
+    std::ifstream file(keys_filename);
+    if (!file.is_open())
     {
-        return data_;
+        throw std::runtime_error("Failed to open keys file: " + keys_filename);
     }
 
-    void clear()
-    {
-        data_.clear();
-        current_size_ = 0;
-    }
-};
+    // Create LSM tree
+    LSMTree<StringType> lsm(lsm_dir, options);
 
-// SSTable: Immutable sorted string table on disk using memory-mapped files
-template <typename StringType>
-class SSTable
-{
-private:
-    std::string filename_;
-    mutable std::vector<std::pair<StringType, StringType>> data_cache_; // Cache for parsed data (sorted by key)
-    mutable bool cache_loaded_;
-    mutable std::unique_ptr<MappedFile> mapped_file_; // Persistent mapping
-    int level_;
+    // Statistics
+    size_t line_count = 0;
+    size_t found_count = 0;
+    size_t not_found_count = 0;
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-    // Parse memory-mapped file data into cache
-    void load_cache() const
+    std::string line;
+    while (std::getline(file, line))
     {
-        if (cache_loaded_)
-        {
-            return;
-        }
-
-        try
-        {
-            // Create and keep the mapped file instance
-            mapped_file_ = std::make_unique<MappedFile>(filename_, false);
-            if (mapped_file_->empty())
-            {
-                cache_loaded_ = true;
-                return;
-            }
+        line_count++;
 
-            auto data_span = mapped_file_->data();
-            parse_data_from_span(data_span);
-            cache_loaded_ = true;
-        }
-        catch (const std::exception &e)
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#')
         {
-            // File doesn't exist or can't be read, leave cache empty
-            // Reset the mapped file pointer on error
-            mapped_file_.reset();
-            cache_loaded_ = true;
+            continue;
         }
-    }
 
-    void parse_data_from_span(std::span<const char> data_span) const
-    {
-        const char *ptr = data_span.data();
-        const char *end = ptr + data_span.size();
+        // Trim whitespace
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
 
-        // Check if we have at least the header
-        if (ptr + sizeof(uint32_t) > end)
+        if (line.empty())
         {
-            // File too small, corrupted
-            return;
+            continue;
         }
 
-        // Read record count header (4 bytes, little endian)
-        uint32_t record_count;
-        std::memcpy(&record_count, ptr, sizeof(uint32_t));
-        ptr += sizeof(uint32_t);
-
-        // Reserve space in vector for better performance
-        data_cache_.reserve(record_count);
-
-        // Parse records
-        for (uint32_t i = 0; i < record_count && ptr + sizeof(uint32_t) * 2 <= end; ++i)
+        try
         {
-            // Read key length (4 bytes, little endian)
-            uint32_t key_len;
-            std::memcpy(&key_len, ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-
-            // Read value length (4 bytes, little endian)
-            uint32_t value_len;
-            std::memcpy(&value_len, ptr, sizeof(uint32_t));
-            ptr += sizeof(uint32_t);
-
-            // Check if we have enough data for key and value
-            if (ptr + key_len + value_len > end)
+            StringType query_key;
+            if constexpr (std::is_same_v<StringType, std::string>)
             {
-                // Corrupted data, stop parsing
-                break;
-            }
-
-            // Read key data
-            StringType key;
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                key = StringType(ptr, key_len);
+                query_key = line;
             }
             else
             {
-                key = StringType(ptr, key_len, gs::string_class::transient);
+                query_key = StringType(line.c_str(), line.size(), gs::string_class::transient);
             }
-            ptr += key_len;
 
-            // Read value data
-            StringType value;
-            if constexpr (std::is_same_v<StringType, std::string>)
+            auto result = lsm.get(query_key);
+            if (result.has_value())
             {
-                value = StringType(ptr, value_len);
+                std::cout << "Found: " << line << " -> " << result.value() << "\n";
+                found_count++;
             }
             else
             {
-                value = StringType(ptr, value_len, gs::string_class::transient);
+                std::cout << "Not found: " << line << "\n";
+                not_found_count++;
             }
-            ptr += value_len;
 
-            data_cache_.emplace_back(key, value);
+            // Progress report every 1000 queries
+            if ((found_count + not_found_count) % 1000 == 0)
+            {
+                std::cout << "Processed " << (found_count + not_found_count) << " queries...\n";
+            }
         }
-        
-        // Data should already be sorted by construction, but let's verify this assumption
-        // In debug builds, we can add an assertion to check this
-        #ifndef NDEBUG
-        if (!std::is_sorted(data_cache_.begin(), data_cache_.end(),
-                           [](const auto &a, const auto &b) { return a.first < b.first; }))
+        catch (const std::exception &e)
         {
-            throw std::runtime_error("SSTable data is not sorted - this violates the invariant");
+            std::cerr << "Warning: Failed to process line " << line_count
+                      << " (" << line << "): " << e.what() << "\n";
         }
-        #endif
     }
 
-public:
-    SSTable(const std::string &filename, int level = 0)
-        : filename_(filename), cache_loaded_(false), mapped_file_(nullptr), level_(level) {}
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
 
-    // Create SSTable from MemTable data using memory-mapped files
-    static std::unique_ptr<SSTable> create_from_memtable(
-        const std::map<StringType, StringType> &data,
-        const std::string &filename,
-        int level = 0)
-    {
-        // Write data using unified memory-mapped file
-        MappedFile::write_key_value_data(filename, data);
+    std::cout << "\n=== Bulk Read Complete ===\n";
+    std::cout << "Total lines read: " << line_count << "\n";
+    std::cout << "Keys found: " << found_count << "\n";
+    std::cout << "Keys not found: " << not_found_count << "\n";
+    std::cout << "Total queries: " << (found_count + not_found_count) << "\n";
+    std::cout << "Time taken: " << duration.count() << " ms\n";
+    auto duration_count = duration.count();
+    std::cout << "Queries per second: " << (duration_count > 0 ? (found_count + not_found_count) * 1000 / duration_count : 0) << "\n\n";
+}
 
-        auto sstable = std::make_unique<SSTable>(filename, level);
-        return sstable;
+// Checks every SSTable in lsm_dir and the cold tier directory, if any, on a pool of threads,
+// returns the number of damaged files
+template <typename StringType>
+size_t verify_sstables(const std::string &lsm_dir, const std::string &cold_dir, size_t thread_count)
+{
+    std::vector<std::string> files;
+    for (const auto &dir : {lsm_dir, cold_dir})
+    {
+        if (dir.empty() || !std::filesystem::exists(dir))
+        {
+            continue;
+        }
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".dat")
+            {
+                files.push_back(entry.path().string());
+            }
+        }
     }
+    std::sort(files.begin(), files.end());
+
+    std::cout << "Verifying " << files.size() << " SSTables in " << lsm_dir << (cold_dir.empty() ? "" : " and " + cold_dir) << " with "
+              << std::max<size_t>(std::min(thread_count, files.size()), 1) << " thread(s), crc32c: "
+              << (crc32c_hardware_supported() ? "sse4.2" : "slicing-by-8") << "\n";
 
-    std::optional<StringType> get(const StringType &key) const
+    std::vector<std::optional<SSTableVerifyResult>> results(files.size());
+    std::vector<std::string> errors(files.size());
+    std::atomic<size_t> next_file{0};
+    const auto worker = [&]
     {
-        load_cache();
-        auto it = std::lower_bound(data_cache_.begin(), data_cache_.end(), key,
-                                  [](const auto &pair, const StringType &k) 
-                                  {
-                                      return pair.first < k;
-                                  });
-        if (it != data_cache_.end() && it->first == key)
+        for (size_t i = next_file++; i < files.size(); i = next_file++)
         {
-            return it->second;
+            try
+            {
+                results[i] = SSTable<StringType>(files[i]).verify();
+            }
+            catch (const std::exception &e)
+            {
+                errors[i] = e.what();
+            }
         }
-        return std::nullopt;
-    }
+    };
 
-    const std::vector<std::pair<StringType, StringType>> &get_all_data() const
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min(thread_count, files.size()); ++t)
     {
-        load_cache();
-        return data_cache_;
+        threads.emplace_back(worker);
     }
-
-    const std::string &get_filename() const
+    worker();
+    for (auto &thread : threads)
     {
-        return filename_;
+        thread.join();
     }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
 
-    int get_level() const
+    SSTableVerifyResult total;
+    size_t corrupted = 0;
+    size_t unchecked = 0;
+    for (size_t i = 0; i < files.size(); ++i)
     {
-        return level_;
+        if (!results[i])
+        {
+            std::cout << "  CORRUPT " << files[i] << ": " << errors[i] << "\n";
+            corrupted++;
+            continue;
+        }
+        total.blocks += results[i]->blocks;
+        total.entries += results[i]->entries;
+        total.bytes += results[i]->bytes;
+        unchecked += results[i]->checksummed ? 0u : 1u;
     }
 
-    size_t size() const
+    const double mb = static_cast<double>(total.bytes) / (1024.0 * 1024.0);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Verified " << files.size() - corrupted << " of " << files.size() << " files: " << total.blocks
+              << " blocks, " << total.entries << " entries, " << mb << " MB in " << seconds * 1000.0 << " ms ("
+              << (seconds > 0.0 ? mb / seconds : 0.0) << " MB/s)\n";
+    std::cout << std::defaultfloat;
+    if (unchecked > 0)
     {
-        load_cache();
-        return data_cache_.size();
+        std::cout << unchecked << " file(s) predate block checksums and were only decoded\n";
     }
+    return corrupted;
+}
+
+// Demo function
+template <typename StringType>
+void demo_lsm_tree()
+{
+    std::cout << "=== LSM Tree Demo ===\n\n";
 
-    // Force reload from disk (useful for testing)
-    void reload_from_disk() const
+    LSMTree<StringType> lsm;
+
+    // Insert some data
+    std::cout << "Inserting data...\n";
+    lsm.put("apple", "red fruit");
+    lsm.put("banana", "yellow fruit");
+    lsm.put("cherry", "red fruit");
+    lsm.put("date", "sweet fruit");
+    lsm.put("elderberry", "small fruit");
+
+    lsm.print_stats();
+    std::cout << "\n";
+
+    // Query some data
+    std::cout << "Querying data:\n";
+    auto result = lsm.get("apple");
+    if (result.has_value())
     {
-        cache_loaded_ = false;
-        data_cache_.clear();
-        mapped_file_.reset(); // Release the existing mapping
-        load_cache();
+        std::cout << "apple: " << result.value() << "\n";
     }
 
-    // Check if the file is currently memory-mapped
-    bool is_mapped() const
+    result = lsm.get("banana");
+    if (result.has_value())
     {
-        return mapped_file_ != nullptr;
+        std::cout << "banana: " << result.value() << "\n";
     }
 
-    // Release the memory mapping (but keep the cache)
-    void release_mapping() const
+    result = lsm.get("nonexistent");
+    if (!result.has_value())
     {
-        mapped_file_.reset();
+        std::cout << "nonexistent: not found\n";
     }
-};
 
-// LSM Tree implementation
-template <typename StringType>
-class LSMTree
-{
-private:
-    MemTable<StringType> memtable_;
-    std::vector<std::unique_ptr<SSTable<StringType>>> sstables_;
-    std::string base_dir_;
-    int next_sstable_id_;
+    std::cout << "\n";
 
-public:
-    explicit LSMTree(const std::string &base_dir = "./lsm_data")
-        : base_dir_(base_dir), next_sstable_id_(0)
+    // Add more data to trigger flushes
+    std::cout << "Adding more data to trigger MemTable flush...\n";
+    for (int i = 0; i < 100; ++i)
     {
+        lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+    }
 
-        // Create directory if it doesn't exist
-        std::filesystem::create_directories(base_dir_);
+    lsm.print_stats();
+    std::cout << "\n";
 
-        // Load existing SSTables
-        load_existing_sstables();
-    }
+    // Force flush
+    std::cout << "Forcing MemTable flush...\n";
+    lsm.flush_memtable();
+    lsm.print_stats();
+
+    std::cout << "\n";
 
-    void put(StringType key, StringType value)
+    // Add even more data to trigger compaction
+    std::cout << "Adding more data to trigger compaction...\n";
+    for (int i = 100; i < 500; ++i)
     {
-        // Insert into MemTable
-        memtable_.put(std::move(key), std::move(value));
+        lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+    }
 
-        // Check if MemTable is full and needs to be flushed
-        if (memtable_.is_full())
+    // Force multiple flushes
+    for (int i = 0; i < 5; ++i)
+    {
+        lsm.flush_memtable();
+        for (int j = 0; j < 20; ++j)
         {
-            flush_memtable();
+            lsm.put("batch" + std::to_string(i) + "_key" + std::to_string(j),
+                    "batch" + std::to_string(i) + "_value" + std::to_string(j));
         }
     }
 
-    std::optional<StringType> get(const StringType &key)
+    lsm.print_stats();
+    std::cout << "\n";
+
+    // Test retrieval after compaction
+    std::cout << "Testing retrieval after operations:\n";
+    result = lsm.get("key50");
+    if (result.has_value())
     {
-        auto result = memtable_.get(key);
-        if (result.has_value())
+        std::cout << "key50: " << result.value() << "\n";
+    }
+
+    result = lsm.get("batch2_key10");
+    if (result.has_value())
+    {
+        std::cout << "batch2_key10: " << result.value() << "\n";
+    }
+
+    std::cout << "\n";
+
+    // Test persistence by creating a new LSM tree instance
+    std::cout << "Testing persistence with new LSM tree instance:\n";
+    {
+        LSMTree<StringType> lsm2; // Should load existing SSTables
+        lsm2.print_stats();
+
+        // Test that we can still retrieve data
+        auto persistent_result = lsm2.get("apple");
+        if (persistent_result.has_value())
         {
-            return result;
+            std::cout << "apple (from persistent storage): " << persistent_result.value() << "\n";
         }
 
-        for (auto& sstable : std::views::reverse(sstables_))
+        persistent_result = lsm2.get("key50");
+        if (persistent_result.has_value())
         {
-            result = sstable->get(key);
-            if (result.has_value())
-            {
-                return result;
-            }
+            std::cout << "key50 (from persistent storage): " << persistent_result.value() << "\n";
         }
-        return std::nullopt;
     }
+}
 
-    void delete_key(const StringType &key)
+template <typename StringType>
+constexpr const char *string_type_name()
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
     {
-        // In LSM-trees, deletion is implemented as putting a tombstone marker
-        // For simplicity, we'll use an empty string as the tombstone
-        // In a real implementation, you'd use a special marker to distinguish
-        // between empty values and deleted keys
-        put(key, ""); // Empty value acts as tombstone
+        return "std::string";
     }
-
-    void flush_memtable()
+    else
     {
-        if (memtable_.empty())
-        {
-            return;
-        }
+        return "gs::german_string";
+    }
+}
 
-        // Create new SSTable from MemTable data
-        std::string filename = base_dir_ + "/sstable_" + std::to_string(next_sstable_id_++) + ".dat";
-        auto sstable = SSTable<StringType>::create_from_memtable(memtable_.get_all_data(), filename);
+template <typename StringType>
+constexpr const char *string_type_tag()
+{
+    if constexpr (std::is_same_v<StringType, std::string>)
+    {
+        return "std";
+    }
+    else
+    {
+        return "gs";
+    }
+}
 
-        sstables_.push_back(std::move(sstable));
-        memtable_.clear();
+// YCSB Zipfian generator (Gray et al., "Quickly Generating Billion-Record Synthetic Databases").
+// Item 0 is the most popular one, the generator is immutable after construction and can be shared.
+class ZipfianGenerator
+{
+private:
+    uint64_t items_;
+    double theta_;
+    double zetan_;
+    double alpha_;
+    double eta_;
 
-        // Trigger compaction if needed
-        if (should_compact())
+    static double zeta(uint64_t n, double theta)
+    {
+        double sum = 0.0;
+        for (uint64_t i = 1; i <= n; ++i)
         {
-            compact();
+            sum += 1.0 / std::pow(static_cast<double>(i), theta);
         }
+        return sum;
     }
 
-    bool should_compact() const
+public:
+    static constexpr double DEFAULT_THETA = 0.99;
+
+    explicit ZipfianGenerator(uint64_t items, double theta = DEFAULT_THETA)
+        : items_(std::max<uint64_t>(items, 2)), theta_(theta)
     {
-        // Simple compaction strategy: compact when we have more than 4 SSTables
-        return sstables_.size() > 4;
+        zetan_ = zeta(items_, theta_);
+        alpha_ = 1.0 / (1.0 - theta_);
+        eta_ = (1.0 - std::pow(2.0 / static_cast<double>(items_), 1.0 - theta_)) / (1.0 - zeta(2, theta_) / zetan_);
     }
 
-    void compact()
+    template <typename Rng>
+    uint64_t next(Rng &rng) const
     {
-        if (sstables_.size() < 2)
+        const double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        const double uz = u * zetan_;
+        if (uz < 1.0)
         {
-            return;
+            return 0;
         }
-
-        std::cout << "Compacting " << sstables_.size() << " SSTables...\n";
-
-        // Merge all SSTables into one
-        std::map<StringType, StringType> merged_data;
-
-        for (const auto &sstable : sstables_)
+        if (uz < 1.0 + std::pow(0.5, theta_))
         {
-            const auto &data = sstable->get_all_data();
-            for (const auto &[key, value] : data)
-            {
-                merged_data[key] = value; // Later values overwrite earlier ones
-            }
+            return 1;
         }
+        const auto item = static_cast<uint64_t>(static_cast<double>(items_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        return std::min(item, items_ - 1);
+    }
 
-        // Create new compacted SSTable
-        std::string filename = base_dir_ + "/compacted_" + std::to_string(next_sstable_id_++) + ".dat";
-        auto compacted_sstable = SSTable<StringType>::create_from_memtable(merged_data, filename, 1);
+    uint64_t items() const
+    {
+        return items_;
+    }
+};
 
-        // Delete old SSTable files before clearing the vector
-        for (const auto &sstable : sstables_)
-        {
-            const std::string &old_filename = sstable->get_filename();
-            try
-            {
-                if (std::filesystem::remove(old_filename))
-                {
-                    std::cout << "Deleted old SSTable file: " << old_filename << "\n";
-                }
-                else
-                {
-                    std::cerr << "Warning: Failed to delete old SSTable file: " << old_filename << "\n";
-                }
-            }
-            catch (const std::exception &e)
-            {
-                std::cerr << "Warning: Error deleting old SSTable file " << old_filename << ": " << e.what() << "\n";
-            }
-        }
+// 64-bit FNV-1a over the bytes of an integer, as used by YCSB for key hashing
+inline uint64_t fnv1a_64(uint64_t value)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (int i = 0; i < 8; ++i)
+    {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
 
-        // Remove old SSTables from memory
-        sstables_.clear();
-        sstables_.push_back(std::move(compacted_sstable));
+// Spreads popular Zipfian items over the key space instead of clustering them at the start
+inline uint64_t scramble_item(uint64_t item, uint64_t items)
+{
+    return fnv1a_64(item) % items;
+}
 
-        std::cout << "Compaction completed. Merged into 1 SSTable.\n";
+// Keys look like user000000000042, padded to the requested size
+inline std::string format_bench_key(uint64_t index, size_t key_size)
+{
+    std::string digits = std::to_string(index);
+    std::string key = "user";
+    if (key.size() + digits.size() < key_size)
+    {
+        key.append(key_size - key.size() - digits.size(), '0');
     }
+    key += digits;
+    return key;
+}
+
+enum class KeyDistribution
+{
+    sequential,
+    uniform,
+    zipfian,
+};
 
-    void load_existing_sstables()
+inline std::optional<KeyDistribution> parse_key_distribution(std::string_view name)
+{
+    if (name == "sequential")
     {
-        // Scan directory for existing SSTable files and load them
-        if (!std::filesystem::exists(base_dir_))
-        {
-            return;
-        }
+        return KeyDistribution::sequential;
+    }
+    if (name == "uniform")
+    {
+        return KeyDistribution::uniform;
+    }
+    if (name == "zipfian")
+    {
+        return KeyDistribution::zipfian;
+    }
+    return std::nullopt;
+}
 
-        std::vector<std::string> sstable_files;
+struct BenchConfig
+{
+    std::vector<std::string> workloads;
+    uint64_t num = 100000;
+    uint64_t reads = 0; // 0 means the same as num
+    size_t key_size = 16;
+    size_t value_size = 100;
+    unsigned threads = 1;
+    KeyDistribution distribution = KeyDistribution::uniform;
+    size_t seek_nexts = 10;
+    size_t memtable_bytes = 4 * 1024 * 1024;
+    uint32_t seed = 42;
+    double rate_limit_mb = 0.0; // Flush/compaction write limit, 0 disables it
+    bool rate_limit_auto_tune = false;
+    size_t subcompactions = 1;
+    size_t block_size = 4 * 1024;
+    size_t restart_interval = 16;
+    size_t bloom_bits_per_key = 10;
+    size_t index_partition_size = 4 * 1024;
+    size_t cache_bytes = 8 * 1024 * 1024;
+    uint64_t ttl_seconds = 0; // Values carry a TTL header that the compaction filter expires, 0 disables
+    size_t batch_size = 1;    // Puts per WriteBatch, 1 calls put() directly
+    bool direct_io = false;
+};
 
-        for (const auto &entry : std::filesystem::directory_iterator(base_dir_))
-        {
-            if (entry.is_regular_file())
-            {
-                const std::string filename = entry.path().filename().string();
-                if (filename.ends_with(".dat"))
-                {
-                    sstable_files.push_back(entry.path().string());
-                }
-            }
-        }
+// Picks key indices in [0, num) for one benchmark thread
+class KeyChooser
+{
+private:
+    KeyDistribution distribution_;
+    uint64_t num_;
+    uint64_t next_sequential_;
+    uint64_t stride_;
+    std::mt19937_64 rng_;
+    const ZipfianGenerator *zipfian_;
 
-        // Sort files to ensure consistent loading order
-        std::sort(sstable_files.begin(), sstable_files.end());
+public:
+    KeyChooser(KeyDistribution distribution, uint64_t num, unsigned thread_index, unsigned thread_count, uint64_t seed,
+               const ZipfianGenerator *zipfian)
+        : distribution_(distribution), num_(std::max<uint64_t>(num, 1)), next_sequential_(thread_index),
+          stride_(thread_count), rng_(seed), zipfian_(zipfian)
+    {
+    }
 
-        // Load each SSTable
-        for (const auto &filepath : sstable_files)
+    uint64_t next()
+    {
+        switch (distribution_)
         {
-            try
-            {
-                auto sstable = std::make_unique<SSTable<StringType>>(filepath, 0);
-                // Test that the file can be read
-                sstable->size(); // This will trigger cache loading
-                sstables_.push_back(std::move(sstable));
-
-                // Update next_sstable_id_ to avoid conflicts
-                std::string filename = std::filesystem::path(filepath).filename().string();
-                if (filename.starts_with("sstable_") || filename.starts_with("compacted_"))
-                {
-                    // Extract number from filename
-                    size_t underscore = filename.find('_');
-                    size_t dot = filename.find('.', underscore);
-                    if (underscore != std::string::npos && dot != std::string::npos)
-                    {
-                        try
-                        {
-                            int file_id = std::stoi(filename.substr(underscore + 1, dot - underscore - 1));
-                            next_sstable_id_ = std::max(next_sstable_id_, file_id + 1);
-                        }
-                        catch (...)
-                        {
-                            // Ignore parsing errors
-                        }
-                    }
-                }
-            }
-            catch (const std::exception &e)
-            {
-                std::cerr << "Warning: Failed to load SSTable " << filepath << ": " << e.what() << "\n";
-            }
-        }
-
-        if (!sstables_.empty())
+        case KeyDistribution::sequential:
         {
-            std::cout << "Loaded " << sstables_.size() << " existing SSTables\n";
+            uint64_t index = next_sequential_ % num_;
+            next_sequential_ += stride_;
+            return index;
+        }
+        case KeyDistribution::zipfian:
+            return scramble_item(zipfian_->next(rng_), num_);
+        case KeyDistribution::uniform:
+        default:
+            return std::uniform_int_distribution<uint64_t>(0, num_ - 1)(rng_);
         }
     }
 
-    // Debug function to print current state
-    void print_stats() const
+    std::mt19937_64 &rng()
     {
-        std::cout << "LSM Tree Stats:\n";
-        std::cout << "  MemTable size: " << memtable_.size() << " bytes\n";
-        std::cout << "  SSTables count: " << sstables_.size() << "\n";
-        for (size_t i = 0; i < sstables_.size(); ++i)
-        {
-            std::cout << "    SSTable " << i << ": " << sstables_[i]->size()
-                      << " entries (" << sstables_[i]->get_filename() << ")\n";
-        }
+        return rng_;
     }
 };
 
-// CSV parsing helper function
-template <typename StringType>
-std::pair<StringType, StringType> parse_csv_line(const std::string &line)
+// Shared pool of random printable bytes, values are slices of it
+class ValueGenerator
 {
-    std::string key, value;
-    size_t comma_pos = line.find(';');
+private:
+    std::string data_;
 
-    if (comma_pos == std::string::npos)
+public:
+    explicit ValueGenerator(uint32_t seed)
     {
-        // No comma found, treat entire line as key with empty value
-        key = line;
-        value = "";
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> chars(' ', '~');
+        data_.resize(1024 * 1024);
+        for (auto &c : data_)
+        {
+            c = static_cast<char>(chars(rng));
+        }
     }
-    else
+
+    std::string_view get(size_t size, uint64_t offset) const
     {
-        key = line.substr(0, comma_pos);
-        value = line.substr(comma_pos + 1);
+        size = std::min(size, data_.size());
+        return std::string_view(data_).substr(offset % (data_.size() - size + 1), size);
     }
+};
 
-    // Simple CSV unescaping - remove surrounding quotes if present
-    auto trim_quotes = [](std::string &s)
+struct BenchResult
+{
+    std::string name;
+    uint64_t ops = 0;
+    uint64_t found = 0;
+    double seconds = 0.0;
+    HistogramSnapshot latency;
+};
+
+inline void print_bench_result(const BenchResult &result)
+{
+    const double ops_per_sec = result.seconds > 0.0 ? static_cast<double>(result.ops) / result.seconds : 0.0;
+    const double micros_per_op = result.ops > 0 ? result.seconds * 1e6 / static_cast<double>(result.ops) : 0.0;
+    std::cout << std::left << std::setw(18) << result.name << std::right << ": "
+              << std::fixed << std::setprecision(3) << std::setw(10) << micros_per_op << " micros/op "
+              << std::setprecision(0) << std::setw(10) << ops_per_sec << " ops/sec;"
+              << std::setprecision(2)
+              << " p50 " << static_cast<double>(result.latency.percentile(50.0)) / 1e3
+              << " p99 " << static_cast<double>(result.latency.percentile(99.0)) / 1e3
+              << " p99.9 " << static_cast<double>(result.latency.percentile(99.9)) / 1e3 << " micros";
+    if (result.found > 0)
+    {
+        std::cout << " (" << result.found << " of " << result.ops << " found)";
+    }
+    std::cout << std::defaultfloat << "\n";
+}
+
+// Runs one named workload on config.threads threads, returns std::nullopt for unknown names
+template <typename StringType>
+std::optional<BenchResult> run_bench_workload(LSMTree<StringType> &lsm, const std::string &name, const BenchConfig &config,
+                                              const ZipfianGenerator &zipfian, const ValueGenerator &values)
+{
+    enum class Op
     {
-        if (s.size() >= 2 && s.front() == '"' && s.back() == '"')
+        put,
+        get,
+        get_missing,
+        seek,
+        remove,
+    };
+
+    // With a TTL every written value starts with its expiry time
+    auto make_value = [&](uint64_t offset)
+    {
+        const std::string_view value = values.get(config.value_size, offset);
+        if (config.ttl_seconds == 0)
         {
-            s = s.substr(1, s.size() - 2);
+            return make_owned_string<StringType>(value);
         }
+        return make_owned_string<StringType>(make_ttl_value(value, unix_seconds_now() + config.ttl_seconds));
     };
 
-    trim_quotes(key);
-    trim_quotes(value);
+    if (name == "fillbulk")
+    {
+        // Streams num sorted keys into a single table, the way large tables are built offline
+        std::mt19937_64 rng(config.seed);
+        uint64_t next_index = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        lsm.bulk_load_sorted([&]() -> std::optional<std::pair<StringType, StringType>>
+                             {
+                                 if (next_index >= config.num)
+                                 {
+                                     return std::nullopt;
+                                 }
+                                 const std::string key = format_bench_key(next_index++, config.key_size);
+                                 return std::pair(make_owned_string<StringType>(key),
+                                                  make_value(rng()));
+                             });
+        BenchResult result;
+        result.name = name;
+        result.ops = config.num;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        return result;
+    }
 
-    // Convert to target string type
-    if constexpr (std::is_same_v<StringType, std::string>)
+    Op op;
+    KeyDistribution distribution = config.distribution;
+    uint64_t total_ops = config.num;
+    bool with_background_writer = false;
+    if (name == "fillseq")
     {
-        return {key, value};
+        op = Op::put;
+        distribution = KeyDistribution::sequential;
     }
-    else
+    else if (name == "fillrandom" || name == "overwrite")
     {
-        auto result = std::make_pair(StringType(key), StringType(value));
-        return result;
+        op = Op::put;
+        if (distribution == KeyDistribution::sequential)
+        {
+            distribution = KeyDistribution::uniform;
+        }
     }
-}
-
-// Bulk ingest data from CSV file
-template <typename StringType>
-void bulk_ingest_csv(const std::string &csv_filename, const std::string &lsm_dir = "./lsm_data")
-{
-    std::cout << "=== CSV Bulk Ingestion ===\n";
-    std::cout << "Reading from: " << csv_filename << "\n";
-    std::cout << "LSM directory: " << lsm_dir << "\n\n";
-
-    // Open CSV file
-    std::ifstream file(csv_filename);
-    if (!file.is_open())
+    else if (name == "readrandom" || name == "readwhilewriting")
     {
-        throw std::runtime_error("Failed to open CSV file: " + csv_filename);
+        op = Op::get;
+        total_ops = config.reads > 0 ? config.reads : config.num;
+        with_background_writer = name == "readwhilewriting";
+    }
+    else if (name == "readmissing")
+    {
+        op = Op::get_missing;
+        total_ops = config.reads > 0 ? config.reads : config.num;
+    }
+    else if (name == "seekrandom")
+    {
+        op = Op::seek;
+        total_ops = config.reads > 0 ? config.reads : config.num;
+    }
+    else if (name == "deleterandom")
+    {
+        op = Op::remove;
+    }
+    else
+    {
+        return std::nullopt;
     }
 
-    // Create LSM tree
-    LSMTree<StringType> lsm(lsm_dir);
-
-    // Statistics
-    size_t line_count = 0;
-    size_t processed_count = 0;
-    auto start_time = std::chrono::high_resolution_clock::now();
+    auto latency = std::make_unique<LatencyHistogram>();
+    std::atomic<uint64_t> found{0};
+    std::atomic<bool> readers_done{false};
+    const unsigned thread_count = std::max(config.threads, 1u);
 
-    std::string line;
-    while (std::getline(file, line))
+    auto worker = [&](unsigned thread_index)
     {
-        line_count++;
-
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#')
+        KeyChooser chooser(distribution, config.num, thread_index, thread_count,
+                           config.seed + thread_index * 7919ull + std::hash<std::string>{}(name), &zipfian);
+        const uint64_t ops = total_ops / thread_count + (thread_index < total_ops % thread_count ? 1 : 0);
+        uint64_t local_found = 0;
+        WriteBatch batch;
+        for (uint64_t i = 0; i < ops; ++i)
         {
-            continue;
-        }
+            std::string key = format_bench_key(chooser.next(), config.key_size);
+            if (op == Op::get_missing)
+            {
+                key += '.';
+            }
 
-        try
-        {
-            auto [key, value] = parse_csv_line<StringType>(line);
-            if (!key.empty())
+            // Batched puts record one latency sample per write
+            if (op == Op::put && config.batch_size > 1)
             {
-                lsm.put(key, value);
-                processed_count++;
+                const StringType value = make_value(chooser.rng()());
+                batch.put(key, std::string_view(value.data(), value.size()));
+                if (batch.count() < config.batch_size && i + 1 < ops)
+                {
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                lsm.write(batch);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                latency->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                batch.clear();
+                continue;
+            }
 
-                // Progress report every 10000 records
-                if (processed_count % 10000 == 0)
+            auto start = std::chrono::steady_clock::now();
+            switch (op)
+            {
+            case Op::put:
+                lsm.put(make_owned_string<StringType>(key),
+                        make_value(chooser.rng()()));
+                break;
+            case Op::get:
+            case Op::get_missing:
+            {
+                auto result = lsm.get(make_query_key<StringType>(key));
+                if (result.has_value() && !result->empty())
                 {
-                    std::cout << "Processed " << processed_count << " records...\n";
-                    lsm.print_stats();
-                    std::cout << "\n";
+                    ++local_found;
                 }
+                break;
             }
+            case Op::seek:
+                if (!lsm.scan(make_query_key<StringType>(key), config.seek_nexts).empty())
+                {
+                    ++local_found;
+                }
+                break;
+            case Op::remove:
+                lsm.delete_key(make_owned_string<StringType>(key));
+                break;
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            latency->record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
         }
-        catch (const std::exception &e)
-        {
-            std::cerr << "Warning: Failed to process line " << line_count
-                      << ": " << e.what() << "\n";
-        }
-    }
+        found.fetch_add(local_found, std::memory_order_relaxed);
+    };
 
-    // Final flush to ensure all data is persisted
-    lsm.flush_memtable();
+    auto start_time = std::chrono::steady_clock::now();
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    // readwhilewriting: one extra thread keeps overwriting random keys until the readers finish
+    std::thread writer;
+    if (with_background_writer)
+    {
+        writer = std::thread([&]
+                             {
+            KeyChooser chooser(config.distribution == KeyDistribution::sequential ? KeyDistribution::uniform : config.distribution,
+                               config.num, 0, 1, config.seed + 1, &zipfian);
+            while (!readers_done.load(std::memory_order_relaxed))
+            {
+                std::string key = format_bench_key(chooser.next(), config.key_size);
+                lsm.put(make_owned_string<StringType>(key),
+                        make_value(chooser.rng()()));
+            } });
+    }
 
-    std::cout << "=== Ingestion Complete ===\n";
-    std::cout << "Total lines read: " << line_count << "\n";
-    std::cout << "Records processed: " << processed_count << "\n";
-    std::cout << "Time taken: " << duration.count() << " ms\n";
-    auto duration_count = duration.count();
-    std::cout << "Records per second: " << (duration_count > 0 ? processed_count * 1000 / duration_count : 0) << "\n\n";
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < thread_count; ++t)
+    {
+        threads.emplace_back(worker, t);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    auto end_time = std::chrono::steady_clock::now();
 
-    lsm.print_stats();
+    readers_done.store(true, std::memory_order_relaxed);
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.ops = total_ops;
+    result.found = (op == Op::put || op == Op::remove) ? 0 : found.load();
+    result.seconds = std::chrono::duration<double>(end_time - start_time).count();
+    result.latency = latency->snapshot();
+    return result;
 }
 
-// Interactive query mode
+// db_bench-style driver: runs the configured workloads in order against a scratch directory
 template <typename StringType>
-void interactive_query(const std::string &lsm_dir = "./lsm_data")
+void run_bench(const BenchConfig &config, const std::string &lsm_dir, const LSMOptions &tree_options)
 {
-    std::cout << "=== Interactive Query Mode ===\n";
-    std::cout << "Type keys to query, 'stats' for statistics, or 'quit' to exit.\n\n";
+    const std::string bench_dir = (std::filesystem::path(lsm_dir) / (std::string("bench_") + string_type_tag<StringType>())).string();
+    const std::string cold_dir = tree_options.cold_dir.empty()
+                                     ? std::string()
+                                     : (std::filesystem::path(tree_options.cold_dir) / (std::string("bench_") + string_type_tag<StringType>())).string();
 
-    LSMTree<StringType> lsm(lsm_dir);
-    lsm.print_stats();
-    std::cout << "\n";
+    LSMOptions options = tree_options;
+    options.memtable_threshold = config.memtable_bytes;
+    options.verbose = false;
+    options.max_subcompactions = config.subcompactions;
+    options.block_size = config.block_size;
+    options.restart_interval = config.restart_interval;
+    options.bloom_bits_per_key = config.bloom_bits_per_key;
+    options.index_partition_size = config.index_partition_size;
+    options.block_cache_bytes = config.cache_bytes;
+    if (config.ttl_seconds > 0)
+    {
+        options.compaction_filter = std::make_shared<TtlCompactionFilter>();
+    }
+    options.use_direct_io = config.direct_io;
+    options.cold_dir = cold_dir;
+    if (config.rate_limit_mb > 0.0)
+    {
+        options.rate_limiter = std::make_shared<RateLimiter>(
+            static_cast<uint64_t>(config.rate_limit_mb * 1024.0 * 1024.0), config.rate_limit_auto_tune);
+    }
 
-    std::string input;
-    while (true)
+    std::cout << "=== LSM Bench (" << string_type_name<StringType>() << ") ===\n";
+    std::cout << "Keys: " << config.key_size << " bytes, values: " << config.value_size << " bytes, entries: " << config.num
+              << ", threads: " << config.threads << ", memtable: " << config.memtable_bytes << " bytes\n";
+    if (options.rate_limiter)
     {
-        std::cout << "query> ";
-        if (!std::getline(std::cin, input))
-        {
-            break; // EOF
-        }
+        std::cout << "Rate limit: " << config.rate_limit_mb << " MB/s" << (config.rate_limit_auto_tune ? " (auto tuned)" : "") << "\n";
+    }
+    std::cout << "Directory: " << bench_dir << "\n";
+    if (!cold_dir.empty())
+    {
+        std::cout << "Cold tier: " << cold_dir << ", entries older than " << options.cold_min_age.count() << " s\n";
+    }
 
-        if (input == "quit" || input == "exit")
-        {
-            break;
-        }
+    const ZipfianGenerator zipfian(config.distribution == KeyDistribution::zipfian ? config.num : 2);
+    const ValueGenerator values(config.seed);
 
-        if (input == "stats")
+    std::unique_ptr<LSMTree<StringType>> lsm;
+    for (const auto &workload : config.workloads)
+    {
+        // Fill workloads start from an empty database
+        const bool fill = workload == "fillseq" || workload == "fillrandom" || workload == "fillbulk";
+        if (!lsm || fill)
         {
-            lsm.print_stats();
-            continue;
+            lsm.reset();
+            if (fill)
+            {
+                std::filesystem::remove_all(bench_dir);
+                if (!cold_dir.empty())
+                {
+                    std::filesystem::remove_all(cold_dir);
+                }
+            }
+            lsm = std::make_unique<LSMTree<StringType>>(bench_dir, options);
         }
 
-        if (input.empty())
+        const auto paths_before = lsm->get_stats().get_paths;
+        auto result = run_bench_workload(*lsm, workload, config, zipfian, values);
+        if (!result.has_value())
         {
+            std::cerr << "Warning: Unknown workload '" << workload << "'\n";
             continue;
         }
+        print_bench_result(*result);
+        // Where this workload's reads were answered, empty for pure writes
+        lsm->get_stats().get_paths.since(paths_before).print(std::cout);
+    }
 
-        StringType query_key;
-        if constexpr (std::is_same_v<StringType, std::string>)
-        {
-            query_key = input;
-        }
-        else
-        {
-            query_key = StringType(input.c_str(), input.size(), gs::string_class::transient);
-        }
-        auto result = lsm.get(query_key);
-        if (result.has_value())
-        {
-            std::cout << "Found: " << result.value() << "\n";
-        }
-        else
-        {
-            std::cout << "Not found\n";
-        }
+    if (lsm)
+    {
+        std::cout << "Engine stats:\n";
+        lsm->get_stats().print(std::cout);
     }
+    std::cout << "\n";
+}
 
-    std::cout << "Goodbye!\n";
+// YCSB core workloads A-F, see https://github.com/brianfrankcooper/YCSB/wiki/Core-Workloads
+enum class YcsbRequestDistribution
+{
+    zipfian,
+    latest,
+};
+
+struct YcsbWorkload
+{
+    char name;
+    double read;
+    double update;
+    double insert;
+    double scan;
+    double read_modify_write;
+    YcsbRequestDistribution distribution;
+};
+
+constexpr std::array<YcsbWorkload, 6> YCSB_WORKLOADS = {{
+    {'a', 0.50, 0.50, 0.00, 0.00, 0.00, YcsbRequestDistribution::zipfian},
+    {'b', 0.95, 0.05, 0.00, 0.00, 0.00, YcsbRequestDistribution::zipfian},
+    {'c', 1.00, 0.00, 0.00, 0.00, 0.00, YcsbRequestDistribution::zipfian},
+    {'d', 0.95, 0.00, 0.05, 0.00, 0.00, YcsbRequestDistribution::latest},
+    {'e', 0.00, 0.00, 0.05, 0.95, 0.00, YcsbRequestDistribution::zipfian},
+    {'f', 0.50, 0.00, 0.00, 0.00, 0.50, YcsbRequestDistribution::zipfian},
+}};
+
+struct YcsbConfig
+{
+    std::string workloads = "a,b,c,d,e,f";
+    uint64_t record_count = 100000;
+    uint64_t operation_count = 100000;
+    unsigned threads = 1;
+    size_t value_size = 1000; // YCSB default record: 10 fields of 100 bytes
+    size_t max_scan_length = 100;
+    size_t memtable_bytes = 4 * 1024 * 1024;
+    uint32_t seed = 42;
+    std::string json_path;
+};
+
+// YCSB keys are "user" followed by the hashed insertion order
+inline std::string format_ycsb_key(uint64_t index)
+{
+    return "user" + std::to_string(fnv1a_64(index));
 }
 
-// Bulk read keys from file
+// In-process adapter exposing the YCSB DB interface on top of an LSMTree
 template <typename StringType>
-void bulk_read_keys(const std::string &keys_filename, const std::string &lsm_dir = "./lsm_data")
+class YcsbLsmAdapter
 {
-    std::cout << "=== Bulk Key Reading ===\n";
-    std::cout << "Reading keys from: " << keys_filename << "\n";
-    std::cout << "LSM directory: " << lsm_dir << "\n\n";
+private:
+    LSMTree<StringType> &lsm_;
 
-    // Open keys file
-    std::ifstream file(keys_filename);
-    if (!file.is_open())
+public:
+    explicit YcsbLsmAdapter(LSMTree<StringType> &lsm)
+        : lsm_(lsm)
     {
-        throw std::runtime_error("Failed to open keys file: " + keys_filename);
     }
 
-    // Create LSM tree
-    LSMTree<StringType> lsm(lsm_dir);
+    bool read(const std::string &key)
+    {
+        auto result = lsm_.get(make_query_key<StringType>(key));
+        return result.has_value() && !result->empty();
+    }
 
-    // Statistics
-    size_t line_count = 0;
-    size_t found_count = 0;
-    size_t not_found_count = 0;
-    auto start_time = std::chrono::high_resolution_clock::now();
+    void update(const std::string &key, std::string_view value)
+    {
+        lsm_.put(make_owned_string<StringType>(key), make_owned_string<StringType>(value));
+    }
 
-    std::string line;
-    while (std::getline(file, line))
+    void insert(const std::string &key, std::string_view value)
     {
-        line_count++;
+        update(key, value);
+    }
 
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#')
-        {
-            continue;
-        }
+    size_t scan(const std::string &start_key, size_t count)
+    {
+        return lsm_.scan(make_query_key<StringType>(start_key), count).size();
+    }
 
-        // Trim whitespace
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+    bool read_modify_write(const std::string &key, std::string_view value)
+    {
+        bool found = read(key);
+        update(key, value);
+        return found;
+    }
+};
 
-        if (line.empty())
-        {
-            continue;
-        }
+enum class YcsbOp : size_t
+{
+    read,
+    update,
+    insert,
+    scan,
+    read_modify_write,
+    count,
+};
 
-        try
-        {
-            StringType query_key;
-            if constexpr (std::is_same_v<StringType, std::string>)
-            {
-                query_key = line;
-            }
-            else
-            {
-                query_key = StringType(line.c_str(), line.size(), gs::string_class::transient);
-            }
+constexpr std::array<const char *, static_cast<size_t>(YcsbOp::count)> YCSB_OP_NAMES = {
+    "READ", "UPDATE", "INSERT", "SCAN", "READ-MODIFY-WRITE"};
 
-            auto result = lsm.get(query_key);
-            if (result.has_value())
-            {
-                std::cout << "Found: " << line << " -> " << result.value() << "\n";
-                found_count++;
-            }
-            else
-            {
-                std::cout << "Not found: " << line << "\n";
-                not_found_count++;
-            }
+struct YcsbRunResult
+{
+    std::string name;
+    uint64_t ops = 0;
+    double seconds = 0.0;
+    std::array<HistogramSnapshot, static_cast<size_t>(YcsbOp::count)> latency;
+};
 
-            // Progress report every 1000 queries
-            if ((found_count + not_found_count) % 1000 == 0)
+// Writes results in the Google Benchmark JSON layout understood by benchmark/analyze_results.py
+template <typename StringType>
+void write_ycsb_json(std::ostream &os, const YcsbConfig &config, const std::vector<YcsbRunResult> &runs)
+{
+    char host_name[256] = {};
+    gethostname(host_name, sizeof(host_name) - 1);
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm local_time{};
+    localtime_r(&now, &local_time);
+
+    os << "{\n  \"context\": {\n";
+    os << "    \"date\": \"" << std::put_time(&local_time, "%Y-%m-%dT%H:%M:%S") << "\",\n";
+    os << "    \"host_name\": \"" << host_name << "\",\n";
+    os << "    \"executable\": \"lsm_tree ycsb\",\n";
+    os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    os << "    \"mhz_per_cpu\": 0,\n";
+    os << "    \"caches\": [],\n";
+    os << "    \"library_version\": \"lsm_tree-ycsb\",\n";
+#ifdef NDEBUG
+    os << "    \"library_build_type\": \"release\",\n";
+#else
+    os << "    \"library_build_type\": \"debug\",\n";
+#endif
+    os << "    \"string_type\": \"" << string_type_name<StringType>() << "\",\n";
+    os << "    \"threads\": " << config.threads << "\n";
+    os << "  },\n  \"benchmarks\": [";
+
+    bool first = true;
+    auto write_entry = [&](const std::string &name, uint64_t iterations, double time_ns, double items_per_second,
+                           const HistogramSnapshot *latency)
+    {
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "    {\"name\": \"" << name << "<" << string_type_name<StringType>() << ">/" << config.record_count << "\""
+           << ", \"run_name\": \"" << name << "<" << string_type_name<StringType>() << ">/" << config.record_count << "\""
+           << ", \"run_type\": \"iteration\", \"repetitions\": 1, \"repetition_index\": 0"
+           << ", \"threads\": " << config.threads
+           << ", \"iterations\": " << iterations
+           << ", \"real_time\": " << time_ns
+           << ", \"cpu_time\": " << time_ns
+           << ", \"time_unit\": \"ns\""
+           << ", \"items_per_second\": " << items_per_second;
+        if (latency != nullptr)
+        {
+            os << ", \"p50_ns\": " << latency->percentile(50.0)
+               << ", \"p95_ns\": " << latency->percentile(95.0)
+               << ", \"p99_ns\": " << latency->percentile(99.0)
+               << ", \"max_ns\": " << latency->max;
+        }
+        os << "}";
+    };
+
+    for (const auto &run : runs)
+    {
+        const double ops_per_second = run.seconds > 0.0 ? static_cast<double>(run.ops) / run.seconds : 0.0;
+        const double ns_per_op = run.ops > 0 ? run.seconds * 1e9 / static_cast<double>(run.ops) : 0.0;
+        write_entry(run.name, run.ops, ns_per_op, ops_per_second, nullptr);
+        for (size_t op = 0; op < run.latency.size(); ++op)
+        {
+            const auto &latency = run.latency[op];
+            if (latency.count == 0)
             {
-                std::cout << "Processed " << (found_count + not_found_count) << " queries...\n";
+                continue;
             }
+            std::string op_name = YCSB_OP_NAMES[op];
+            std::replace(op_name.begin(), op_name.end(), '-', '_');
+            write_entry(run.name + "_" + op_name, latency.count, latency.mean(),
+                        latency.mean() > 0.0 ? 1e9 / latency.mean() : 0.0, &latency);
         }
-        catch (const std::exception &e)
+    }
+    os << "\n  ]\n}\n";
+}
+
+inline void print_ycsb_result(const YcsbRunResult &run)
+{
+    const double ops_per_second = run.seconds > 0.0 ? static_cast<double>(run.ops) / run.seconds : 0.0;
+    std::cout << "[" << run.name << "] RunTime(ms): " << std::fixed << std::setprecision(0) << run.seconds * 1e3
+              << ", Throughput(ops/sec): " << ops_per_second << "\n";
+    for (size_t op = 0; op < run.latency.size(); ++op)
+    {
+        const auto &latency = run.latency[op];
+        if (latency.count == 0)
         {
-            std::cerr << "Warning: Failed to process line " << line_count
-                      << " (" << line << "): " << e.what() << "\n";
+            continue;
         }
+        std::cout << "  [" << YCSB_OP_NAMES[op] << "] Operations: " << latency.count
+                  << ", AverageLatency(us): " << std::setprecision(2) << latency.mean() / 1e3
+                  << ", 95thPercentileLatency(us): " << static_cast<double>(latency.percentile(95.0)) / 1e3
+                  << ", 99thPercentileLatency(us): " << static_cast<double>(latency.percentile(99.0)) / 1e3 << "\n";
     }
-
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-
-    std::cout << "\n=== Bulk Read Complete ===\n";
-    std::cout << "Total lines read: " << line_count << "\n";
-    std::cout << "Keys found: " << found_count << "\n";
-    std::cout << "Keys not found: " << not_found_count << "\n";
-    std::cout << "Total queries: " << (found_count + not_found_count) << "\n";
-    std::cout << "Time taken: " << duration.count() << " ms\n";
-    auto duration_count = duration.count();
-    std::cout << "Queries per second: " << (duration_count > 0 ? (found_count + not_found_count) * 1000 / duration_count : 0) << "\n\n";
+    std::cout << std::defaultfloat;
 }
 
-// Demo function
+// YCSB-style runner: loads record_count records, then runs each requested workload in turn
 template <typename StringType>
-void demo_lsm_tree()
+void run_ycsb(const YcsbConfig &config, const std::string &lsm_dir, const LSMOptions &tree_options)
 {
-    std::cout << "=== LSM Tree Demo ===\n\n";
-
-    LSMTree<StringType> lsm;
-
-    // Insert some data
-    std::cout << "Inserting data...\n";
-    lsm.put("apple", "red fruit");
-    lsm.put("banana", "yellow fruit");
-    lsm.put("cherry", "red fruit");
-    lsm.put("date", "sweet fruit");
-    lsm.put("elderberry", "small fruit");
-
-    lsm.print_stats();
-    std::cout << "\n";
-
-    // Query some data
-    std::cout << "Querying data:\n";
-    auto result = lsm.get("apple");
-    if (result.has_value())
-    {
-        std::cout << "apple: " << result.value() << "\n";
-    }
+    const std::string ycsb_dir = (std::filesystem::path(lsm_dir) / (std::string("ycsb_") + string_type_tag<StringType>())).string();
+    std::filesystem::remove_all(ycsb_dir);
 
-    result = lsm.get("banana");
-    if (result.has_value())
+    LSMOptions options = tree_options;
+    if (!options.cold_dir.empty())
     {
-        std::cout << "banana: " << result.value() << "\n";
+        options.cold_dir = (std::filesystem::path(options.cold_dir) / (std::string("ycsb_") + string_type_tag<StringType>())).string();
+        std::filesystem::remove_all(options.cold_dir);
     }
+    options.memtable_threshold = config.memtable_bytes;
+    options.verbose = false;
+    LSMTree<StringType> lsm(ycsb_dir, options);
+    YcsbLsmAdapter<StringType> db(lsm);
 
-    result = lsm.get("nonexistent");
-    if (!result.has_value())
-    {
-        std::cout << "nonexistent: not found\n";
-    }
+    std::cout << "=== YCSB (" << string_type_name<StringType>() << ") ===\n";
+    std::cout << "Records: " << config.record_count << ", operations: " << config.operation_count
+              << ", threads: " << config.threads << ", value size: " << config.value_size << " bytes\n";
 
-    std::cout << "\n";
+    const ValueGenerator values(config.seed);
+    const unsigned thread_count = std::max(config.threads, 1u);
+    // Inserted keys are numbered in order so the latest distribution can pick recent ones
+    std::atomic<uint64_t> insert_count{config.record_count};
+    std::vector<YcsbRunResult> runs;
 
-    // Add more data to trigger flushes
-    std::cout << "Adding more data to trigger MemTable flush...\n";
-    for (int i = 0; i < 100; ++i)
+    auto run_phase = [&](const std::string &name, uint64_t total_ops, auto &&do_op)
     {
-        lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
-    }
+        std::array<std::unique_ptr<LatencyHistogram>, static_cast<size_t>(YcsbOp::count)> histograms;
+        for (auto &histogram : histograms)
+        {
+            histogram = std::make_unique<LatencyHistogram>();
+        }
 
-    lsm.print_stats();
-    std::cout << "\n";
+        auto start_time = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&, t]
+                                 {
+                std::mt19937_64 rng(config.seed + t * 104729ull + std::hash<std::string>{}(name));
+                const uint64_t ops = total_ops / thread_count + (t < total_ops % thread_count ? 1 : 0);
+                for (uint64_t i = 0; i < ops; ++i)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    YcsbOp op = do_op(rng, t, i);
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    histograms[static_cast<size_t>(op)]->record(
+                        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
 
-    // Force flush
-    std::cout << "Forcing MemTable flush...\n";
-    lsm.flush_memtable();
-    lsm.print_stats();
+        YcsbRunResult run;
+        run.name = name;
+        run.ops = total_ops;
+        run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        for (size_t op = 0; op < histograms.size(); ++op)
+        {
+            run.latency[op] = histograms[op]->snapshot();
+        }
+        print_ycsb_result(run);
+        runs.push_back(std::move(run));
+    };
 
-    std::cout << "\n";
+    // Load phase, every thread inserts an interleaved slice of the records
+    run_phase("YCSB_LOAD", config.record_count, [&](std::mt19937_64 &rng, unsigned thread_index, uint64_t i)
+              {
+        const uint64_t index = i * thread_count + thread_index;
+        db.insert(format_ycsb_key(index), values.get(config.value_size, rng()));
+        return YcsbOp::insert; });
 
-    // Add even more data to trigger compaction
-    std::cout << "Adding more data to trigger compaction...\n";
-    for (int i = 100; i < 500; ++i)
+    const ZipfianGenerator zipfian(config.record_count);
+    std::stringstream workload_stream(config.workloads);
+    for (std::string workload_name; std::getline(workload_stream, workload_name, ',');)
     {
-        lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+        auto workload_it = std::find_if(YCSB_WORKLOADS.begin(), YCSB_WORKLOADS.end(), [&](const YcsbWorkload &w)
+                                        { return workload_name.size() == 1 && std::tolower(workload_name[0]) == w.name; });
+        if (workload_it == YCSB_WORKLOADS.end())
+        {
+            std::cerr << "Warning: Unknown YCSB workload '" << workload_name << "'\n";
+            continue;
+        }
+        const YcsbWorkload workload = *workload_it;
+
+        auto choose_key = [&](std::mt19937_64 &rng)
+        {
+            const uint64_t inserted = insert_count.load(std::memory_order_relaxed);
+            if (workload.distribution == YcsbRequestDistribution::latest)
+            {
+                // Skewed towards the most recent inserts
+                const uint64_t offset = zipfian.next(rng);
+                return offset < inserted ? inserted - 1 - offset : inserted - 1;
+            }
+            return scramble_item(zipfian.next(rng), inserted);
+        };
+
+        std::string run_name = std::string("YCSB_") + static_cast<char>(std::toupper(workload.name));
+        run_phase(run_name, config.operation_count, [&](std::mt19937_64 &rng, unsigned, uint64_t)
+                  {
+            const double choice = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+            double threshold = workload.read;
+            if (choice < threshold)
+            {
+                db.read(format_ycsb_key(choose_key(rng)));
+                return YcsbOp::read;
+            }
+            threshold += workload.update;
+            if (choice < threshold)
+            {
+                db.update(format_ycsb_key(choose_key(rng)), values.get(config.value_size, rng()));
+                return YcsbOp::update;
+            }
+            threshold += workload.insert;
+            if (choice < threshold)
+            {
+                const uint64_t index = insert_count.fetch_add(1, std::memory_order_relaxed);
+                db.insert(format_ycsb_key(index), values.get(config.value_size, rng()));
+                return YcsbOp::insert;
+            }
+            threshold += workload.scan;
+            if (choice < threshold)
+            {
+                const size_t length = std::uniform_int_distribution<size_t>(1, config.max_scan_length)(rng);
+                db.scan(format_ycsb_key(choose_key(rng)), length);
+                return YcsbOp::scan;
+            }
+            db.read_modify_write(format_ycsb_key(choose_key(rng)), values.get(config.value_size, rng()));
+            return YcsbOp::read_modify_write; });
     }
 
-    // Force multiple flushes
-    for (int i = 0; i < 5; ++i)
+    if (!config.json_path.empty())
     {
-        lsm.flush_memtable();
-        for (int j = 0; j < 20; ++j)
+        std::filesystem::path json_path(config.json_path);
+        json_path.replace_filename(json_path.stem().string() + "_" + string_type_tag<StringType>() + json_path.extension().string());
+        std::ofstream json_file(json_path);
+        if (!json_file.is_open())
         {
-            lsm.put("batch" + std::to_string(i) + "_key" + std::to_string(j),
-                    "batch" + std::to_string(i) + "_value" + std::to_string(j));
+            throw std::runtime_error("Failed to open JSON output file: " + json_path.string());
         }
+        write_ycsb_json<StringType>(json_file, config, runs);
+        std::cout << "Results written to " << json_path.string() << "\n";
     }
-
-    lsm.print_stats();
     std::cout << "\n";
+}
 
-    // Test retrieval after compaction
-    std::cout << "Testing retrieval after operations:\n";
-    result = lsm.get("key50");
-    if (result.has_value())
-    {
-        std::cout << "key50: " << result.value() << "\n";
-    }
+template <typename StringType>
+void run_server(const ServeConfig &config, const std::string &lsm_dir, const LSMOptions &tree_options)
+{
+    LSMOptions options = tree_options;
+    options.memtable_threshold = config.memtable_bytes;
+    options.verbose = false;
+    LSMTree<StringType> lsm(lsm_dir, options);
 
-    result = lsm.get("batch2_key10");
-    if (result.has_value())
+    int listen_fd = open_listen_socket(config.socket_path, config.port);
+    serve_stop_requested.store(false);
+    struct sigaction action{};
+    action.sa_handler = [](int)
+    { serve_stop_requested.store(true); };
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::cout << "Serving " << string_type_name<StringType>() << " LSM tree from " << lsm_dir << " on "
+              << (config.socket_path.empty() ? "127.0.0.1:" + std::to_string(config.port) : config.socket_path)
+              << " with " << config.event_threads << " event loop thread(s), Ctrl-C to stop\n";
+
+    LsmServer<StringType> server(lsm, listen_fd);
+    server.run(config.event_threads);
+
+    close(listen_fd);
+    if (!config.socket_path.empty())
     {
-        std::cout << "batch2_key10: " << result.value() << "\n";
+        unlink(config.socket_path.c_str());
     }
+    // There is no write-ahead log, make the memtable durable before exiting
+    lsm.flush_memtable();
 
-    std::cout << "\n";
+    const uint64_t batches = server.batches();
+    std::cout << "Served " << server.requests() << " requests in " << batches << " batches ("
+              << std::fixed << std::setprecision(1)
+              << (batches > 0 ? static_cast<double>(server.requests()) / static_cast<double>(batches) : 0.0)
+              << " per batch)\n" << std::defaultfloat;
+}
 
-    // Test persistence by creating a new LSM tree instance
-    std::cout << "Testing persistence with new LSM tree instance:\n";
-    {
-        LSMTree<std::string> lsm2; // Should load existing SSTables
-        lsm2.print_stats();
+struct LoadgenConfig
+{
+    std::string socket_path;
+    uint16_t port = 6380;
+    unsigned connections = 4;
+    uint64_t requests = 100000;
+    size_t pipeline = 16;
+    double read_ratio = 0.9;
+    uint64_t num = 100000;
+    size_t key_size = 16;
+    size_t value_size = 100;
+    KeyDistribution distribution = KeyDistribution::uniform;
+    uint32_t seed = 42;
+};
 
-        // Test that we can still retrieve data
-        auto persistent_result = lsm2.get("apple");
-        if (persistent_result.has_value())
-        {
-            std::cout << "apple (from persistent storage): " << persistent_result.value() << "\n";
-        }
+// Closed-loop client: every connection sends a pipeline of GET/SET requests and waits for all replies.
+// Each request is charged the round trip of its pipeline.
+inline void run_loadgen(const LoadgenConfig &config)
+{
+    const unsigned connection_count = std::max(config.connections, 1u);
+    const size_t pipeline = std::max<size_t>(config.pipeline, 1);
+    const ZipfianGenerator zipfian(config.distribution == KeyDistribution::zipfian ? config.num : 2);
+    const ValueGenerator values(config.seed);
+    auto latency = std::make_unique<LatencyHistogram>();
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> errors{0};
+    std::vector<std::exception_ptr> failures(connection_count);
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < connection_count; ++t)
+    {
+        threads.emplace_back([&, t]
+                             {
+            try
+            {
+                int fd = connect_socket(config.socket_path, config.port);
+                KeyChooser chooser(config.distribution, config.num, t, connection_count, config.seed + t, &zipfian);
+                std::uniform_real_distribution<double> coin(0.0, 1.0);
+                std::string request;
+                std::string response;
+                char buffer[64 * 1024];
+
+                uint64_t remaining = config.requests / connection_count + (t < config.requests % connection_count ? 1 : 0);
+                while (remaining > 0)
+                {
+                    const size_t batch = static_cast<size_t>(std::min<uint64_t>(remaining, pipeline));
+                    request.clear();
+                    for (size_t i = 0; i < batch; ++i)
+                    {
+                        const std::string key = format_bench_key(chooser.next(), config.key_size);
+                        if (coin(chooser.rng()) < config.read_ratio)
+                        {
+                            resp_append_command(request, {"GET", key});
+                        }
+                        else
+                        {
+                            resp_append_command(request, {"SET", key, values.get(config.value_size, chooser.rng()())});
+                        }
+                    }
 
-        persistent_result = lsm2.get("key50");
-        if (persistent_result.has_value())
+                    auto batch_start = std::chrono::steady_clock::now();
+                    for (size_t sent = 0; sent < request.size();)
+                    {
+                        ssize_t written = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+                        if (written <= 0)
+                        {
+                            throw std::runtime_error("Connection lost while sending");
+                        }
+                        sent += static_cast<size_t>(written);
+                    }
+
+                    response.clear();
+                    size_t offset = 0;
+                    size_t replies = 0;
+                    size_t batch_misses = 0;
+                    size_t batch_errors = 0;
+                    while (replies < batch)
+                    {
+                        RespStatus status = resp_skip_reply(response, offset, batch_misses, batch_errors);
+                        if (status == RespStatus::complete)
+                        {
+                            replies++;
+                            continue;
+                        }
+                        if (status == RespStatus::error)
+                        {
+                            throw std::runtime_error("Malformed reply from server");
+                        }
+                        ssize_t bytes = recv(fd, buffer, sizeof(buffer), 0);
+                        if (bytes <= 0)
+                        {
+                            throw std::runtime_error("Connection lost while receiving");
+                        }
+                        response.append(buffer, static_cast<size_t>(bytes));
+                    }
+                    auto elapsed = std::chrono::steady_clock::now() - batch_start;
+                    const auto nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                    for (size_t i = 0; i < batch; ++i)
+                    {
+                        latency->record(nanos);
+                    }
+                    misses.fetch_add(batch_misses, std::memory_order_relaxed);
+                    errors.fetch_add(batch_errors, std::memory_order_relaxed);
+                    remaining -= batch;
+                }
+                close(fd);
+            }
+            catch (...)
+            {
+                failures[t] = std::current_exception();
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto &failure : failures)
+    {
+        if (failure)
         {
-            std::cout << "key50 (from persistent storage): " << persistent_result.value() << "\n";
+            std::rethrow_exception(failure);
         }
     }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    const auto snapshot = latency->snapshot();
+    std::cout << "loadgen: " << config.requests << " requests over " << connection_count << " connection(s), pipeline "
+              << pipeline << ", read ratio " << config.read_ratio << "\n";
+    std::cout << std::fixed << std::setprecision(0) << "  " << (seconds > 0.0 ? static_cast<double>(config.requests) / seconds : 0.0)
+              << " ops/sec" << std::setprecision(2) << "; round trip p50 " << static_cast<double>(snapshot.percentile(50.0)) / 1e3
+              << " p99 " << static_cast<double>(snapshot.percentile(99.0)) / 1e3 << " p99.9 " << static_cast<double>(snapshot.percentile(99.9)) / 1e3
+              << " micros; " << misses.load() << " misses, " << errors.load() << " errors\n" << std::defaultfloat;
 }
 
 void print_usage(const char *program_name)
 {
     std::cout << "Usage: " << program_name << " [string_type] [command] [options]\n\n";
-    std::cout << "string_type: 'std' for std::string, 'gs' for gs::german_string\n";
+    std::cout << "string_type: 'std' for std::string, 'gs' for gs::german_string, 'both' to run the command for each\n";
     std::cout << "Commands:\n";
     std::cout << "  demo                    Run the built-in demo\n";
-    std::cout << "  ingest <csv_file>       Bulk ingest data from CSV file\n";
+    std::cout << "  ingest <csv_file>       Bulk ingest data from CSV file (--bulk writes one sorted SSTable)\n";
     std::cout << "  query                   Interactive query mode\n";
     std::cout << "  get <key>               Get value for a specific key\n";
     std::cout << "  delete <key>            Delete a key (tombstone)\n";
-    std::cout << "  bulk_read <keys_file>   Bulk read keys from a file\n\n";
+    std::cout << "  bulk_read <keys_file>   Bulk read keys from a file\n";
+    std::cout << "  stats [--json]          Print LSM tree metrics\n";
+    std::cout << "  verify [--threads <n>]  Check the block checksums of every SSTable in parallel\n";
+    std::cout << "  bench [workloads]       Run db_bench-style workloads (comma separated)\n";
+    std::cout << "  ycsb [a,b,c,d,e,f]      Load records and run YCSB core workloads\n";
+    std::cout << "  serve                   Serve the tree over RESP (GET, SET/PUT, DEL, MGET, SCAN)\n";
+    std::cout << "  loadgen                 Drive a running server with pipelined GET/SET requests\n\n";
     std::cout << "Options:\n";
-    std::cout << "  --dir <directory>       LSM data directory (default: ./lsm_data)\n\n";
+    std::cout << "  --dir <directory>       LSM data directory (default: ./lsm_data)\n";
+    std::cout << "  --cold-dir <dir>        Cold tier for compacted data, read with pread (default: off)\n";
+    std::cout << "  --cold-age <seconds>    Entries younger than this stay in --dir (default: 0, so every\n";
+    std::cout << "                          compaction moves all of its output to the cold tier)\n\n";
+    std::cout << "Bench options:\n";
+    std::cout << "  workloads               fillseq, fillrandom, fillbulk, overwrite, readrandom,\n";
+    std::cout << "                          readmissing, seekrandom, readwhilewriting, deleterandom\n";
+    std::cout << "  --num <n>               Number of keys (default: 100000)\n";
+    std::cout << "  --reads <n>             Number of read operations (default: --num)\n";
+    std::cout << "  --key-size <bytes>      Key size (default: 16)\n";
+    std::cout << "  --value-size <bytes>    Value size (default: 100)\n";
+    std::cout << "  --threads <n>           Client threads (default: 1)\n";
+    std::cout << "  --distribution <d>      sequential, uniform or zipfian (default: uniform)\n";
+    std::cout << "  --seek-nexts <n>        Entries read per seek (default: 10)\n";
+    std::cout << "  --memtable-bytes <n>    MemTable flush threshold (default: 4194304)\n";
+    std::cout << "  --seed <n>              Random seed (default: 42)\n";
+    std::cout << "  --rate-limit <MB/s>     Limit flush and compaction writes (default: off)\n";
+    std::cout << "  --rate-limit-auto       Scale the limit with pending compaction work\n";
+    std::cout << "  --subcompactions <n>    Parallel key ranges per compaction (default: 1)\n";
+    std::cout << "  --block-size <bytes>    SSTable data block size (default: 4096)\n";
+    std::cout << "  --restart-interval <n>  Keys per full key in a block, 1 disables front coding (default: 16)\n";
+    std::cout << "  --bloom-bits <n>        Bloom filter bits per key, 0 disables (default: 10)\n";
+    std::cout << "  --index-partition-size <bytes>\n";
+    std::cout << "                          Index bytes per partition, 0 for one index per table (default: 4096)\n";
+    std::cout << "  --cache-bytes <n>       Block cache for index partitions (default: 8388608)\n";
+    std::cout << "  --ttl <seconds>         Write values with a TTL, expired ones are dropped by compaction\n";
+    std::cout << "  --batch-size <n>        Puts per write batch, latencies are then per batch (default: 1)\n";
+    std::cout << "  --direct-io             Write SSTables with O_DIRECT\n\n";
+    std::cout << "YCSB options:\n";
+    std::cout << "  --records <n>           Records loaded before the run (default: 100000)\n";
+    std::cout << "  --operations <n>        Operations per workload (default: 100000)\n";
+    std::cout << "  --threads <n>           Client threads (default: 1)\n";
+    std::cout << "  --value-size <bytes>    Record size (default: 1000)\n";
+    std::cout << "  --max-scan-length <n>   Longest scan in workload E (default: 100)\n";
+    std::cout << "  --json <file>           Write Google Benchmark style JSON, the file name\n";
+    std::cout << "                          gets a _std or _gs suffix\n\n";
+    std::cout << "Serve and loadgen options:\n";
+    std::cout << "  --socket <path>         Unix domain socket instead of TCP\n";
+    std::cout << "  --port <n>              Port on 127.0.0.1 (default: 6380)\n";
+    std::cout << "  --event-threads <n>     Server event loop threads (default: 2)\n";
+    std::cout << "  --connections <n>       Client connections (default: 4)\n";
+    std::cout << "  --requests <n>          Total requests (default: 100000)\n";
+    std::cout << "  --pipeline <n>          Requests in flight per connection (default: 16)\n";
+    std::cout << "  --read-ratio <r>        Fraction of GETs, the rest are SETs (default: 0.9)\n";
+    std::cout << "  --num, --key-size, --value-size, --distribution, --seed as for bench\n\n";
     std::cout << "CSV Format:\n";
     std::cout << "  key;value\n";
     std::cout << "  \"key with spaces\";\"value with spaces\"\n";
@@ -1182,6 +1644,11 @@ void print_usage(const char *program_name)
     std::cout << "  " << program_name << " query --dir /path/to/lsm\n";
     std::cout << "  " << program_name << " get mykey\n";
     std::cout << "  " << program_name << " bulk_read keys.txt\n";
+    std::cout << "  " << program_name << " stats --json\n";
+    std::cout << "  " << program_name << " both bench fillrandom,readrandom --num 1000000 --threads 4\n";
+    std::cout << "  " << program_name << " both ycsb a,b,e --threads 8 --json ycsb.json\n";
+    std::cout << "  " << program_name << " gs serve --socket /tmp/lsm.sock --event-threads 4\n";
+    std::cout << "  " << program_name << " gs loadgen --socket /tmp/lsm.sock --connections 8 --pipeline 32\n";
 }
 
 template <typename StringType>
@@ -1191,15 +1658,25 @@ int template_main(int argc, char *argv[])
     {
         std::string command = argv[2];
         std::string lsm_dir = "./lsm_data";
+        LSMOptions tree_options;
 
         // Parse common options
         for (int i = 2; i < argc; i++)
         {
-            if (std::string(argv[i]) == "--dir" && i + 1 < argc)
+            const std::string arg = argv[i];
+            if (arg == "--dir" && i + 1 < argc)
             {
                 lsm_dir = argv[i + 1];
                 i++; // Skip the next argument since we consumed it
             }
+            else if (arg == "--cold-dir" && i + 1 < argc)
+            {
+                tree_options.cold_dir = argv[++i];
+            }
+            else if (arg == "--cold-age" && i + 1 < argc)
+            {
+                tree_options.cold_min_age = std::chrono::seconds(std::stoul(argv[++i]));
+            }
         }
 
         if (command == "demo")
@@ -1215,11 +1692,16 @@ int template_main(int argc, char *argv[])
                 return 1;
             }
             std::string csv_file = argv[3];
-            bulk_ingest_csv<StringType>(csv_file, lsm_dir);
+            bool bulk = false;
+            for (int i = 4; i < argc; i++)
+            {
+                bulk = bulk || std::string(argv[i]) == "--bulk";
+            }
+            bulk_ingest_csv<StringType>(csv_file, lsm_dir, bulk, tree_options);
         }
         else if (command == "query")
         {
-            interactive_query<StringType>(lsm_dir);
+            interactive_query<StringType>(lsm_dir, tree_options);
         }
         else if (command == "get")
         {
@@ -1230,8 +1712,8 @@ int template_main(int argc, char *argv[])
                 return 1;
             }
             std::string key = argv[3];
-            LSMTree<std::string> lsm(lsm_dir);
-            auto result = lsm.get(key);
+            LSMTree<StringType> lsm(lsm_dir, tree_options);
+            auto result = lsm.get(make_query_key<StringType>(key));
             if (result.has_value())
             {
                 std::cout << result.value() << "\n";
@@ -1252,7 +1734,7 @@ int template_main(int argc, char *argv[])
                 return 1;
             }
             std::string key = argv[3];
-            LSMTree<StringType> lsm(lsm_dir);
+            LSMTree<StringType> lsm(lsm_dir, tree_options);
             lsm.delete_key(key);
             lsm.flush_memtable(); // Ensure the tombstone is persisted
             std::cout << "Key deleted: " << key << "\n";
@@ -1267,7 +1749,293 @@ int template_main(int argc, char *argv[])
                 return 1;
             }
             std::string keys_file = argv[3];
-            bulk_read_keys<StringType>(keys_file, lsm_dir);
+            bulk_read_keys<StringType>(keys_file, lsm_dir, tree_options);
+        }
+        else if (command == "verify")
+        {
+            size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+            for (int i = 3; i < argc; i++)
+            {
+                if (std::string(argv[i]) == "--threads" && i + 1 < argc)
+                {
+                    threads = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+            }
+            if (verify_sstables<StringType>(lsm_dir, tree_options.cold_dir, threads) > 0)
+            {
+                return 1;
+            }
+        }
+        else if (command == "bench")
+        {
+            BenchConfig config;
+            std::string workloads = "fillseq,fillrandom,overwrite,readrandom,readmissing,seekrandom,readwhilewriting,deleterandom";
+            for (int i = 3; i < argc; i++)
+            {
+                std::string arg = argv[i];
+                bool has_value = i + 1 < argc;
+                if ((arg == "--dir" || arg == "--cold-dir" || arg == "--cold-age") && has_value)
+                {
+                    i++; // Common options
+                }
+                else if (arg == "--num" && has_value)
+                {
+                    config.num = std::stoull(argv[++i]);
+                }
+                else if (arg == "--reads" && has_value)
+                {
+                    config.reads = std::stoull(argv[++i]);
+                }
+                else if (arg == "--key-size" && has_value)
+                {
+                    config.key_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--value-size" && has_value)
+                {
+                    config.value_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--threads" && has_value)
+                {
+                    config.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--seek-nexts" && has_value)
+                {
+                    config.seek_nexts = std::stoul(argv[++i]);
+                }
+                else if (arg == "--rate-limit" && has_value)
+                {
+                    config.rate_limit_mb = std::stod(argv[++i]);
+                }
+                else if (arg == "--rate-limit-auto")
+                {
+                    config.rate_limit_auto_tune = true;
+                }
+                else if (arg == "--subcompactions" && has_value)
+                {
+                    config.subcompactions = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+                else if (arg == "--block-size" && has_value)
+                {
+                    config.block_size = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+                else if (arg == "--restart-interval" && has_value)
+                {
+                    config.restart_interval = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+                else if (arg == "--bloom-bits" && has_value)
+                {
+                    config.bloom_bits_per_key = std::stoul(argv[++i]);
+                }
+                else if (arg == "--index-partition-size" && has_value)
+                {
+                    config.index_partition_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--cache-bytes" && has_value)
+                {
+                    config.cache_bytes = std::stoul(argv[++i]);
+                }
+                else if (arg == "--ttl" && has_value)
+                {
+                    config.ttl_seconds = std::stoul(argv[++i]);
+                }
+                else if (arg == "--batch-size" && has_value)
+                {
+                    config.batch_size = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+                else if (arg == "--direct-io")
+                {
+                    config.direct_io = true;
+                }
+                else if (arg == "--memtable-bytes" && has_value)
+                {
+                    config.memtable_bytes = std::stoul(argv[++i]);
+                }
+                else if (arg == "--seed" && has_value)
+                {
+                    config.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--distribution" && has_value)
+                {
+                    auto distribution = parse_key_distribution(argv[++i]);
+                    if (!distribution.has_value())
+                    {
+                        std::cerr << "Error: Unknown distribution '" << argv[i] << "'\n";
+                        return 1;
+                    }
+                    config.distribution = *distribution;
+                }
+                else if (!arg.starts_with("--"))
+                {
+                    workloads = arg;
+                }
+            }
+
+            std::stringstream workload_stream(workloads);
+            for (std::string workload; std::getline(workload_stream, workload, ',');)
+            {
+                if (!workload.empty())
+                {
+                    config.workloads.push_back(workload);
+                }
+            }
+            run_bench<StringType>(config, lsm_dir, tree_options);
+        }
+        else if (command == "serve")
+        {
+            ServeConfig config;
+            for (int i = 3; i < argc; i++)
+            {
+                std::string arg = argv[i];
+                bool has_value = i + 1 < argc;
+                if (arg == "--socket" && has_value)
+                {
+                    config.socket_path = argv[++i];
+                }
+                else if (arg == "--port" && has_value)
+                {
+                    config.port = static_cast<uint16_t>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--event-threads" && has_value)
+                {
+                    config.event_threads = std::max(static_cast<unsigned>(std::stoul(argv[++i])), 1u);
+                }
+                else if (arg == "--memtable-bytes" && has_value)
+                {
+                    config.memtable_bytes = std::stoul(argv[++i]);
+                }
+            }
+            run_server<StringType>(config, lsm_dir, tree_options);
+        }
+        else if (command == "loadgen")
+        {
+            LoadgenConfig config;
+            for (int i = 3; i < argc; i++)
+            {
+                std::string arg = argv[i];
+                bool has_value = i + 1 < argc;
+                if (arg == "--socket" && has_value)
+                {
+                    config.socket_path = argv[++i];
+                }
+                else if (arg == "--port" && has_value)
+                {
+                    config.port = static_cast<uint16_t>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--connections" && has_value)
+                {
+                    config.connections = static_cast<unsigned>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--requests" && has_value)
+                {
+                    config.requests = std::stoull(argv[++i]);
+                }
+                else if (arg == "--pipeline" && has_value)
+                {
+                    config.pipeline = std::stoul(argv[++i]);
+                }
+                else if (arg == "--read-ratio" && has_value)
+                {
+                    config.read_ratio = std::stod(argv[++i]);
+                }
+                else if (arg == "--num" && has_value)
+                {
+                    config.num = std::stoull(argv[++i]);
+                }
+                else if (arg == "--key-size" && has_value)
+                {
+                    config.key_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--value-size" && has_value)
+                {
+                    config.value_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--seed" && has_value)
+                {
+                    config.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--distribution" && has_value)
+                {
+                    auto distribution = parse_key_distribution(argv[++i]);
+                    if (!distribution.has_value())
+                    {
+                        std::cerr << "Error: Unknown distribution '" << argv[i] << "'\n";
+                        return 1;
+                    }
+                    config.distribution = *distribution;
+                }
+            }
+            run_loadgen(config);
+        }
+        else if (command == "ycsb")
+        {
+            YcsbConfig config;
+            for (int i = 3; i < argc; i++)
+            {
+                std::string arg = argv[i];
+                bool has_value = i + 1 < argc;
+                if ((arg == "--dir" || arg == "--cold-dir" || arg == "--cold-age") && has_value)
+                {
+                    i++; // Common options
+                }
+                else if (arg == "--records" && has_value)
+                {
+                    config.record_count = std::stoull(argv[++i]);
+                }
+                else if (arg == "--operations" && has_value)
+                {
+                    config.operation_count = std::stoull(argv[++i]);
+                }
+                else if (arg == "--threads" && has_value)
+                {
+                    config.threads = static_cast<unsigned>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--value-size" && has_value)
+                {
+                    config.value_size = std::stoul(argv[++i]);
+                }
+                else if (arg == "--max-scan-length" && has_value)
+                {
+                    config.max_scan_length = std::max<size_t>(std::stoul(argv[++i]), 1);
+                }
+                else if (arg == "--memtable-bytes" && has_value)
+                {
+                    config.memtable_bytes = std::stoul(argv[++i]);
+                }
+                else if (arg == "--seed" && has_value)
+                {
+                    config.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+                }
+                else if (arg == "--json" && has_value)
+                {
+                    config.json_path = argv[++i];
+                }
+                else if (!arg.starts_with("--"))
+                {
+                    config.workloads = arg;
+                }
+            }
+            run_ycsb<StringType>(config, lsm_dir, tree_options);
+        }
+        else if (command == "stats")
+        {
+            bool json = false;
+            for (int i = 3; i < argc; i++)
+            {
+                if (std::string(argv[i]) == "--json")
+                {
+                    json = true;
+                }
+            }
+
+            LSMTree<StringType> lsm(lsm_dir, tree_options);
+            if (json)
+            {
+                lsm.get_stats().write_json(std::cout);
+            }
+            else
+            {
+                lsm.print_stats();
+            }
         }
         else
         {
@@ -1302,6 +2070,11 @@ int main(int argc, char *argv[])
     {
         return template_main<gs::german_string>(argc, argv);
     }
+    else if (string_type == "both")
+    {
+        int result = template_main<std::string>(argc, argv);
+        return result != 0 ? result : template_main<gs::german_string>(argc, argv);
+    }
     else
     {
         std::cerr << "Error: Unknown string type '" << string_type << "'\n";
@@ -0,0 +1,579 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "german_string.h"
+#include "lsm_server.h"
+#include "lsm_tree.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+
+// Fresh directory under the system temp path, removed with its tables at the end of the test
+class TempDir
+{
+private:
+    std::filesystem::path path_;
+
+public:
+    TempDir()
+    {
+        static std::atomic<int> counter{0};
+        path_ = std::filesystem::temp_directory_path() /
+                ("lsm_tree_tests_" + std::to_string(getpid()) + "_" + std::to_string(counter++));
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+
+    TempDir(const TempDir &) = delete;
+    TempDir &operator=(const TempDir &) = delete;
+
+    ~TempDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    std::string file(std::string_view name) const
+    {
+        return (path_ / name).string();
+    }
+
+    std::string str() const
+    {
+        return path_.string();
+    }
+};
+
+LSMOptions quiet_options()
+{
+    LSMOptions options;
+    options.verbose = false;
+    return options;
+}
+
+std::string format_key(size_t i)
+{
+    std::string key = std::to_string(i);
+    return "key" + std::string(8 - key.size(), '0') + key;
+}
+
+std::string to_std(const gs::german_string &str)
+{
+    return std::string(str.data(), str.size());
+}
+
+std::string to_std(const std::string &str)
+{
+    return str;
+}
+
+template <typename StringType>
+StringType make_key(std::string_view key)
+{
+    return StringType(std::string(key));
+}
+
+} // namespace
+
+TEST(LsmCrc32c, KnownValue)
+{
+    constexpr std::string_view check = "123456789";
+    EXPECT_EQ(crc32c(std::span<const char>(check.data(), check.size())), 0xE3069283u);
+    EXPECT_EQ(crc32c(std::span<const char>()), 0u);
+}
+
+TEST(LsmCrc32c, SoftwareMatchesHardware)
+{
+#ifdef LSM_HAVE_SSE42_CRC
+    if (!crc32c_hardware_supported())
+    {
+        GTEST_SKIP() << "CPU has no SSE4.2";
+    }
+    std::string data;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        data.push_back(static_cast<char>((i * 131 + 7) & 0xff));
+    }
+    // Every length and misalignment around the eight byte steps
+    for (size_t offset = 0; offset < 8; ++offset)
+    {
+        for (size_t size = 0; offset + size <= data.size(); size += 13)
+        {
+            EXPECT_EQ(crc32c_extend_software(~0u, data.data() + offset, size),
+                      crc32c_extend_hardware(~0u, data.data() + offset, size))
+                << "offset " << offset << " size " << size;
+        }
+    }
+#else
+    GTEST_SKIP() << "Built without the SSE4.2 path";
+#endif
+}
+
+TEST(LsmCrc32c, ExtendMatchesOneShot)
+{
+    const std::string data = "The quick brown fox jumps over the lazy dog";
+    const uint32_t whole = crc32c(std::span<const char>(data.data(), data.size()));
+    const uint32_t first = crc32c_extend(0, data.data(), 10);
+    EXPECT_EQ(crc32c_extend(first, data.data() + 10, data.size() - 10), whole);
+}
+
+template <typename StringType>
+class LsmSSTableTest : public ::testing::Test
+{
+};
+
+using LsmStringTypes = ::testing::Types<std::string, gs::german_string>;
+TYPED_TEST_SUITE(LsmSSTableTest, LsmStringTypes);
+
+TYPED_TEST(LsmSSTableTest, FrontCodedBlocksRoundTrip)
+{
+    TempDir dir;
+    SSTableWriterOptions options;
+    options.block_size = 256;
+    options.restart_interval = 4;
+    options.index_partition_size = 128;
+
+    // Only even keys are written so every odd key is a miss between two records
+    constexpr size_t ENTRIES = 2000;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (size_t i = 0; i < ENTRIES; i += 2)
+    {
+        entries.emplace_back(format_key(i), "value_" + std::to_string(i));
+    }
+    auto table = SSTable<TypeParam>::create_from_entries(entries, dir.file("sstable_0.dat"), 0, options);
+    ASSERT_TRUE(table->is_block_based());
+
+    std::vector<std::pair<std::string, std::string>> scanned;
+    for (auto cursor = table->cursor(make_key<TypeParam>("")); cursor->valid(); cursor->next())
+    {
+        scanned.emplace_back(to_std(cursor->key()), to_std(cursor->value()));
+    }
+    EXPECT_EQ(scanned, entries);
+
+    for (size_t i = 0; i < ENTRIES; ++i)
+    {
+        const auto value = table->get(make_key<TypeParam>(format_key(i)));
+        if (i % 2 == 0)
+        {
+            ASSERT_TRUE(value.has_value()) << format_key(i);
+            EXPECT_EQ(to_std(*value), "value_" + std::to_string(i));
+        }
+        else
+        {
+            EXPECT_FALSE(value.has_value()) << format_key(i);
+        }
+    }
+}
+
+TYPED_TEST(LsmSSTableTest, SeekLandsOnFirstKeyNotLess)
+{
+    TempDir dir;
+    SSTableWriterOptions options;
+    options.block_size = 256;
+    options.restart_interval = 4;
+
+    constexpr size_t ENTRIES = 1000;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (size_t i = 0; i < ENTRIES; i += 2)
+    {
+        entries.emplace_back(format_key(i), std::to_string(i));
+    }
+    auto table = SSTable<TypeParam>::create_from_entries(entries, dir.file("sstable_0.dat"), 0, options);
+
+    // Seeks to present keys, to keys between two records, and from the start of every restart interval
+    for (size_t i = 0; i < ENTRIES; ++i)
+    {
+        auto cursor = table->cursor(make_key<TypeParam>(format_key(i)));
+        const size_t expected = i % 2 == 0 ? i : i + 1;
+        if (expected >= ENTRIES)
+        {
+            EXPECT_FALSE(cursor->valid());
+            continue;
+        }
+        ASSERT_TRUE(cursor->valid()) << format_key(i);
+        EXPECT_EQ(to_std(cursor->key()), format_key(expected));
+        cursor->next();
+        if (expected + 2 < ENTRIES)
+        {
+            ASSERT_TRUE(cursor->valid());
+            EXPECT_EQ(to_std(cursor->key()), format_key(expected + 2));
+        }
+    }
+    EXPECT_FALSE(table->cursor(make_key<TypeParam>("zzz"))->valid());
+}
+
+TEST(LsmSSTable, CorruptedBlockThrows)
+{
+    TempDir dir;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        entries.emplace_back(format_key(i), "value_" + std::to_string(i));
+    }
+    const std::string filename = dir.file("sstable_0.dat");
+    SSTable<gs::german_string>::create_from_entries(entries, filename);
+
+    // Flip one byte inside the first data block
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(8);
+        char byte = 0;
+        file.read(&byte, 1);
+        byte = static_cast<char>(byte ^ 0x5a);
+        file.seekp(8);
+        file.write(&byte, 1);
+    }
+
+    SSTable<gs::german_string> table(filename);
+    EXPECT_THROW(table.get(gs::german_string(format_key(0))), SSTableCorruption);
+    EXPECT_THROW(table.verify(), SSTableCorruption);
+}
+
+TEST(LsmSSTable, TruncatedFileThrows)
+{
+    TempDir dir;
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        entries.emplace_back(format_key(i), "value_" + std::to_string(i));
+    }
+    const std::string filename = dir.file("sstable_0.dat");
+    SSTable<gs::german_string>::create_from_entries(entries, filename);
+    std::filesystem::resize_file(filename, std::filesystem::file_size(filename) - 20);
+
+    SSTable<gs::german_string> table(filename);
+    EXPECT_THROW(table.verify(), SSTableCorruption);
+}
+
+TEST(LsmWriteBatch, ForEachKeepsInsertionOrder)
+{
+    WriteBatch batch;
+    batch.put("b", "1");
+    batch.put("a", "2");
+    batch.delete_key("b");
+    batch.put("c", "");
+
+    std::vector<std::pair<std::string, std::string>> records;
+    batch.for_each([&](std::string_view key, std::string_view value)
+                   { records.emplace_back(key, value); });
+    const std::vector<std::pair<std::string, std::string>> expected = {{"b", "1"}, {"a", "2"}, {"b", ""}, {"c", ""}};
+    EXPECT_EQ(records, expected);
+    EXPECT_EQ(batch.count(), 4u);
+
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+    EXPECT_EQ(batch.byte_size(), 0u);
+}
+
+template <typename StringType>
+class LsmTreeTest : public ::testing::Test
+{
+};
+
+TYPED_TEST_SUITE(LsmTreeTest, LsmStringTypes);
+
+TYPED_TEST(LsmTreeTest, LastWriteInBatchWins)
+{
+    TempDir dir;
+    LSMTree<TypeParam> tree(dir.str(), quiet_options());
+    tree.put(make_key<TypeParam>("gone"), make_key<TypeParam>("old"));
+
+    WriteBatch batch;
+    batch.put("k", "first");
+    batch.put("k", "second");
+    batch.delete_key("gone");
+    batch.put("deleted_then_put", "x");
+    batch.delete_key("deleted_then_put");
+    batch.delete_key("put_after_delete");
+    batch.put("put_after_delete", "y");
+    tree.write(batch);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        const auto k = tree.get(make_key<TypeParam>("k"));
+        ASSERT_TRUE(k.has_value());
+        EXPECT_EQ(to_std(*k), "second");
+        const auto gone = tree.get(make_key<TypeParam>("gone"));
+        EXPECT_TRUE(!gone.has_value() || gone->empty());
+        const auto deleted = tree.get(make_key<TypeParam>("deleted_then_put"));
+        EXPECT_TRUE(!deleted.has_value() || deleted->empty());
+        const auto put = tree.get(make_key<TypeParam>("put_after_delete"));
+        ASSERT_TRUE(put.has_value());
+        EXPECT_EQ(to_std(*put), "y");
+        // The same answers once the batch lives in an SSTable
+        tree.flush_memtable();
+    }
+}
+
+TYPED_TEST(LsmTreeTest, TtlFilterDropsExpiredEntries)
+{
+    TempDir dir;
+    constexpr uint64_t NOW = 1'000'000;
+    auto options = quiet_options();
+    options.compaction_filter = std::make_shared<TtlCompactionFilter>([] { return NOW; });
+    LSMTree<TypeParam> tree(dir.str(), options);
+
+    tree.put(make_key<TypeParam>("expired"), TypeParam(make_ttl_value("a", NOW - 1)));
+    tree.put(make_key<TypeParam>("expires_now"), TypeParam(make_ttl_value("b", NOW)));
+    tree.put(make_key<TypeParam>("live"), TypeParam(make_ttl_value("c", NOW + 1)));
+    tree.flush_memtable();
+    // Values too short for a header never expire
+    tree.put(make_key<TypeParam>("plain"), make_key<TypeParam>("p"));
+    tree.flush_memtable();
+    tree.compact();
+
+    EXPECT_FALSE(tree.get(make_key<TypeParam>("expired")).has_value());
+    EXPECT_FALSE(tree.get(make_key<TypeParam>("expires_now")).has_value());
+    const auto live = tree.get(make_key<TypeParam>("live"));
+    ASSERT_TRUE(live.has_value());
+    EXPECT_EQ(ttl_value_expiry(to_std(*live)), NOW + 1);
+    EXPECT_EQ(to_std(*live).substr(TTL_HEADER_SIZE), "c");
+    const auto plain = tree.get(make_key<TypeParam>("plain"));
+    ASSERT_TRUE(plain.has_value());
+    EXPECT_EQ(to_std(*plain), "p");
+}
+
+TYPED_TEST(LsmTreeTest, ReopenKeepsNewestVersion)
+{
+    TempDir dir;
+    {
+        LSMTree<TypeParam> tree(dir.str(), quiet_options());
+        for (size_t i = 0; i < 12; ++i)
+        {
+            tree.put(make_key<TypeParam>("k"), TypeParam("v" + std::to_string(i)));
+            tree.put(make_key<TypeParam>(format_key(i)), TypeParam(std::to_string(i)));
+            tree.flush_memtable();
+        }
+        tree.delete_key(make_key<TypeParam>(format_key(3)));
+        tree.flush_memtable();
+    }
+
+    LSMTree<TypeParam> tree(dir.str(), quiet_options());
+    const auto k = tree.get(make_key<TypeParam>("k"));
+    ASSERT_TRUE(k.has_value());
+    EXPECT_EQ(to_std(*k), "v11");
+    const auto deleted = tree.get(make_key<TypeParam>(format_key(3)));
+    EXPECT_TRUE(!deleted.has_value() || deleted->empty());
+    const auto kept = tree.get(make_key<TypeParam>(format_key(4)));
+    ASSERT_TRUE(kept.has_value());
+    EXPECT_EQ(to_std(*kept), "4");
+}
+
+TYPED_TEST(LsmTreeTest, ReopenOrdersTablesByNumericId)
+{
+    TempDir dir;
+    // sstable_10 sorts before sstable_9 as a string but holds the newer value
+    const std::vector<std::pair<std::string, std::string>> older = {{"k", "older"}};
+    const std::vector<std::pair<std::string, std::string>> newer = {{"k", "newer"}};
+    SSTable<TypeParam>::create_from_entries(older, dir.file("sstable_9.dat"));
+    SSTable<TypeParam>::create_from_entries(newer, dir.file("sstable_10.dat"));
+
+    LSMTree<TypeParam> tree(dir.str(), quiet_options());
+    const auto k = tree.get(make_key<TypeParam>("k"));
+    ASSERT_TRUE(k.has_value());
+    EXPECT_EQ(to_std(*k), "newer");
+
+    // New flushes continue after the highest id instead of overwriting a table
+    tree.put(make_key<TypeParam>("k"), make_key<TypeParam>("newest"));
+    tree.flush_memtable();
+    LSMTree<TypeParam> reopened(dir.str(), quiet_options());
+    EXPECT_EQ(to_std(*reopened.get(make_key<TypeParam>("k"))), "newest");
+}
+
+TEST(LsmTree, SubcompactionsWithoutBlockCache)
+{
+    // Without a cache every index partition is decoded on access and freed when the last reference
+    // goes, so the split keys picked for subcompactions must not point into it
+    TempDir dir;
+    auto options = quiet_options();
+    options.memtable_threshold = 256 * 1024;
+    options.block_cache_bytes = 0;
+    options.max_subcompactions = 4;
+    LSMTree<gs::german_string> tree(dir.str(), options);
+
+    constexpr size_t ENTRIES = 40000;
+    const std::string padding(24, 'x');
+    for (size_t i = 0; i < ENTRIES; ++i)
+    {
+        // Scattered so every table covers the whole key range
+        const size_t k = (i * 7919) % ENTRIES;
+        tree.put(gs::german_string(format_key(k) + padding), gs::german_string("value_" + std::to_string(k) + padding));
+    }
+    tree.compact();
+    const auto stats = tree.get_stats();
+    ASSERT_GT(stats.compaction_count, 0u);
+    ASSERT_GT(stats.subcompaction_count, stats.compaction_count);
+
+    for (size_t k = 0; k < ENTRIES; k += 97)
+    {
+        const auto value = tree.get(gs::german_string(format_key(k) + padding));
+        ASSERT_TRUE(value.has_value()) << k;
+        EXPECT_EQ(to_std(*value), "value_" + std::to_string(k) + padding);
+    }
+    EXPECT_EQ(tree.scan(gs::german_string(""), ENTRIES + 1).size(), ENTRIES);
+}
+
+TYPED_TEST(LsmTreeTest, ReadsOutliveFlushAndCompaction)
+{
+    TempDir dir;
+    LSMTree<TypeParam> tree(dir.str(), quiet_options());
+    // Longer than the inline german string prefix, so the bytes live in the memtable or the mapping
+    const std::string long_value(64, 'v');
+    for (size_t i = 0; i < 100; ++i)
+    {
+        tree.put(make_key<TypeParam>(format_key(i)), TypeParam(long_value + std::to_string(i)));
+    }
+
+    const auto from_memtable = tree.get(make_key<TypeParam>(format_key(1)));
+    const auto many_from_memtable = tree.multi_get({make_key<TypeParam>(format_key(2)), make_key<TypeParam>(format_key(3))});
+    const auto scanned_from_memtable = tree.scan(make_key<TypeParam>(format_key(4)), 2);
+    // Frees the memtable arena
+    tree.flush_memtable();
+
+    const auto from_table = tree.get(make_key<TypeParam>(format_key(10)));
+    const auto many_from_table = tree.multi_get({make_key<TypeParam>(format_key(11))});
+    const auto scanned_from_table = tree.scan(make_key<TypeParam>(format_key(12)), 2);
+    // Unmaps the flushed table once the compacted one replaces it
+    tree.put(make_key<TypeParam>(format_key(0)), make_key<TypeParam>("newer"));
+    tree.flush_memtable();
+    tree.compact();
+
+    ASSERT_TRUE(from_memtable.has_value());
+    EXPECT_EQ(to_std(*from_memtable), long_value + "1");
+    ASSERT_EQ(many_from_memtable.size(), 2u);
+    EXPECT_EQ(to_std(*many_from_memtable[1]), long_value + "3");
+    ASSERT_EQ(scanned_from_memtable.size(), 2u);
+    EXPECT_EQ(to_std(scanned_from_memtable[1].first), format_key(5));
+    EXPECT_EQ(to_std(scanned_from_memtable[1].second), long_value + "5");
+
+    ASSERT_TRUE(from_table.has_value());
+    EXPECT_EQ(to_std(*from_table), long_value + "10");
+    ASSERT_EQ(many_from_table.size(), 1u);
+    EXPECT_EQ(to_std(*many_from_table[0]), long_value + "11");
+    ASSERT_EQ(scanned_from_table.size(), 2u);
+    EXPECT_EQ(to_std(scanned_from_table[0].second), long_value + "12");
+}
+
+TEST(LsmTree, ConcurrentReadsDuringFlushAndCompaction)
+{
+    // The RESP server reads on several threads and serializes the values after the tree lock is
+    // released, while writes on other threads flush memtables and compact tables away
+    TempDir dir;
+    auto options = quiet_options();
+    options.memtable_threshold = 64 * 1024;
+    LSMTree<gs::german_string> tree(dir.str(), options);
+
+    constexpr size_t ENTRIES = 10000;
+    const std::string padding(40, 'x');
+    const auto value_for = [&](size_t k) { return "value_" + std::to_string(k) + padding; };
+    for (size_t k = 0; k < 1000; ++k)
+    {
+        tree.put(gs::german_string(format_key(k)), gs::german_string(value_for(k)));
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 3; ++t)
+    {
+        readers.emplace_back([&, t]
+                             {
+                                 size_t k = t;
+                                 while (!done.load(std::memory_order_relaxed))
+                                 {
+                                     k = (k * 31 + 7) % 1000;
+                                     const auto value = tree.get(gs::german_string(format_key(k)));
+                                     const auto values = tree.multi_get({gs::german_string(format_key(k)),
+                                                                         gs::german_string(format_key((k + 1) % 1000))});
+                                     const auto entries = tree.scan(gs::german_string(format_key(k)), 4);
+                                     // Serialized after the lock is gone, like a server reply
+                                     std::string reply;
+                                     if (value.has_value())
+                                     {
+                                         reply += to_std(*value);
+                                     }
+                                     for (const auto &v : values)
+                                     {
+                                         reply += v.has_value() ? to_std(*v) : std::string();
+                                     }
+                                     for (const auto &[key, v] : entries)
+                                     {
+                                         reply += to_std(key) + to_std(v);
+                                     }
+                                     if (!value.has_value() || to_std(*value) != value_for(k) || entries.empty() ||
+                                         to_std(entries.front().second) != value_for(k) || reply.empty())
+                                     {
+                                         mismatches++;
+                                     }
+                                 }
+                             });
+    }
+    for (size_t k = 1000; k < ENTRIES; ++k)
+    {
+        tree.put(gs::german_string(format_key(k)), gs::german_string(value_for(k)));
+    }
+    tree.compact();
+    done = true;
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_GT(tree.get_stats().compaction_count, 0u);
+}
+
+TEST(LsmResp, ParserStopsAtMalformedRequest)
+{
+    const std::string input = "*2\r\n$3\r\nGET\r\n$1\r\nk\r\nPING\r\n*x\r\n";
+    std::vector<std::string_view> args;
+    size_t offset = 0;
+    ASSERT_EQ(resp_parse_request(input, offset, args), RespStatus::complete);
+    EXPECT_EQ(args, (std::vector<std::string_view>{"GET", "k"}));
+    ASSERT_EQ(resp_parse_request(input, offset, args), RespStatus::complete);
+    EXPECT_EQ(args, (std::vector<std::string_view>{"PING"}));
+    const size_t good_end = offset;
+    EXPECT_EQ(resp_parse_request(input, offset, args), RespStatus::error);
+    EXPECT_EQ(offset, good_end);
+}
+
+TEST(LsmServer, AnswersPipelineBeforeProtocolError)
+{
+    TempDir dir;
+    LSMTree<gs::german_string> tree(dir.file("tree"), quiet_options());
+    const std::string socket_path = dir.file("server.sock");
+    const int listen_fd = open_listen_socket(socket_path, 0);
+    serve_stop_requested.store(false);
+    LsmServer<gs::german_string> server(tree, listen_fd);
+    std::thread server_thread([&] { server.run(1); });
+
+    // Pipelined in one write: the batched GET run and single commands ahead of a malformed request
+    std::string request;
+    resp_append_command(request, {"SET", "k", "v"});
+    resp_append_command(request, {"GET", "k"});
+    resp_append_command(request, {"GET", "missing"});
+    resp_append_command(request, {"PING"});
+    request += "*x\r\n";
+    const int fd = connect_socket(socket_path, 0);
+    ASSERT_EQ(send(fd, request.data(), request.size(), MSG_NOSIGNAL), static_cast<ssize_t>(request.size()));
+
+    // The server closes the connection after the error
+    std::string reply;
+    char buffer[4096];
+    for (ssize_t bytes; (bytes = recv(fd, buffer, sizeof(buffer), 0)) > 0;)
+    {
+        reply.append(buffer, static_cast<size_t>(bytes));
+    }
+    close(fd);
+    serve_stop_requested.store(true);
+    server_thread.join();
+    close(listen_fd);
+
+    EXPECT_EQ(reply, "+OK\r\n$1\r\nv\r\n$-1\r\n+PONG\r\n-ERR protocol error\r\n");
+}
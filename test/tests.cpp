@@ -7,6 +7,7 @@
 #include <algorithm>
 
 #include "german_string.h"
+#include "german_string_join.h"
 
 #include <gtest/gtest.h>
 
@@ -407,6 +408,266 @@ TEST(GermanStrings, Hasher)
     EXPECT_EQ(hasher(str4), hasher(str5)); // Same content, different lengths
 }
 
+// Short strings over a tiny alphabet, so prefixes tie and sizes cross the inline size
+std::vector<std::string> generate_view_strings(size_t count, uint32_t seed)
+{
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<> length_distribution(0, 20);
+    std::uniform_int_distribution<> char_distribution('a', 'c');
+    std::vector<std::string> strings(count);
+    for (auto &str : strings)
+    {
+        const int length = length_distribution(generator);
+        for (int j = 0; j < length; ++j)
+        {
+            str += static_cast<char>(char_distribution(generator));
+        }
+    }
+    return strings;
+}
+
+static int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+TEST(GermanStringViews, Layout)
+{
+    static_assert(std::is_trivially_copyable_v<gs::german_string_view>);
+    static_assert(sizeof(gs::german_string_view) == sizeof(gs::german_string));
+    static_assert(std::is_convertible_v<gs::german_string, gs::german_string_view>);
+    static_assert(!std::is_convertible_v<gs::german_string_view, gs::german_string>);
+
+    gs::german_string_view empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_EQ(empty, gs::german_string());
+}
+
+TEST(GermanStringViews, ConversionDoesNotCopyTheHeapBytes)
+{
+    CountingAllocator::reset();
+    gs::basic_german_string<CountingAllocator> small(SMALL_KNOWN_STRING, gs::temporary_t{});
+    gs::basic_german_string<CountingAllocator> large(LARGE_KNOWN_STRING, gs::temporary_t{});
+    EXPECT_EQ(CountingAllocator::get_count_allocs(), 1);
+
+    const gs::german_string_view small_view = small;
+    const gs::german_string_view large_view = large;
+    EXPECT_EQ(CountingAllocator::get_count_allocs(), 1);
+    EXPECT_EQ(small_view.as_string_view(), SMALL_KNOWN_STRING);
+    EXPECT_EQ(large_view.as_string_view(), LARGE_KNOWN_STRING);
+    EXPECT_EQ(large_view.data(), large.data());
+    EXPECT_TRUE(small_view == small);
+    EXPECT_TRUE(large == large_view);
+
+    // Back to an owned string copies
+    const gs::basic_german_string<CountingAllocator> owned(large_view);
+    EXPECT_EQ(CountingAllocator::get_count_allocs(), 2);
+    EXPECT_NE(owned.data(), large.data());
+    EXPECT_EQ(owned, large);
+}
+
+TEST(GermanStringViews, ComparisonMatchesStringView)
+{
+    const auto strings = generate_view_strings(200, 42);
+    std::vector<gs::german_string> owned;
+    std::vector<gs::german_string_view> views;
+    for (const auto &str : strings)
+    {
+        owned.emplace_back(str.data(), static_cast<uint32_t>(str.size()), gs::temporary_t{});
+        views.emplace_back(str);
+    }
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+        EXPECT_EQ(views[i].as_string_view(), strings[i]);
+        for (size_t j = 0; j < strings.size(); ++j)
+        {
+            const int expected = sign(strings[i].compare(strings[j]));
+            EXPECT_EQ(sign(views[i].compare(views[j])), expected) << strings[i] << " vs " << strings[j];
+            EXPECT_EQ(views[i] == views[j], expected == 0);
+            EXPECT_EQ(views[i] < views[j], expected < 0);
+            EXPECT_EQ(owned[i] == views[j], expected == 0);
+            EXPECT_EQ(views[i] <=> owned[j], owned[i] <=> owned[j]);
+        }
+    }
+}
+
+TEST(GermanStringViews, Sorting)
+{
+    // The views borrow from strings, so the expected order is sorted on a copy
+    const auto strings = generate_random_strings<std::string>(1000, 0, 64, 7);
+    std::vector<gs::german_string_view> views(strings.begin(), strings.end());
+    auto sorted = strings;
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(views.begin(), views.end());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        EXPECT_EQ(views[i].as_string_view(), sorted[i]);
+    }
+}
+
+TEST(GermanStringViews, StartsWithEndsWithAndFind)
+{
+    const gs::german_string_view hello(std::string_view("Hello, World!"));
+    const gs::german_string_view empty;
+    EXPECT_TRUE(hello.starts_with(gs::german_string_view(std::string_view("He"))));
+    EXPECT_TRUE(hello.starts_with(gs::german_string_view(std::string_view("Hello"))));
+    EXPECT_TRUE(hello.starts_with(hello));
+    EXPECT_TRUE(hello.starts_with(empty));
+    EXPECT_FALSE(hello.starts_with(gs::german_string_view(std::string_view("Help"))));
+    EXPECT_FALSE(hello.starts_with(gs::german_string_view(std::string_view("Hello, World!!"))));
+    EXPECT_TRUE(hello.ends_with(gs::german_string_view(std::string_view("World!"))));
+    EXPECT_FALSE(hello.ends_with(gs::german_string_view(std::string_view("World"))));
+    EXPECT_EQ(hello.find('o'), 4);
+    EXPECT_EQ(hello.find('o', 5), 8);
+    EXPECT_EQ(hello.find('z'), gs::german_string_view::npos);
+    EXPECT_TRUE(hello.contains(gs::german_string_view(std::string_view("lo, W"))));
+    EXPECT_FALSE(empty.contains('a'));
+
+    const auto strings = generate_view_strings(100, 43);
+    for (const auto &a : strings)
+    {
+        const gs::german_string_view view_a(a);
+        for (const auto &b : strings)
+        {
+            const gs::german_string_view view_b(b);
+            const std::string_view std_a(a);
+            EXPECT_EQ(view_a.starts_with(view_b), std_a.starts_with(b)) << a << " vs " << b;
+            EXPECT_EQ(view_a.ends_with(view_b), std_a.ends_with(b)) << a << " vs " << b;
+            const auto expected = std_a.find(b);
+            EXPECT_EQ(view_a.find(view_b), expected == std::string_view::npos ? gs::german_string_view::npos : expected);
+        }
+    }
+}
+
+TEST(GermanStringViews, Substr)
+{
+    const gs::german_string large(LARGE_KNOWN_STRING, gs::temporary_t{});
+    const gs::german_string_view view = large;
+    const std::string_view expected(LARGE_KNOWN_STRING);
+    EXPECT_EQ(view.substr(6, 5).as_string_view(), expected.substr(6, 5));
+    EXPECT_EQ(view.substr(6, 100).as_string_view(), expected.substr(6, 100));
+    EXPECT_EQ(view.substr(6, 100).data(), large.data() + 6);
+    EXPECT_TRUE(view.substr(view.size(), 0).empty());
+    EXPECT_THROW(view.substr(view.size(), 1), std::out_of_range);
+    EXPECT_THROW(view.substr(view.size() + 1, 0), std::out_of_range);
+}
+
+TEST(GermanStringViews, HashMatchesGermanString)
+{
+    const gs::german_string small(SMALL_KNOWN_STRING);
+    const gs::german_string large(LARGE_KNOWN_STRING);
+    EXPECT_EQ(std::hash<gs::german_string_view>()(small), std::hash<gs::german_string>()(small));
+    EXPECT_EQ(std::hash<gs::german_string_view>()(large), std::hash<gs::german_string>()(large));
+    EXPECT_NE(std::hash<gs::german_string_view>()(small), std::hash<gs::german_string_view>()(large));
+}
+
+// Join keys drawn from a small pool, so both sides repeat keys and many prefixes tie
+template <typename StringType>
+std::vector<StringType> generate_join_keys(size_t count, uint32_t seed)
+{
+    static const std::vector<std::string> pool = {"", "a", "ab", "abc", "abcd", "abcde", "https://a", "https://b",
+                                                  "https://example.com/a", "https://example.com/b", "Hello World",
+                                                  "Hello World!", "Hello World, again", std::string("ab\0c", 4), "zzzz"};
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> pool_distribution(0, pool.size() - 1);
+    std::vector<StringType> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto &key = pool[pool_distribution(generator)];
+        if constexpr (std::is_same_v<StringType, std::string>)
+        {
+            keys.push_back(key);
+        }
+        else
+        {
+            keys.emplace_back(key.data(), static_cast<uint32_t>(key.size()), gs::temporary_t{});
+        }
+    }
+    return keys;
+}
+
+template <typename StringType>
+std::vector<gs::join_match> nested_loop_join(const std::vector<StringType> &left, const std::vector<StringType> &right)
+{
+    std::vector<gs::join_match> matches;
+    for (uint32_t l = 0; l < left.size(); ++l)
+    {
+        for (uint32_t r = 0; r < right.size(); ++r)
+        {
+            if (left[l] == right[r])
+            {
+                matches.push_back({l, r});
+            }
+        }
+    }
+    return matches;
+}
+
+template <typename StringType>
+void expect_joins_match_nested_loop(size_t left_count, size_t right_count, uint32_t seed)
+{
+    const auto left = generate_join_keys<StringType>(left_count, seed);
+    const auto right = generate_join_keys<StringType>(right_count, seed + 1);
+    const auto expected = nested_loop_join(left, right);
+
+    for (const unsigned radix_bits : {0u, 3u, gs::HASH_JOIN_AUTO_RADIX_BITS})
+    {
+        auto matches = gs::hash_join<StringType>(left, right, radix_bits);
+        std::sort(matches.begin(), matches.end());
+        EXPECT_EQ(matches, expected) << "radix_bits=" << radix_bits;
+    }
+
+    auto matches = gs::sort_merge_join<StringType>(left, right);
+    std::sort(matches.begin(), matches.end());
+    EXPECT_EQ(matches, expected);
+}
+
+TEST(GermanStringJoins, HashAndSortMergeJoinMatchNestedLoop)
+{
+    expect_joins_match_nested_loop<gs::german_string>(200, 300, 42);
+    expect_joins_match_nested_loop<std::string>(200, 300, 42);
+    expect_joins_match_nested_loop<gs::german_string>(1, 500, 7);
+    expect_joins_match_nested_loop<gs::german_string>(500, 1, 7);
+}
+
+TEST(GermanStringJoins, RandomKeys)
+{
+    auto left = generate_random_strings<gs::german_string>(300, 0, 40, 42);
+    auto right = generate_random_strings<gs::german_string>(300, 0, 40, 43);
+    const auto expected = nested_loop_join(left, right);
+    EXPECT_FALSE(expected.empty()); // The known strings repeat
+
+    auto hashed = gs::hash_join<gs::german_string>(left, right);
+    std::sort(hashed.begin(), hashed.end());
+    EXPECT_EQ(hashed, expected);
+
+    auto merged = gs::sort_merge_join<gs::german_string>(left, right);
+    std::sort(merged.begin(), merged.end());
+    EXPECT_EQ(merged, expected);
+}
+
+TEST(GermanStringJoins, SortMergeJoinEmitsKeyOrder)
+{
+    using namespace gs::literals;
+    const std::vector<gs::german_string> left = {"pear"_gs, "apple"_gs, "a long key past the inline size"_gs, "apple"_gs};
+    const std::vector<gs::german_string> right = {"apple"_gs, "fig"_gs, "a long key past the inline size"_gs};
+    const auto matches = gs::sort_merge_join<gs::german_string>(left, right);
+    const std::vector<gs::join_match> expected = {{2, 2}, {1, 0}, {3, 0}};
+    EXPECT_EQ(matches, expected);
+}
+
+TEST(GermanStringJoins, EmptyInputs)
+{
+    const std::vector<gs::german_string> empty;
+    const auto keys = generate_join_keys<gs::german_string>(10, 42);
+    EXPECT_TRUE(gs::hash_join<gs::german_string>(empty, keys).empty());
+    EXPECT_TRUE(gs::hash_join<gs::german_string>(keys, empty).empty());
+    EXPECT_TRUE(gs::sort_merge_join<gs::german_string>(empty, keys).empty());
+    EXPECT_TRUE(gs::sort_merge_join<gs::german_string>(keys, empty).empty());
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);